@@ -0,0 +1,51 @@
+#ifndef GRAPHIO_BINARYCSRCONVERT_HPP
+#define GRAPHIO_BINARYCSRCONVERT_HPP
+
+#include <string>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/GraphTypes.hpp>
+#include <graphio/GraphBuilder.hpp>
+#include <graphio/ParsePolicy.hpp>
+#include <graphio/formats/SIF.hpp>
+#include <graphio/formats/Tab.hpp>
+#include <graphio/utility/Executor.hpp>
+#include <graphio/utility/SpillFile.hpp>
+
+namespace graphio {
+	// Whether convertToBinaryCSR() can convert input to output
+	inline bool canConvertToBinaryCSR(const std::string &input, const std::string &output) {
+		Type type = graphFileType(input);
+		return (type == SIF || type == Tab) && graphFileType(output) == BinaryCSR;
+	}
+
+	// Converts a SIF or tab file to a binary CSR file with label sidecars
+	// without building the graph. Edges are streamed into sorted runs of
+	// about budget bytes in temporary files in directory, and the runs are
+	// merged straight into the output, so peak memory is the vertex label
+	// dictionary plus the budget. Of repeated edges the last label is
+	// kept, as when reading into an adjacency list with setS edges.
+	template<class Policy = StrictPolicy>
+	void convertToBinaryCSR(
+		const std::string &input, const std::string &output, size_t budget,
+		Executor &executor = defaultExecutor(), const std::string &directory = spillDirectory()
+	) {
+		if(graphFileType(output) != BinaryCSR) {
+			throw GraphIOException("Not a binary CSR file: " + output);
+		}
+
+		GraphBuilder builder;
+		builder.setMemoryBudget(budget, directory);
+		builder.setKeepLast(true);
+
+		GraphBuilder::Handle &h = builder.handle();
+		switch(graphFileType(input)) {
+			case SIF: readSIFEdges<Policy>(input, h); break;
+			case Tab: readTabEdges<Policy>(input, h); break;
+			default: throw GraphIOException("Cannot stream file to binary CSR: " + input);
+		}
+
+		builder.writeBinaryCSR(output, executor);
+	}
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef GRAPHIO_CSRGRAPH_HPP
+#define GRAPHIO_CSRGRAPH_HPP
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <graphio/Graph.hpp>
+#include <graphio/utility/HugePageAllocator.hpp>
+
+namespace graphio {
+	struct CSREdge {
+		size_t src, tgt, id;
+
+		inline bool operator==(const CSREdge &e) const {
+			return id == e.id;
+		}
+
+		inline bool operator!=(const CSREdge &e) const {
+			return id != e.id;
+		}
+	};
+
+	struct csr_traversal_tag :
+		public virtual boost::incidence_graph_tag,
+		public virtual boost::adjacency_graph_tag,
+		public virtual boost::vertex_list_graph_tag
+	{ };
+
+	// Immutable undirected graph in compressed sparse row form.
+	// Every edge appears in the adjacency of both endpoints, sorted by
+	// target; self-loops appear once. Edge properties are stored once and
+	// shared by both half-edges.
+	template<typename VP = LabeledVertex, typename EP = LabeledEdge, typename GP = LabeledGraph>
+	class CSRGraph {
+		public:
+			typedef size_t vertex_descriptor;
+			typedef CSREdge edge_descriptor;
+			typedef boost::undirected_tag directed_category;
+			typedef boost::allow_parallel_edge_tag edge_parallel_category;
+			typedef csr_traversal_tag traversal_category;
+			typedef size_t vertices_size_type;
+			typedef size_t edges_size_type;
+			typedef size_t degree_size_type;
+
+			typedef VP vertex_bundled;
+			typedef EP edge_bundled;
+			typedef GP graph_bundled;
+
+			class out_edge_iterator : public boost::iterator_facade<
+				out_edge_iterator, CSREdge, boost::random_access_traversal_tag, CSREdge
+			> {
+				public:
+					out_edge_iterator() : g(NULL), v(0), pos(0) { }
+					out_edge_iterator(const CSRGraph *g, size_t v, size_t pos) : g(g), v(v), pos(pos) { }
+
+				private:
+					friend class boost::iterator_core_access;
+
+					inline CSREdge dereference() const {
+						CSREdge e;
+						e.src = v;
+						e.tgt = g->targets[pos];
+						e.id = g->edge_ids[pos];
+						return e;
+					}
+
+					inline bool equal(const out_edge_iterator &it) const { return pos == it.pos; }
+					inline void increment() { ++pos; }
+					inline void decrement() { --pos; }
+					inline void advance(ptrdiff_t n) { pos += n; }
+					inline ptrdiff_t distance_to(const out_edge_iterator &it) const { return it.pos - pos; }
+
+					const CSRGraph *g;
+					size_t v, pos;
+			};
+
+			class adjacency_iterator : public boost::iterator_facade<
+				adjacency_iterator, size_t, boost::random_access_traversal_tag, size_t
+			> {
+				public:
+					adjacency_iterator() : targets(NULL) { }
+					adjacency_iterator(const uint32_t *targets) : targets(targets) { }
+
+				private:
+					friend class boost::iterator_core_access;
+
+					inline size_t dereference() const { return *targets; }
+					inline bool equal(const adjacency_iterator &it) const { return targets == it.targets; }
+					inline void increment() { ++targets; }
+					inline void decrement() { --targets; }
+					inline void advance(ptrdiff_t n) { targets += n; }
+					inline ptrdiff_t distance_to(const adjacency_iterator &it) const { return it.targets - targets; }
+
+					const uint32_t *targets;
+			};
+
+			typedef boost::counting_iterator<size_t> vertex_iterator;
+			typedef void in_edge_iterator;
+			typedef void edge_iterator;
+
+			static inline vertex_descriptor null_vertex() {
+				return ~size_t(0);
+			}
+
+			CSRGraph() : offsets(1, 0) { }
+
+			inline VP &operator[](vertex_descriptor v) { return vertex_props[v]; }
+			inline const VP &operator[](vertex_descriptor v) const { return vertex_props[v]; }
+			inline EP &operator[](const edge_descriptor &e) { return edge_props[e.id]; }
+			inline const EP &operator[](const edge_descriptor &e) const { return edge_props[e.id]; }
+			inline GP &operator[](boost::graph_bundle_t) { return graph_props; }
+			inline const GP &operator[](boost::graph_bundle_t) const { return graph_props; }
+
+			// Raw arrays
+			std::vector<size_t, HugePageAllocator<size_t> > offsets;
+			std::vector<uint32_t, HugePageAllocator<uint32_t> > targets;
+			std::vector<size_t, HugePageAllocator<size_t> > edge_ids;
+			std::vector<VP, HugePageAllocator<VP> > vertex_props;
+			std::vector<EP, HugePageAllocator<EP> > edge_props;
+			GP graph_props;
+	};
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t num_vertices(const CSRGraph<VP, EP, GP> &g) {
+		return g.offsets.size() - 1;
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t num_edges(const CSRGraph<VP, EP, GP> &g) {
+		return g.edge_props.size();
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline std::pair<boost::counting_iterator<size_t>, boost::counting_iterator<size_t> >
+	vertices(const CSRGraph<VP, EP, GP> &g) {
+		return std::make_pair(boost::counting_iterator<size_t>(0), boost::counting_iterator<size_t>(num_vertices(g)));
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline std::pair<typename CSRGraph<VP, EP, GP>::out_edge_iterator, typename CSRGraph<VP, EP, GP>::out_edge_iterator>
+	out_edges(size_t v, const CSRGraph<VP, EP, GP> &g) {
+		typedef typename CSRGraph<VP, EP, GP>::out_edge_iterator It;
+		return std::make_pair(It(&g, v, g.offsets[v]), It(&g, v, g.offsets[v+1]));
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline std::pair<typename CSRGraph<VP, EP, GP>::adjacency_iterator, typename CSRGraph<VP, EP, GP>::adjacency_iterator>
+	adjacent_vertices(size_t v, const CSRGraph<VP, EP, GP> &g) {
+		typedef typename CSRGraph<VP, EP, GP>::adjacency_iterator It;
+		const uint32_t *t = g.targets.data();
+		return std::make_pair(It(t + g.offsets[v]), It(t + g.offsets[v+1]));
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t out_degree(size_t v, const CSRGraph<VP, EP, GP> &g) {
+		return g.offsets[v+1] - g.offsets[v];
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t degree(size_t v, const CSRGraph<VP, EP, GP> &g) {
+		return out_degree(v, g);
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t source(const CSREdge &e, const CSRGraph<VP, EP, GP> &) {
+		return e.src;
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t target(const CSREdge &e, const CSRGraph<VP, EP, GP> &) {
+		return e.tgt;
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline boost::typed_identity_property_map<size_t> get(boost::vertex_index_t, const CSRGraph<VP, EP, GP> &) {
+		return boost::typed_identity_property_map<size_t>();
+	}
+}
+
+namespace boost {
+	template<typename VP, typename EP, typename GP>
+	struct property_map<graphio::CSRGraph<VP, EP, GP>, vertex_index_t> {
+		typedef typed_identity_property_map<size_t> type;
+		typedef type const_type;
+	};
+}
+
+#endif
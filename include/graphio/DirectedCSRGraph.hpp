@@ -0,0 +1,241 @@
+#ifndef GRAPHIO_DIRECTEDCSRGRAPH_HPP
+#define GRAPHIO_DIRECTEDCSRGRAPH_HPP
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <type_traits>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <graphio/Graph.hpp>
+#include <graphio/CSRGraph.hpp>
+#include <graphio/utility/HugePageAllocator.hpp>
+#include <graphio/utility/parallel.hpp>
+
+namespace graphio {
+	struct directed_csr_traversal_tag :
+		public virtual boost::incidence_graph_tag,
+		public virtual boost::adjacency_graph_tag,
+		public virtual boost::vertex_list_graph_tag
+	{ };
+
+	struct bidirectional_csr_traversal_tag :
+		public virtual boost::bidirectional_graph_tag,
+		public virtual boost::adjacency_graph_tag,
+		public virtual boost::vertex_list_graph_tag
+	{ };
+
+	// Immutable directed graph in compressed sparse row form. Every edge
+	// is stored once, in the adjacency of its source sorted by target, so
+	// its id is its position there. With InEdges the graph also keeps the
+	// in-adjacency of every vertex, sorted by source, as edge ids.
+	template<typename VP = LabeledVertex, typename EP = LabeledEdge, typename GP = LabeledGraph, bool InEdges = false>
+	class DirectedCSRGraph {
+		public:
+			typedef size_t vertex_descriptor;
+			typedef CSREdge edge_descriptor;
+			typedef typename std::conditional<InEdges, boost::bidirectional_tag, boost::directed_tag>::type directed_category;
+			typedef boost::allow_parallel_edge_tag edge_parallel_category;
+			typedef typename std::conditional<InEdges, bidirectional_csr_traversal_tag, directed_csr_traversal_tag>::type traversal_category;
+			typedef size_t vertices_size_type;
+			typedef size_t edges_size_type;
+			typedef size_t degree_size_type;
+
+			typedef VP vertex_bundled;
+			typedef EP edge_bundled;
+			typedef GP graph_bundled;
+
+			class out_edge_iterator : public boost::iterator_facade<
+				out_edge_iterator, CSREdge, boost::random_access_traversal_tag, CSREdge
+			> {
+				public:
+					out_edge_iterator() : g(NULL), v(0), pos(0) { }
+					out_edge_iterator(const DirectedCSRGraph *g, size_t v, size_t pos) : g(g), v(v), pos(pos) { }
+
+				private:
+					friend class boost::iterator_core_access;
+
+					inline CSREdge dereference() const {
+						CSREdge e;
+						e.src = v;
+						e.tgt = g->targets[pos];
+						e.id = pos;
+						return e;
+					}
+
+					inline bool equal(const out_edge_iterator &it) const { return pos == it.pos; }
+					inline void increment() { ++pos; }
+					inline void decrement() { --pos; }
+					inline void advance(ptrdiff_t n) { pos += n; }
+					inline ptrdiff_t distance_to(const out_edge_iterator &it) const { return it.pos - pos; }
+
+					const DirectedCSRGraph *g;
+					size_t v, pos;
+			};
+
+			class in_edge_iterator : public boost::iterator_facade<
+				in_edge_iterator, CSREdge, boost::random_access_traversal_tag, CSREdge
+			> {
+				public:
+					in_edge_iterator() : g(NULL), v(0), pos(0) { }
+					in_edge_iterator(const DirectedCSRGraph *g, size_t v, size_t pos) : g(g), v(v), pos(pos) { }
+
+				private:
+					friend class boost::iterator_core_access;
+
+					inline CSREdge dereference() const {
+						CSREdge e;
+						e.src = g->in_sources[pos];
+						e.tgt = v;
+						e.id = g->in_edge_ids[pos];
+						return e;
+					}
+
+					inline bool equal(const in_edge_iterator &it) const { return pos == it.pos; }
+					inline void increment() { ++pos; }
+					inline void decrement() { --pos; }
+					inline void advance(ptrdiff_t n) { pos += n; }
+					inline ptrdiff_t distance_to(const in_edge_iterator &it) const { return it.pos - pos; }
+
+					const DirectedCSRGraph *g;
+					size_t v, pos;
+			};
+
+			typedef typename CSRGraph<VP, EP, GP>::adjacency_iterator adjacency_iterator;
+			typedef boost::counting_iterator<size_t> vertex_iterator;
+			typedef void edge_iterator;
+
+			static inline vertex_descriptor null_vertex() {
+				return ~size_t(0);
+			}
+
+			DirectedCSRGraph() : offsets(1, 0) {
+				if(InEdges) in_offsets.assign(1, 0);
+			}
+
+			inline VP &operator[](vertex_descriptor v) { return vertex_props[v]; }
+			inline const VP &operator[](vertex_descriptor v) const { return vertex_props[v]; }
+			inline EP &operator[](const edge_descriptor &e) { return edge_props[e.id]; }
+			inline const EP &operator[](const edge_descriptor &e) const { return edge_props[e.id]; }
+			inline GP &operator[](boost::graph_bundle_t) { return graph_props; }
+			inline const GP &operator[](boost::graph_bundle_t) const { return graph_props; }
+
+			// Raw arrays. The in-adjacency arrays stay empty without InEdges.
+			std::vector<size_t, HugePageAllocator<size_t> > offsets;
+			std::vector<uint32_t, HugePageAllocator<uint32_t> > targets;
+			std::vector<size_t, HugePageAllocator<size_t> > in_offsets;
+			std::vector<uint32_t, HugePageAllocator<uint32_t> > in_sources;
+			std::vector<size_t, HugePageAllocator<size_t> > in_edge_ids;
+			std::vector<VP, HugePageAllocator<VP> > vertex_props;
+			std::vector<EP, HugePageAllocator<EP> > edge_props;
+			GP graph_props;
+	};
+
+	// Fills the in-adjacency of g from its out-adjacency. A no-op unless
+	// the graph keeps in-edges.
+	template<typename VP, typename EP, typename GP, bool InEdges>
+	void buildInEdges(DirectedCSRGraph<VP, EP, GP, InEdges> &g, Executor &executor = defaultExecutor()) {
+		if(!InEdges) return;
+
+		size_t n = g.offsets.size() - 1;
+		size_t m = g.targets.size();
+		g.in_offsets.assign(n+1, 0);
+		for(size_t k = 0; k < m; ++k) {
+			g.in_offsets[g.targets[k]+1]++;
+		}
+		parallel_prefix_sum(g.in_offsets, executor);
+
+		// Sources are visited in order, so every in-adjacency comes out sorted
+		std::vector<size_t> next(g.in_offsets.begin(), g.in_offsets.end() - 1);
+		g.in_sources.resize(m);
+		g.in_edge_ids.resize(m);
+		for(size_t u = 0; u < n; ++u) {
+			for(size_t k = g.offsets[u]; k < g.offsets[u+1]; ++k) {
+				size_t pos = next[g.targets[k]]++;
+				g.in_sources[pos] = u;
+				g.in_edge_ids[pos] = k;
+			}
+		}
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline size_t num_vertices(const DirectedCSRGraph<VP, EP, GP, I> &g) {
+		return g.offsets.size() - 1;
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline size_t num_edges(const DirectedCSRGraph<VP, EP, GP, I> &g) {
+		return g.edge_props.size();
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline std::pair<boost::counting_iterator<size_t>, boost::counting_iterator<size_t> >
+	vertices(const DirectedCSRGraph<VP, EP, GP, I> &g) {
+		return std::make_pair(boost::counting_iterator<size_t>(0), boost::counting_iterator<size_t>(num_vertices(g)));
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline std::pair<typename DirectedCSRGraph<VP, EP, GP, I>::out_edge_iterator, typename DirectedCSRGraph<VP, EP, GP, I>::out_edge_iterator>
+	out_edges(size_t v, const DirectedCSRGraph<VP, EP, GP, I> &g) {
+		typedef typename DirectedCSRGraph<VP, EP, GP, I>::out_edge_iterator It;
+		return std::make_pair(It(&g, v, g.offsets[v]), It(&g, v, g.offsets[v+1]));
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline std::pair<typename DirectedCSRGraph<VP, EP, GP, I>::adjacency_iterator, typename DirectedCSRGraph<VP, EP, GP, I>::adjacency_iterator>
+	adjacent_vertices(size_t v, const DirectedCSRGraph<VP, EP, GP, I> &g) {
+		typedef typename DirectedCSRGraph<VP, EP, GP, I>::adjacency_iterator It;
+		const uint32_t *t = g.targets.data();
+		return std::make_pair(It(t + g.offsets[v]), It(t + g.offsets[v+1]));
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline size_t out_degree(size_t v, const DirectedCSRGraph<VP, EP, GP, I> &g) {
+		return g.offsets[v+1] - g.offsets[v];
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline std::pair<typename DirectedCSRGraph<VP, EP, GP, true>::in_edge_iterator, typename DirectedCSRGraph<VP, EP, GP, true>::in_edge_iterator>
+	in_edges(size_t v, const DirectedCSRGraph<VP, EP, GP, true> &g) {
+		typedef typename DirectedCSRGraph<VP, EP, GP, true>::in_edge_iterator It;
+		return std::make_pair(It(&g, v, g.in_offsets[v]), It(&g, v, g.in_offsets[v+1]));
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t in_degree(size_t v, const DirectedCSRGraph<VP, EP, GP, true> &g) {
+		return g.in_offsets[v+1] - g.in_offsets[v];
+	}
+
+	template<typename VP, typename EP, typename GP>
+	inline size_t degree(size_t v, const DirectedCSRGraph<VP, EP, GP, true> &g) {
+		return out_degree(v, g) + in_degree(v, g);
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline size_t source(const CSREdge &e, const DirectedCSRGraph<VP, EP, GP, I> &) {
+		return e.src;
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline size_t target(const CSREdge &e, const DirectedCSRGraph<VP, EP, GP, I> &) {
+		return e.tgt;
+	}
+
+	template<typename VP, typename EP, typename GP, bool I>
+	inline boost::typed_identity_property_map<size_t> get(boost::vertex_index_t, const DirectedCSRGraph<VP, EP, GP, I> &) {
+		return boost::typed_identity_property_map<size_t>();
+	}
+}
+
+namespace boost {
+	template<typename VP, typename EP, typename GP, bool I>
+	struct property_map<graphio::DirectedCSRGraph<VP, EP, GP, I>, vertex_index_t> {
+		typedef typed_identity_property_map<size_t> type;
+		typedef type const_type;
+	};
+}
+
+#endif
@@ -0,0 +1,1023 @@
+#ifndef GRAPHIO_EDGERANGE_HPP
+#define GRAPHIO_EDGERANGE_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+#include <boost/utility/string_ref.hpp>
+#include <boost/graph/adjacency_list.hpp>
+#include <graphio/Graph.hpp>
+#include <graphio/GraphReader.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/ParsePolicy.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/LabelSidecar.hpp>
+#include <graphio/utility/hash.hpp>
+#include <graphio/utility/xml.hpp>
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#include <exception>
+#define GRAPHIO_HAS_COROUTINES 1
+#endif
+#endif
+
+// Pull-based reading of the edges of a graph file, without building a
+// graph:
+//
+//   for(auto &e : graphio::edges("network.sif")) {
+//       std::cout << e.source << " " << e.label << " " << e.target << "\n";
+//   }
+//
+// Each edge of the file is yielded once, in the order the readers add it,
+// with vertex numbers as the readers assign them. Text formats are read
+// line by line or from a mapping and split in place, so memory grows with
+// the number of vertices, not edges. GraphML and Cytoscape JSON files
+// are parsed into node and edge arrays first, as their readers do.
+namespace graphio {
+	// One edge of a file. The views stay valid until the next edge is read.
+	struct EdgeRecord {
+		size_t source_id, target_id;
+		boost::string_ref source, target, label;
+	};
+
+	namespace detail {
+		class EdgeSource {
+			public:
+				EdgeSource() : directed(false) { }
+				virtual ~EdgeSource() { }
+
+				// Fills record with the next edge. Returns false at the end.
+				virtual bool next(EdgeRecord &record) = 0;
+
+				// Set when the file declares its graph directed
+				bool directed;
+		};
+
+		// Numbers vertex labels by first appearance, keeping one copy of each
+		class EdgeLabelNumbering {
+			public:
+				inline size_t number(const boost::string_ref &label, boost::string_ref &stored) {
+					auto it = ids.find(label);
+					if(it != ids.end()) {
+						stored = it->first;
+						return it->second;
+					}
+
+					labels.push_back(label.to_string());
+					stored = labels.back();
+					ids.insert(std::make_pair(stored, labels.size()-1));
+					return labels.size()-1;
+				}
+
+			private:
+				std::deque<std::string> labels;
+				std::unordered_map<boost::string_ref, size_t, StringRefHash> ids;
+		};
+
+		inline bool isEdgeFieldSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+		}
+
+		// Splits line at any character of sep into views of the non-empty
+		// fields, trimmed of whitespace if trim is set
+		inline void splitEdgeFields(const std::string &line, const char *sep, bool trim, std::vector<boost::string_ref> &parts) {
+			parts.clear();
+			const char *p = line.data(), *end = p + line.size();
+			while(p <= end) {
+				const char *q = p;
+				while(q < end && std::strchr(sep, *q) == NULL) q++;
+
+				if(q > p) {
+					const char *first = p, *last = q;
+					if(trim) {
+						while(first < last && isEdgeFieldSpace(*first)) first++;
+						while(last > first && isEdgeFieldSpace(last[-1])) last--;
+					}
+					parts.push_back(boost::string_ref(first, last - first));
+				}
+				p = q + 1;
+			}
+		}
+
+		// Splits lines into views of the fields Policy::split() gives.
+		// Policies without an in-place variant split into copies.
+		template<class Policy>
+		class EdgeFieldSplitter {
+			public:
+				void split(const std::string &line, const char *sep, std::vector<boost::string_ref> &parts) {
+					Policy::split(line, sep, storage);
+					parts.assign(storage.begin(), storage.end());
+				}
+
+			private:
+				std::vector<std::string> storage;
+		};
+
+		template<>
+		class EdgeFieldSplitter<TrustedPolicy> {
+			public:
+				void split(const std::string &line, const char *sep, std::vector<boost::string_ref> &parts) {
+					splitEdgeFields(line, sep, false, parts);
+				}
+		};
+
+		// Only lines with quotes or escapes go through the tokenizer
+		template<>
+		class EdgeFieldSplitter<StrictPolicy> {
+			public:
+				void split(const std::string &line, const char *sep, std::vector<boost::string_ref> &parts) {
+					if(line.find_first_of("\"\\") == std::string::npos) {
+						splitEdgeFields(line, sep, true, parts);
+						return;
+					}
+					StrictPolicy::split(line, sep, storage);
+					parts.assign(storage.begin(), storage.end());
+				}
+
+			private:
+				std::vector<std::string> storage;
+		};
+
+		template<class Policy>
+		class SIFEdgeSource : public EdgeSource {
+			public:
+				SIFEdgeSource(const std::string &filename) : file(filename), next_part(0), source_id(0) { }
+
+				bool next(EdgeRecord &record) {
+					while(next_part >= parts.size()) {
+						if(!getline(file, line)) return false;
+						if(line.length() == 0) continue;
+						splitter.split(line, " \t", parts);
+
+						next_part = parts.size();
+						if(parts.empty()) continue;
+
+						// Lines without a target still number their vertex
+						source_id = numbering.number(parts[0], source);
+						if(parts.size() >= 3) next_part = 2;
+					}
+
+					record.source_id = source_id;
+					record.source = source;
+					record.label = parts[1];
+					record.target_id = numbering.number(parts[next_part++], record.target);
+					return true;
+				}
+
+			private:
+				FileInput file;
+				std::string line;
+				std::vector<boost::string_ref> parts;
+				EdgeFieldSplitter<Policy> splitter;
+				EdgeLabelNumbering numbering;
+				size_t next_part, source_id;
+				boost::string_ref source;
+		};
+
+		template<class Policy>
+		class TabEdgeSource : public EdgeSource {
+			public:
+				TabEdgeSource(const std::string &filename) : file(filename) {
+					// Skip header line
+					getline(file, line);
+				}
+
+				bool next(EdgeRecord &record) {
+					while(getline(file, line)) {
+						if(line.length() == 0) continue;
+						splitter.split(line, "\t", parts);
+
+						if(parts.size() < 2) {
+							// Strict policies reject the line, others skip it
+							Policy::checkColumns(line, std::vector<std::string>(parts.begin(), parts.end()), 2);
+							continue;
+						}
+
+						record.source_id = numbering.number(parts[0], record.source);
+						record.target_id = numbering.number(parts[1], record.target);
+						record.label = parts.size() > 2 ? parts[2] : boost::string_ref();
+						return true;
+					}
+					return false;
+				}
+
+			private:
+				FileInput file;
+				std::string line;
+				std::vector<boost::string_ref> parts;
+				EdgeFieldSplitter<Policy> splitter;
+				EdgeLabelNumbering numbering;
+		};
+
+		class DelimitedEdgeSource : public EdgeSource {
+			public:
+				DelimitedEdgeSource(const std::string &filename, const DelimitedOptions &options)
+				: file(filename), options(options), scanners(options) {
+					p = file.data();
+					end = p + file.size();
+
+					for(size_t i = 0; i < options.skip_lines; ++i) {
+						p = nextDelimitedLine(p, end);
+					}
+
+					std::vector<boost::string_ref> header;
+					if(options.header) {
+						p = skipDelimitedBlankLines(p, end, options.comment);
+						if(p < end) {
+							p = parseDelimitedRecord(p, end, options, scanners, header, decoded);
+						}
+					}
+
+					source_column = delimitedColumn(options.source, header, true);
+					target_column = delimitedColumn(options.target, header, true);
+					label_column = delimitedColumn(options.label, header, true);
+					if(source_column < 0 || target_column < 0) {
+						throw GraphIOException("Source and target columns are required");
+					}
+					required = std::max(source_column, target_column) + 1;
+				}
+
+				bool next(EdgeRecord &record) {
+					p = skipDelimitedBlankLines(p, end, options.comment);
+					if(p >= end) return false;
+
+					const char *start = p;
+					decoded.clear();
+					p = parseDelimitedRecord(p, end, options, scanners, fields, decoded);
+					if(fields.size() < size_t(required)) {
+						const char *nl = static_cast<const char*>(std::memchr(start, '\n', end - start));
+						throw GraphIOException("Too few columns in line: " + std::string(start, nl ? nl : end));
+					}
+
+					record.source_id = numbering.number(fields[source_column], record.source);
+					record.target_id = numbering.number(fields[target_column], record.target);
+					record.label = label_column >= 0 && size_t(label_column) < fields.size() ? fields[label_column] : boost::string_ref();
+					return true;
+				}
+
+			private:
+				MappedFile file;
+				DelimitedOptions options;
+				DelimitedScanners scanners;
+				const char *p, *end;
+				int source_column, target_column, label_column, required;
+				std::vector<boost::string_ref> fields;
+				// Fields that needed unescaping, for the current record
+				std::deque<std::string> decoded;
+				EdgeLabelNumbering numbering;
+		};
+
+		template<class Policy>
+		class LEDAEdgeSource : public EdgeSource {
+			public:
+				LEDAEdgeSource(const std::string &filename) : file(filename), edge(0) {
+					Policy::readLEDALine(file, line);
+					if(line != "LEDA.GRAPH") {
+						throw GraphIOException("\"LEDA.GRAPH\" header not found");
+					}
+
+					// Node and edge types
+					Policy::readLEDALine(file, line);
+					Policy::readLEDALine(file, line);
+					// -1 for directed, -2 for undirected
+					Policy::readLEDALine(file, line);
+					directed = line != "-2";
+
+					Policy::readLEDALine(file, line);
+					labels.resize(Policy::parseSize(line));
+					for(size_t i = 0; i < labels.size(); ++i) {
+						Policy::readLEDALine(file, line);
+						labels[i] = Policy::parseLEDALabel(line);
+					}
+
+					Policy::readLEDALine(file, line);
+					edge_count = Policy::parseSize(line);
+				}
+
+				bool next(EdgeRecord &record) {
+					if(edge == edge_count || !Policy::readLEDALine(file, line)) return false;
+					edge++;
+
+					size_t u, v;
+					Policy::parseLEDAEdge(line, u, v, label);
+					if(u >= labels.size() || v >= labels.size()) {
+						throw GraphIOException("Edge refers to unknown node: " + line);
+					}
+
+					record.source_id = u;
+					record.target_id = v;
+					record.source = labels[u];
+					record.target = labels[v];
+					record.label = label;
+					return true;
+				}
+
+			private:
+				FileInput file;
+				std::string line, label;
+				std::vector<std::string> labels;
+				size_t edge, edge_count;
+		};
+
+		// Vertex and edge labels of Ligra formats, from their sidecars.
+		// Edge labels are streamed in the order the edges are read.
+		class LigraLabels {
+			public:
+				LigraLabels(const std::string &filename) : ep(NULL), eend(NULL) {
+					readLabelSidecar(vertexLabelSidecar(filename), labels);
+
+					std::string elabels = edgeLabelSidecar(filename);
+					if(fileExists(elabels)) {
+						edge_labels.reset(new MappedFile(elabels));
+						ep = edge_labels->data();
+						eend = ep + edge_labels->size();
+					}
+				}
+
+				inline bool hasVertexLabels() const {
+					return !labels.empty();
+				}
+
+				inline size_t vertexCount() const {
+					return labels.size();
+				}
+
+				// Label of v, or its number written to buf
+				inline boost::string_ref vertex(size_t v, char *buf) const {
+					if(!labels.empty()) return labels[v];
+					return boost::string_ref(buf, formatLigraNumber(buf, v) - buf);
+				}
+
+				// Label of the next edge, empty once the sidecar runs out
+				inline boost::string_ref nextEdge() {
+					if(ep >= eend) return boost::string_ref();
+
+					const char *nl = static_cast<const char*>(std::memchr(ep, '\n', eend - ep));
+					if(nl == NULL) nl = eend;
+					readSidecarLine(ep, nl, label);
+					ep = nl + 1;
+					return label;
+				}
+
+			private:
+				std::vector<std::string> labels;
+				std::unique_ptr<MappedFile> edge_labels;
+				const char *ep, *eend;
+				std::string label;
+		};
+
+		// Edges of a checked Ligra adjacency, as buildFromLigraAdjacency()
+		// adds them to an undirected graph
+		class LigraAdjacencyEdgeSource : public EdgeSource {
+			public:
+				LigraAdjacencyEdgeSource(const std::string &filename) : labels(filename), u(0), k(0) {
+					if(graphFileType(filename) == BinaryCSR) {
+						mapBinaryCSR(filename);
+					} else {
+						parseAdjacencyGraph(filename);
+					}
+
+					if(labels.hasVertexLabels() && labels.vertexCount() != n) {
+						throw GraphIOException("Label sidecar does not match the vertex count of " + filename);
+					}
+
+					checkLigraAdjacency(filename, n, m, offsets, targets, defaultExecutor());
+					sorted.resize(n);
+					for(size_t v = 0; v < n; ++v) {
+						sorted[v] = std::is_sorted(targets + offsets[v], targets + offsets[v+1]);
+					}
+				}
+
+				bool next(EdgeRecord &record) {
+					for(; u < n; ++u) {
+						while(k < offsets[u+1]) {
+							uint32_t v = targets[k++];
+							if(v < u) {
+								const uint32_t *first = targets + offsets[v], *last = targets + offsets[v+1];
+								bool listed = sorted[v] ? std::binary_search(first, last, uint32_t(u)) : std::find(first, last, uint32_t(u)) != last;
+								if(listed) continue;
+							}
+
+							record.source_id = u;
+							record.target_id = v;
+							record.source = labels.vertex(u, source_buf);
+							record.target = labels.vertex(v, target_buf);
+							record.label = labels.nextEdge();
+							return true;
+						}
+					}
+					return false;
+				}
+
+			private:
+				void mapBinaryCSR(const std::string &filename) {
+					file.reset(new MappedFile(filename));
+					uint64_t header[3];
+					if(file->size() < sizeof(header)) {
+						throw GraphIOException("Not a binary CSR file: " + filename);
+					}
+					std::memcpy(header, file->data(), sizeof(header));
+
+					n = header[0];
+					m = header[1];
+					if(n > UINT32_MAX || header[2] != file->size()
+					|| file->size() != sizeof(header) + (n+1) * sizeof(uint64_t) + m * sizeof(uint32_t)) {
+						throw GraphIOException("Not a binary CSR file: " + filename);
+					}
+
+					offsets = reinterpret_cast<const uint64_t*>(file->data() + sizeof(header));
+					targets = reinterpret_cast<const uint32_t*>(offsets + n + 1);
+				}
+
+				// The text gives no random access to adjacency lists, so
+				// the numbers are parsed into arrays as by the reader
+				void parseAdjacencyGraph(const std::string &filename) {
+					MappedFile text(filename);
+					const char *p = text.data(), *end = p + text.size();
+
+					const char *header = "AdjacencyGraph";
+					size_t len = std::strlen(header);
+					if(text.size() < len || std::memcmp(p, header, len) != 0 || (p + len < end && !isLigraSpace(p[len]))) {
+						throw GraphIOException("Not an unweighted AdjacencyGraph file: " + filename);
+					}
+
+					parseLigraNumbers(filename, p + len, end, numbers, defaultExecutor());
+					if(numbers.size() < 2 || numbers.size() != 2 + numbers[0] + numbers[1]) {
+						throw GraphIOException("AdjacencyGraph: Wrong number of entries in " + filename);
+					}
+
+					n = numbers[0];
+					m = numbers[1];
+					if(n > UINT32_MAX) {
+						throw GraphIOException("Too many vertices in " + filename);
+					}
+
+					owned_targets.resize(m);
+					const uint64_t *t = numbers.data() + 2 + n;
+					for(size_t i = 0; i < m; ++i) {
+						if(t[i] >= n) {
+							throw GraphIOException("Target out of range in " + filename);
+						}
+						owned_targets[i] = t[i];
+					}
+					numbers.resize(2 + n);
+					numbers.push_back(m);
+
+					offsets = numbers.data() + 2;
+					targets = owned_targets.data();
+				}
+
+				LigraLabels labels;
+				std::unique_ptr<MappedFile> file;
+				LigraOffsets numbers;
+				LigraTargets owned_targets;
+				const uint64_t *offsets;
+				const uint32_t *targets;
+				size_t n, m;
+				std::vector<char> sorted;
+				size_t u, k;
+				char source_buf[20], target_buf[20];
+		};
+
+		class BinaryEdgeListSource : public EdgeSource {
+			public:
+				BinaryEdgeListSource(const std::string &filename) : file(filename), labels(filename), filename(filename), k(0) {
+					if(file.size() % (2 * sizeof(uint32_t)) != 0) {
+						throw GraphIOException("Not a binary edge list: " + filename);
+					}
+					pairs = reinterpret_cast<const uint32_t*>(file.data());
+					m = file.size() / (2 * sizeof(uint32_t));
+				}
+
+				bool next(EdgeRecord &record) {
+					if(k == m) return false;
+
+					uint32_t u = pairs[2*k], v = pairs[2*k+1];
+					k++;
+					if(labels.hasVertexLabels() && (u >= labels.vertexCount() || v >= labels.vertexCount())) {
+						throw GraphIOException("Label sidecar does not match the vertex count of " + filename);
+					}
+
+					record.source_id = u;
+					record.target_id = v;
+					record.source = labels.vertex(u, source_buf);
+					record.target = labels.vertex(v, target_buf);
+					record.label = labels.nextEdge();
+					return true;
+				}
+
+			private:
+				MappedFile file;
+				LigraLabels labels;
+				std::string filename;
+				const uint32_t *pairs;
+				size_t m, k;
+				char source_buf[20], target_buf[20];
+		};
+
+		// Two passes over the mapped file: the first numbers the nodes in
+		// document order, the second yields the edges
+		class XGMMLEdgeSource : public EdgeSource {
+			public:
+				XGMMLEdgeSource(const std::string &filename) : file(filename) {
+					const char *p = file.data();
+					end = p + file.size();
+
+					// Find the graph start tag
+					xml::Tag tag;
+					while(true) {
+						p = p ? static_cast<const char*>(std::memchr(p, '<', end - p)) : NULL;
+						if(p == NULL) throw GraphIOException("XGMML: Missing <graph> in " + filename);
+
+						const char *q = xml::skipMarkup(p, end);
+						if(q != NULL) {
+							p = q;
+							continue;
+						}
+
+						p = xml::parseTag(p, end, tag);
+						if(tag.name != "graph" || tag.closing) {
+							throw GraphIOException("XGMML: Root element is not <graph> in " + filename);
+						}
+						break;
+					}
+					boost::string_ref orientation;
+					directed = tag.attribute("directed", orientation) && xgmmlDirected(orientation);
+
+					pos = tag.empty ? end : p;
+					const char *q = pos;
+					while(nextElement(q, tag)) {
+						if(tag.name != "node") continue;
+
+						boost::string_ref node = id(tag, "id", decoded_ids);
+						if(!ids.insert(std::make_pair(node, labels.size())).second) {
+							throw GraphIOException("XGMML: Duplicate node id " + node.to_string());
+						}
+						boost::string_ref label;
+						tag.attribute("label", label);
+						labels.push_back(label);
+					}
+				}
+
+				bool next(EdgeRecord &record) {
+					xml::Tag tag;
+					while(nextElement(pos, tag)) {
+						if(tag.name != "edge") continue;
+
+						edge_ids.clear();
+						record.source_id = find(id(tag, "source", edge_ids));
+						record.target_id = find(id(tag, "target", edge_ids));
+						record.source = label(labels[record.source_id], source);
+						record.target = label(labels[record.target_id], target);
+
+						boost::string_ref raw;
+						tag.attribute("label", raw);
+						record.label = label(raw, edge_label);
+						return true;
+					}
+					return false;
+				}
+
+			private:
+				// Moves p past the next top-level element of the graph body.
+				// Returns false at </graph>.
+				bool nextElement(const char *&p, xml::Tag &tag) {
+					if(p >= end) return false;
+					while(true) {
+						p = static_cast<const char*>(std::memchr(p, '<', end - p));
+						if(p == NULL) throw GraphIOException("XGMML: Missing </graph>");
+
+						const char *q = xml::skipMarkup(p, end);
+						if(q != NULL) {
+							p = q;
+							continue;
+						}
+
+						q = xml::parseTag(p, end, tag);
+						if(tag.closing) {
+							if(tag.name != "graph") {
+								throw GraphIOException("XGMML: Unexpected </" + tag.name.to_string() + ">");
+							}
+							p = end;
+							return false;
+						}
+
+						p = tag.empty ? q : xml::skipContent(q, end);
+						return true;
+					}
+				}
+
+				inline boost::string_ref id(const xml::Tag &tag, const char *name, std::deque<std::string> &decoded) {
+					boost::string_ref raw;
+					if(!tag.attribute(name, raw)) {
+						throw GraphIOException(std::string("XGMML: ") + tag.name.to_string() + " without " + name);
+					}
+					if(raw.find('&') == boost::string_ref::npos) return raw;
+
+					decoded.push_back(xml::decode(raw));
+					return decoded.back();
+				}
+
+				inline size_t find(const boost::string_ref &id) const {
+					auto it = ids.find(id);
+					if(it == ids.end()) {
+						throw GraphIOException("XGMML: Edge refers to unknown node " + id.to_string());
+					}
+					return it->second;
+				}
+
+				// Raw attribute text, decoded into buf if it holds references
+				inline boost::string_ref label(const boost::string_ref &raw, std::string &buf) const {
+					if(raw.find('&') == boost::string_ref::npos) return raw;
+					xml::decode(raw, buf);
+					return buf;
+				}
+
+				MappedFile file;
+				const char *end, *pos;
+				std::unordered_map<boost::string_ref, size_t, StringRefHash> ids;
+				// Decoded node ids that contained character references
+				std::deque<std::string> decoded_ids, edge_ids;
+				std::vector<boost::string_ref> labels;
+				std::string source, target, edge_label;
+		};
+
+		// GraphML has no edge order to stream in before all nodes are
+		// known, so the edges are taken from the reader's parsed document
+		class GraphMLEdgeSource : public EdgeSource {
+			public:
+				GraphMLEdgeSource(const std::string &filename) : file(filename), i(0), d(0) {
+					parseGraphML(filename, file, doc);
+					graphMLNodeIds(doc, ids);
+					directed = doc.directed;
+
+					// Label keys as applied by the reader, defaults first
+					labels.assign(doc.nodes.begin(), doc.nodes.end());
+					for(size_t k = 0; k < doc.keys.size(); ++k) {
+						const GraphMLKey &key = doc.keys[k];
+						if(!key.has_default || key.name != "label") continue;
+						if(key.domain == GRAPHML_NODE || key.domain == GRAPHML_ALL) {
+							std::fill(labels.begin(), labels.end(), boost::string_ref(key.value));
+						}
+						if(key.domain == GRAPHML_EDGE || key.domain == GRAPHML_ALL) {
+							edge_default = key.value;
+						}
+					}
+					for(size_t k = 0; k < doc.node_data.size(); ++k) {
+						const GraphMLValue &value = doc.node_data[k];
+						if(doc.keys[value.key].name == "label") labels[value.item] = value.value;
+					}
+				}
+
+				bool next(EdgeRecord &record) {
+					if(i == doc.edges.size()) return false;
+
+					auto u = ids.find(doc.edges[i].first);
+					auto v = ids.find(doc.edges[i].second);
+					if(u == ids.end() || v == ids.end()) {
+						throw GraphIOException("GraphML: Edge refers to unknown node "
+							+ (u == ids.end() ? doc.edges[i].first : doc.edges[i].second).to_string());
+					}
+
+					record.source_id = u->second;
+					record.target_id = v->second;
+					record.source = labels[u->second];
+					record.target = labels[v->second];
+					record.label = edge_default;
+					for(; d < doc.edge_data.size() && doc.edge_data[d].item == i; ++d) {
+						const GraphMLValue &value = doc.edge_data[d];
+						if(doc.keys[value.key].name == "label") record.label = value.value;
+					}
+					i++;
+					return true;
+				}
+
+			private:
+				MappedFile file;
+				GraphMLDocument doc;
+				std::unordered_map<boost::string_ref, size_t, StringRefHash> ids;
+				std::vector<boost::string_ref> labels;
+				boost::string_ref edge_default;
+				size_t i, d;
+		};
+
+		// Cytoscape JSON lists nodes and edges in either order, so the
+		// edges are taken from the reader's parsed elements
+		class CytoscapeEdgeSource : public EdgeSource {
+			public:
+				CytoscapeEdgeSource(const std::string &filename) : file(filename), i(0) {
+					VertexVisitor vv;
+					EdgeVisitor ev;
+					parseCytoscapeFile(filename, file, elements, vv, ev);
+					cytoscapeNodeIds(elements, ids);
+				}
+
+				bool next(EdgeRecord &record) {
+					if(i == elements.edges.size()) return false;
+
+					auto u = ids.find(elements.edges[i].first);
+					auto v = ids.find(elements.edges[i].second);
+					if(u == ids.end() || v == ids.end()) {
+						throw GraphIOException("Cytoscape JSON: Edge refers to unknown node "
+							+ (u == ids.end() ? elements.edges[i].first : elements.edges[i].second).to_string());
+					}
+
+					record.source_id = u->second;
+					record.target_id = v->second;
+					record.source = elements.node_labels[u->second];
+					record.target = elements.node_labels[v->second];
+					record.label = elements.edge_labels[i];
+					i++;
+					return true;
+				}
+
+			private:
+				MappedFile file;
+				CytoscapeElements elements;
+				std::unordered_map<boost::string_ref, size_t, StringRefHash> ids;
+				size_t i;
+		};
+
+		// Arrow edge tables are read a record batch at a time, resolving
+		// endpoints against the vertex table as the reader does
+		class ArrowEdgeSource : public EdgeSource {
+			public:
+				ArrowEdgeSource(const std::string &filename) : edge_file(filename), b(0), i(0), rows(0) {
+					readArrowVertexLabels(filename, labels);
+					arrowEdgeColumns(filename, edge_file, source, target, label);
+					ids.reset(new ArrowVertexIds(labels));
+				}
+
+				bool next(EdgeRecord &record) {
+					while(i == rows) {
+						if(b == edge_file.batchCount()) return false;
+						rows = edge_file.batch(b++, columns);
+						i = 0;
+					}
+
+					size_t u = ids->get(columns[source], i);
+					size_t v = ids->get(columns[target], i);
+					label_buf.clear();
+					if(label >= 0 && columns[label].valid(i)) {
+						label_buf = columns[label].str(i);
+					}
+					i++;
+
+					// Labels only move while resolving endpoints
+					record.source_id = u;
+					record.target_id = v;
+					record.source = labels[u];
+					record.target = labels[v];
+					record.label = label_buf;
+					return true;
+				}
+
+			private:
+				std::vector<std::string> labels;
+				std::unique_ptr<ArrowVertexIds> ids;
+				ArrowFile edge_file;
+				std::vector<ArrowColumnView> columns;
+				int source, target, label;
+				std::string label_buf;
+				size_t b, i, rows;
+		};
+	}
+
+	// Single pass range over the edges of a file, as returned by edges()
+	class EdgeRange {
+		public:
+			class iterator {
+				public:
+					typedef std::input_iterator_tag iterator_category;
+					typedef EdgeRecord value_type;
+					typedef std::ptrdiff_t difference_type;
+					typedef const EdgeRecord *pointer;
+					typedef const EdgeRecord &reference;
+
+					iterator() : range(NULL) { }
+
+					inline reference operator*() const {
+						return range->record;
+					}
+
+					inline pointer operator->() const {
+						return &range->record;
+					}
+
+					inline iterator &operator++() {
+						range->advance();
+						return *this;
+					}
+
+					inline void operator++(int) {
+						range->advance();
+					}
+
+					inline bool operator==(const iterator &other) const {
+						return finished() == other.finished();
+					}
+
+					inline bool operator!=(const iterator &other) const {
+						return finished() != other.finished();
+					}
+
+				private:
+					friend class EdgeRange;
+
+					explicit iterator(EdgeRange *range) : range(range) { }
+
+					inline bool finished() const {
+						return range == NULL || range->done;
+					}
+
+					EdgeRange *range;
+			};
+
+			explicit EdgeRange(std::unique_ptr<detail::EdgeSource> source) : source(std::move(source)), started(false), done(false) { }
+
+			// Reads the first edge on the first call. Later calls continue
+			// where the last iterator stopped.
+			iterator begin() {
+				if(!started) {
+					started = true;
+					advance();
+				}
+				return iterator(this);
+			}
+
+			iterator end() {
+				return iterator();
+			}
+
+			// Whether the file declares its graph directed. Formats read
+			// through a graph and Ligra formats count as undirected.
+			bool directed() const {
+				return source->directed;
+			}
+
+		private:
+			inline void advance() {
+				done = !source->next(record);
+			}
+
+			std::unique_ptr<detail::EdgeSource> source;
+			EdgeRecord record;
+			bool started, done;
+	};
+
+	// Edges of a delimited text file, with columns chosen as by readDelimitedFile()
+	inline EdgeRange edges(const std::string &filename, const DelimitedOptions &options) {
+		return EdgeRange(std::unique_ptr<detail::EdgeSource>(new detail::DelimitedEdgeSource(filename, options)));
+	}
+
+	template<class Policy = StrictPolicy>
+	inline EdgeRange edges(const std::string &filename) {
+		detail::EdgeSource *source;
+		switch(graphFileType(filename)) {
+			case LEDA:
+				source = new detail::LEDAEdgeSource<Policy>(filename);
+				break;
+			case SIF:
+				source = new detail::SIFEdgeSource<Policy>(filename);
+				break;
+			case XGMML:
+				source = new detail::XGMMLEdgeSource(filename);
+				break;
+			case Tab:
+				source = new detail::TabEdgeSource<Policy>(filename);
+				break;
+			case AdjacencyGraph:
+			case BinaryCSR:
+				source = new detail::LigraAdjacencyEdgeSource(filename);
+				break;
+			case BinaryEdgeList:
+				source = new detail::BinaryEdgeListSource(filename);
+				break;
+			case CSV:
+				return edges(filename, DelimitedOptions::csv());
+			case GraphML:
+				source = new detail::GraphMLEdgeSource(filename);
+				break;
+			case Arrow:
+				source = new detail::ArrowEdgeSource(filename);
+				break;
+			case CytoscapeJSON:
+				source = new detail::CytoscapeEdgeSource(filename);
+				break;
+			default:
+				throw GraphIOException("Unknown filetype for file: " + filename);
+		}
+		return EdgeRange(std::unique_ptr<detail::EdgeSource>(source));
+	}
+
+#ifdef GRAPHIO_HAS_COROUTINES
+	// Minimal generator for coroutines yielding references to T
+	template<typename T>
+	class Generator {
+		public:
+			struct promise_type {
+				const T *value;
+				std::exception_ptr error;
+
+				Generator get_return_object() {
+					return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+				}
+
+				std::suspend_always initial_suspend() noexcept { return {}; }
+				std::suspend_always final_suspend() noexcept { return {}; }
+
+				std::suspend_always yield_value(const T &v) noexcept {
+					value = &v;
+					return {};
+				}
+
+				void return_void() { }
+
+				void unhandled_exception() {
+					error = std::current_exception();
+				}
+			};
+
+			typedef std::coroutine_handle<promise_type> handle;
+
+			class iterator {
+				public:
+					typedef std::input_iterator_tag iterator_category;
+					typedef T value_type;
+					typedef std::ptrdiff_t difference_type;
+					typedef const T *pointer;
+					typedef const T &reference;
+
+					explicit iterator(handle h = handle()) : h(h) { }
+
+					reference operator*() const {
+						return *h.promise().value;
+					}
+
+					pointer operator->() const {
+						return h.promise().value;
+					}
+
+					iterator &operator++() {
+						resume(h);
+						return *this;
+					}
+
+					void operator++(int) {
+						resume(h);
+					}
+
+					bool operator==(std::default_sentinel_t) const {
+						return !h || h.done();
+					}
+
+				private:
+					handle h;
+			};
+
+			explicit Generator(handle h) : h(h) { }
+			Generator(Generator &&other) noexcept : h(other.h) { other.h = handle(); }
+			Generator(const Generator&) = delete;
+			Generator &operator=(const Generator&) = delete;
+
+			~Generator() {
+				if(h) h.destroy();
+			}
+
+			iterator begin() {
+				resume(h);
+				return iterator(h);
+			}
+
+			std::default_sentinel_t end() {
+				return std::default_sentinel;
+			}
+
+		private:
+			static void resume(handle h) {
+				h.resume();
+				if(h.promise().error) std::rethrow_exception(h.promise().error);
+			}
+
+			handle h;
+	};
+
+	// Coroutine variant of edges()
+	template<class Policy = StrictPolicy>
+	inline Generator<EdgeRecord> edgeGenerator(std::string filename) {
+		for(const EdgeRecord &e : edges<Policy>(filename)) {
+			co_yield e;
+		}
+	}
+#endif
+}
+
+#endif
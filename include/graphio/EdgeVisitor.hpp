@@ -32,6 +32,10 @@ namespace graphio {
 			inline std::string value_str(const E &e, size_t i) const {
 				return "";
 			}
+
+			template<typename E>
+			inline void from_str(E &e, size_t i, const std::string &value) const {
+			}
 	};
 }
 
@@ -0,0 +1,407 @@
+#ifndef GRAPHIO_FREEZE_HPP
+#define GRAPHIO_FREEZE_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/filtered_graph.hpp>
+#include <boost/graph/adjacency_list.hpp>
+#include <graphio/CSRGraph.hpp>
+#include <graphio/DirectedCSRGraph.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/utility/parallel.hpp>
+
+// freezeAndRelease() fills the CSR columns in this many rounds of
+// vertices and frees the source adjacency of each round before the next
+#define GRAPHIO_FREEZE_RELEASE_ROUNDS 16
+
+namespace graphio {
+	namespace detail {
+		template<bool Release, typename T>
+		struct FreezeTransfer {
+			static inline const T &get(const T &value) { return value; }
+		};
+
+		template<typename T>
+		struct FreezeTransfer<true, T> {
+			static inline T &&get(T &value) { return std::move(value); }
+		};
+
+		// Collects the out-edges of v sorted by target, visiting each self-loop once
+		template<class G, class Adj>
+		inline void freezeAdjacency(const G &src, size_t v, Adj &adj, std::vector<const void*> &loops) {
+			adj.clear();
+			loops.clear();
+			for(auto it = out_edges(v, src); it.first != it.second; ++it.first) {
+				size_t t = target(*it.first, src);
+				if(t == v) {
+					const void *p = &src[*it.first];
+					if(std::find(loops.begin(), loops.end(), p) != loops.end()) continue;
+					loops.push_back(p);
+				}
+				adj.push_back(std::make_pair(t, *it.first));
+			}
+		}
+
+		template<class Adj>
+		inline void freezeSort(Adj &adj) {
+			typedef typename Adj::value_type P;
+			std::stable_sort(adj.begin(), adj.end(), [](const P &a, const P &b) {
+				return a.first < b.first;
+			});
+		}
+
+		// Directed edge records live in the out-edge lists
+		template<class G>
+		inline void freezeReleaseEdges(G&, size_t, boost::directed_tag) { }
+
+		// Undirected edges are erased at their higher endpoint, whose
+		// lower endpoint is frozen by then. Self-loops are listed twice.
+		template<class G>
+		inline void freezeReleaseEdges(G &src, size_t v, boost::undirected_tag) {
+			typedef decltype(src.out_edge_list(v).begin()->get_iter()) Iter;
+			std::vector<Iter> garbage;
+			for(auto it = src.out_edge_list(v).begin(); it != src.out_edge_list(v).end(); ++it) {
+				if(it->get_target() > v) continue;
+				if(it->get_target() == v && std::find(garbage.begin(), garbage.end(), it->get_iter()) != garbage.end()) continue;
+				garbage.push_back(it->get_iter());
+			}
+			for(size_t i = 0; i < garbage.size(); ++i) {
+				src.m_edges.erase(garbage[i]);
+			}
+		}
+
+		// Only the source reads a directed edge while freezing
+		template<class G>
+		inline void freezeReleaseEdges(G &src, size_t v, boost::bidirectional_tag) {
+			for(auto it = src.out_edge_list(v).begin(); it != src.out_edge_list(v).end(); ++it) {
+				src.m_edges.erase(it->get_iter());
+			}
+			auto &in = boost::in_edge_list(src, v);
+			typename std::remove_reference<decltype(in)>::type().swap(in);
+		}
+
+		// Frees the adjacency of the frozen vertices [begin, end) of src.
+		// Graphs other than adjacency lists over vecS vertices and listS
+		// edges keep theirs until freezing is done.
+		template<class G>
+		inline void freezeRelease(const G&, size_t, size_t) { }
+
+		template<class OEL, class D, class VP, class EP, class GP>
+		void freezeRelease(boost::adjacency_list<OEL, boost::vecS, D, VP, EP, GP, boost::listS> &src, size_t begin, size_t end) {
+			typedef boost::adjacency_list<OEL, boost::vecS, D, VP, EP, GP, boost::listS> G;
+			for(size_t v = begin; v < end; ++v) {
+				freezeReleaseEdges(src, v, typename boost::graph_traits<G>::directed_category());
+				auto &out = src.out_edge_list(v);
+				typename std::remove_reference<decltype(out)>::type().swap(out);
+			}
+		}
+
+		template<bool Release, class G, typename VP, typename EP, typename GP>
+		void freeze(G &src, CSRGraph<VP, EP, GP> &dst, Executor &executor) {
+			typedef typename boost::graph_traits<typename std::remove_const<G>::type>::edge_descriptor E;
+			typedef std::vector<std::pair<size_t, E> > Adj;
+
+			static_assert(!boost::is_directed_graph<typename std::remove_const<G>::type>::value,
+				"freeze() requires an undirected graph");
+
+			size_t n = num_vertices(src);
+			if(n > UINT32_MAX) {
+				throw GraphIOException("Too many vertices for CSR representation");
+			}
+
+			// Count degrees and the edges owned by each vertex,
+			// an edge being owned by its lower endpoint
+			std::vector<size_t> owned(n+1, 0);
+			dst.offsets.assign(n+1, 0);
+			parallel_for(n, executor, [&](size_t begin, size_t end) {
+				Adj adj;
+				std::vector<const void*> loops;
+				for(size_t v = begin; v < end; ++v) {
+					freezeAdjacency(src, v, adj, loops);
+					dst.offsets[v+1] = adj.size();
+					for(size_t k = 0; k < adj.size(); ++k) {
+						if(adj[k].first >= v) owned[v+1]++;
+					}
+				}
+			});
+
+			parallel_prefix_sum(dst.offsets, executor);
+			parallel_prefix_sum(owned, executor);
+
+			dst.targets.resize(dst.offsets[n]);
+			dst.edge_ids.resize(dst.offsets[n]);
+			dst.vertex_props.resize(n);
+			dst.edge_props.resize(owned[n]);
+
+			// Fill targets and label columns, numbering owned edges.
+			// When releasing, src shrinks by a round of vertices at a time.
+			size_t rounds = Release ? GRAPHIO_FREEZE_RELEASE_ROUNDS : 1;
+			for(size_t r = 0; r < rounds; ++r) {
+				size_t first = n * r / rounds, last = n * (r+1) / rounds;
+				parallel_for(last - first, executor, [&](size_t begin, size_t end) {
+					Adj adj;
+					std::vector<const void*> loops;
+					for(size_t v = first + begin; v < first + end; ++v) {
+						freezeAdjacency(src, v, adj, loops);
+						freezeSort(adj);
+
+						size_t pos = dst.offsets[v];
+						size_t id = owned[v];
+						for(size_t k = 0; k < adj.size(); ++k, ++pos) {
+							dst.targets[pos] = adj[k].first;
+							if(adj[k].first >= v) {
+								dst.edge_ids[pos] = id;
+								dst.edge_props[id] = FreezeTransfer<Release, EP>::get(src[adj[k].second]);
+								id++;
+							}
+						}
+
+						dst.vertex_props[v] = FreezeTransfer<Release, VP>::get(src[v]);
+					}
+				});
+				if(Release) freezeRelease(src, first, last);
+			}
+
+			// Half-edges below the diagonal take the id of the matching
+			// half-edge in the target's adjacency. Parallel edges are
+			// matched by their rank among equal targets.
+			parallel_for(n, executor, [&](size_t begin, size_t end) {
+				const uint32_t *t = dst.targets.data();
+				for(size_t v = begin; v < end; ++v) {
+					size_t lo = dst.offsets[v];
+					for(size_t pos = lo; pos < dst.offsets[v+1]; ++pos) {
+						size_t u = t[pos];
+						if(u >= v) break;
+
+						size_t rank = pos - (std::lower_bound(t + lo, t + pos, u) - t);
+						size_t match = std::lower_bound(t + dst.offsets[u], t + dst.offsets[u+1], v) - t;
+						dst.edge_ids[pos] = dst.edge_ids[match + rank];
+					}
+				}
+			});
+
+			dst.graph_props = src[boost::graph_bundle];
+		}
+
+		template<bool Release, class G, typename VP, typename EP, typename GP, bool I>
+		void freeze(G &src, DirectedCSRGraph<VP, EP, GP, I> &dst, Executor &executor) {
+			typedef typename boost::graph_traits<typename std::remove_const<G>::type>::edge_descriptor E;
+			typedef std::vector<std::pair<size_t, E> > Adj;
+
+			static_assert(boost::is_directed_graph<typename std::remove_const<G>::type>::value,
+				"freeze() into a DirectedCSRGraph requires a directed graph");
+
+			size_t n = num_vertices(src);
+			if(n > UINT32_MAX) {
+				throw GraphIOException("Too many vertices for CSR representation");
+			}
+
+			dst.offsets.assign(n+1, 0);
+			parallel_for(n, executor, [&](size_t begin, size_t end) {
+				for(size_t v = begin; v < end; ++v) {
+					dst.offsets[v+1] = out_degree(v, src);
+				}
+			});
+			parallel_prefix_sum(dst.offsets, executor);
+
+			dst.targets.resize(dst.offsets[n]);
+			dst.vertex_props.resize(n);
+			dst.edge_props.resize(dst.offsets[n]);
+
+			// Edge ids are positions in the out-adjacency
+			size_t rounds = Release ? GRAPHIO_FREEZE_RELEASE_ROUNDS : 1;
+			for(size_t r = 0; r < rounds; ++r) {
+				size_t first = n * r / rounds, last = n * (r+1) / rounds;
+				parallel_for(last - first, executor, [&](size_t begin, size_t end) {
+					Adj adj;
+					std::vector<const void*> loops;
+					for(size_t v = first + begin; v < first + end; ++v) {
+						freezeAdjacency(src, v, adj, loops);
+						freezeSort(adj);
+
+						size_t pos = dst.offsets[v];
+						for(size_t k = 0; k < adj.size(); ++k, ++pos) {
+							dst.targets[pos] = adj[k].first;
+							dst.edge_props[pos] = FreezeTransfer<Release, EP>::get(src[adj[k].second]);
+						}
+
+						dst.vertex_props[v] = FreezeTransfer<Release, VP>::get(src[v]);
+					}
+				});
+				if(Release) freezeRelease(src, first, last);
+			}
+
+			buildInEdges(dst, executor);
+			dst.graph_props = src[boost::graph_bundle];
+		}
+	}
+
+	// Keeps only the last of each set of parallel edges in g, matching
+	// the label an adjacency list with setS edges ends up with
+	template<typename VP, typename EP, typename GP>
+	void removeParallelEdges(CSRGraph<VP, EP, GP> &g, Executor &executor = defaultExecutor()) {
+		size_t n = num_vertices(g);
+		const uint32_t *t = g.targets.data();
+
+		// Mark the last half-edge of every run of equal targets
+		std::vector<size_t> degree(n+1, 0);
+		std::vector<size_t> keep(g.edge_props.size()+1, 0);
+		parallel_for(n, executor, [&](size_t begin, size_t end) {
+			for(size_t v = begin; v < end; ++v) {
+				for(size_t pos = g.offsets[v]; pos < g.offsets[v+1]; ++pos) {
+					if(pos+1 < g.offsets[v+1] && t[pos] == t[pos+1]) continue;
+					degree[v+1]++;
+					if(t[pos] >= v) keep[g.edge_ids[pos]+1] = 1;
+				}
+			}
+		});
+
+		parallel_prefix_sum(degree, executor);
+		parallel_prefix_sum(keep, executor);
+
+		std::vector<uint32_t, HugePageAllocator<uint32_t> > targets(degree[n]);
+		std::vector<size_t, HugePageAllocator<size_t> > edge_ids(degree[n]);
+		std::vector<EP, HugePageAllocator<EP> > edge_props(keep.back());
+		parallel_for(n, executor, [&](size_t begin, size_t end) {
+			for(size_t v = begin; v < end; ++v) {
+				size_t out = degree[v];
+				for(size_t pos = g.offsets[v]; pos < g.offsets[v+1]; ++pos) {
+					if(pos+1 < g.offsets[v+1] && t[pos] == t[pos+1]) continue;
+
+					size_t id = g.edge_ids[pos];
+					targets[out] = t[pos];
+					edge_ids[out] = keep[id];
+					if(t[pos] >= v) {
+						edge_props[keep[id]] = std::move(g.edge_props[id]);
+					}
+					out++;
+				}
+			}
+		});
+
+		g.offsets.assign(degree.begin(), degree.end());
+		g.targets.swap(targets);
+		g.edge_ids.swap(edge_ids);
+		g.edge_props.swap(edge_props);
+	}
+
+	// Keeps only the last of each set of parallel edges in g
+	template<typename VP, typename EP, typename GP, bool I>
+	void removeParallelEdges(DirectedCSRGraph<VP, EP, GP, I> &g, Executor &executor = defaultExecutor()) {
+		size_t n = num_vertices(g);
+		const uint32_t *t = g.targets.data();
+
+		std::vector<size_t> degree(n+1, 0);
+		parallel_for(n, executor, [&](size_t begin, size_t end) {
+			for(size_t v = begin; v < end; ++v) {
+				for(size_t pos = g.offsets[v]; pos < g.offsets[v+1]; ++pos) {
+					if(pos+1 < g.offsets[v+1] && t[pos] == t[pos+1]) continue;
+					degree[v+1]++;
+				}
+			}
+		});
+
+		parallel_prefix_sum(degree, executor);
+
+		std::vector<uint32_t, HugePageAllocator<uint32_t> > targets(degree[n]);
+		std::vector<EP, HugePageAllocator<EP> > edge_props(degree[n]);
+		parallel_for(n, executor, [&](size_t begin, size_t end) {
+			for(size_t v = begin; v < end; ++v) {
+				size_t out = degree[v];
+				for(size_t pos = g.offsets[v]; pos < g.offsets[v+1]; ++pos) {
+					if(pos+1 < g.offsets[v+1] && t[pos] == t[pos+1]) continue;
+					targets[out] = t[pos];
+					edge_props[out++] = std::move(g.edge_props[pos]);
+				}
+			}
+		});
+
+		g.offsets.assign(degree.begin(), degree.end());
+		g.targets.swap(targets);
+		g.edge_props.swap(edge_props);
+		buildInEdges(g, executor);
+	}
+
+	// Edge predicate hiding all but the last of each set of parallel
+	// edges of the adjacency list g, as removeParallelEdges() does for
+	// CSR graphs. The edges to hide are found in bulk, sorting the
+	// adjacency of every vertex on executor, and only they are stored.
+	template<class G>
+	class ParallelEdgeFilter {
+		public:
+			ParallelEdgeFilter() : g(NULL) { }
+
+			ParallelEdgeFilter(const G &g, Executor &executor = defaultExecutor()) : g(&g), hidden(new std::vector<const void*>()) {
+				typedef typename boost::graph_traits<G>::edge_descriptor E;
+				typedef std::vector<std::pair<size_t, E> > Adj;
+
+				std::mutex mutex;
+				parallel_for(num_vertices(g), executor, [&](size_t begin, size_t end) {
+					Adj adj;
+					std::vector<const void*> loops, found;
+					for(size_t v = begin; v < end; ++v) {
+						detail::freezeAdjacency(g, v, adj, loops);
+						detail::freezeSort(adj);
+						for(size_t k = 0; k + 1 < adj.size(); ++k) {
+							// Undirected edges are decided at their lower endpoint
+							if(adj[k].first != adj[k+1].first) continue;
+							if(adj[k].first < v && !boost::is_directed(g)) continue;
+							found.push_back(&g[adj[k].second]);
+						}
+					}
+					std::lock_guard<std::mutex> lock(mutex);
+					hidden->insert(hidden->end(), found.begin(), found.end());
+				});
+				std::sort(hidden->begin(), hidden->end());
+			}
+
+			template<class Edge>
+			inline bool operator()(const Edge &e) const {
+				return !std::binary_search(hidden->begin(), hidden->end(), static_cast<const void*>(&(*g)[e]));
+			}
+
+		private:
+			const G *g;
+			std::shared_ptr<std::vector<const void*> > hidden;
+	};
+
+	// View of g without parallel edges, for writing it out
+	template<class G>
+	inline boost::filtered_graph<G, ParallelEdgeFilter<G> > withoutParallelEdges(const G &g, Executor &executor = defaultExecutor()) {
+		return boost::filtered_graph<G, ParallelEdgeFilter<G> >(g, ParallelEdgeFilter<G>(g, executor));
+	}
+
+	// Converts src into a CSR graph, running on executor
+	template<class G, typename VP, typename EP, typename GP>
+	inline void freeze(const G &src, CSRGraph<VP, EP, GP> &dst, Executor &executor = defaultExecutor()) {
+		detail::freeze<false>(src, dst, executor);
+	}
+
+	// Like freeze() but moves labels out of src and frees its adjacency
+	// as the CSR columns fill up, capping peak memory. src is left empty.
+	template<class G, typename VP, typename EP, typename GP>
+	inline void freezeAndRelease(G &src, CSRGraph<VP, EP, GP> &dst, Executor &executor = defaultExecutor()) {
+		detail::freeze<true>(src, dst, executor);
+		src = G();
+	}
+
+	// Converts the directed graph src into a directed CSR graph
+	template<class G, typename VP, typename EP, typename GP, bool I>
+	inline void freeze(const G &src, DirectedCSRGraph<VP, EP, GP, I> &dst, Executor &executor = defaultExecutor()) {
+		detail::freeze<false>(src, dst, executor);
+	}
+
+	template<class G, typename VP, typename EP, typename GP, bool I>
+	inline void freezeAndRelease(G &src, DirectedCSRGraph<VP, EP, GP, I> &dst, Executor &executor = defaultExecutor()) {
+		detail::freeze<true>(src, dst, executor);
+		src = G();
+	}
+}
+
+#endif
@@ -0,0 +1,757 @@
+#ifndef GRAPHIO_GRAPHBUILDER_HPP
+#define GRAPHIO_GRAPHBUILDER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <queue>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <unordered_map>
+#include <boost/utility/string_ref.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <graphio/CSRGraph.hpp>
+#include <graphio/DirectedCSRGraph.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/utility/HugePageAllocator.hpp>
+#include <graphio/utility/LabelSidecar.hpp>
+#include <graphio/utility/SpillFile.hpp>
+#include <graphio/utility/hash.hpp>
+#include <graphio/utility/parallel.hpp>
+
+namespace graphio {
+	namespace detail {
+		struct BuilderEdge {
+			size_t u, v;
+			boost::string_ref label;
+		};
+
+		inline bool operator<(const BuilderEdge &a, const BuilderEdge &b) {
+			return a.u < b.u || (a.u == b.u && a.v < b.v);
+		}
+
+		// Edge of a run being sorted, its label at an offset in an arena
+		struct SpillEdge {
+			size_t u, v, label;
+		};
+
+		inline bool operator<(const SpillEdge &a, const SpillEdge &b) {
+			return a.u < b.u || (a.u == b.u && a.v < b.v);
+		}
+
+		typedef std::unordered_map<boost::string_ref, size_t, StringRefHash> BuilderDictionary;
+
+		// Labels are stored length-prefixed in arenas
+		template<class Arena>
+		inline size_t pushBuilderLabel(Arena &arena, const boost::string_ref &str) {
+			size_t offset = arena.size();
+			uint32_t length = str.length();
+			arena.resize(offset + sizeof(length) + length);
+			std::memcpy(&arena[offset], &length, sizeof(length));
+			std::memcpy(&arena[offset + sizeof(length)], str.data(), length);
+			return offset;
+		}
+
+		template<class Arena>
+		inline boost::string_ref getBuilderLabel(const Arena &arena, size_t offset) {
+			uint32_t length;
+			std::memcpy(&length, &arena[offset], sizeof(length));
+			return boost::string_ref(&arena[offset + sizeof(length)], length);
+		}
+
+		// Collects edges, sorting and writing them to a new temporary file
+		// whenever they take up budget bytes (0 for no limit)
+		class RunWriter {
+			public:
+				RunWriter(std::vector<std::unique_ptr<SpillFile> > &runs, size_t budget, const std::string &directory, Executor &executor)
+				: runs(runs), budget(budget), directory(directory), executor(executor) { }
+
+				inline void add(size_t u, size_t v, const boost::string_ref &label) {
+					SpillEdge e;
+					e.u = u;
+					e.v = v;
+					e.label = pushBuilderLabel(arena, label);
+					buffer.push_back(e);
+					if(budget > 0 && buffer.size() * sizeof(SpillEdge) + arena.size() >= budget) {
+						flush();
+					}
+				}
+
+				void flush() {
+					if(buffer.empty()) return;
+					parallel_stable_sort(buffer.begin(), buffer.end(), std::less<SpillEdge>(), executor);
+
+					runs.push_back(std::unique_ptr<SpillFile>(new SpillFile(directory)));
+					SpillFile &run = *runs.back();
+					for(size_t k = 0; k < buffer.size(); ++k) {
+						run.write(uint64_t(buffer[k].u));
+						run.write(uint64_t(buffer[k].v));
+						run.writeString(getBuilderLabel(arena, buffer[k].label));
+					}
+					run.rewind();
+
+					std::vector<SpillEdge>().swap(buffer);
+					std::vector<char>().swap(arena);
+				}
+
+			private:
+				std::vector<std::unique_ptr<SpillFile> > &runs;
+				size_t budget;
+				std::string directory;
+				Executor &executor;
+				std::vector<SpillEdge> buffer;
+				std::vector<char> arena;
+		};
+
+		// Merges the sorted runs written by a RunWriter, returning each
+		// edge once. Of repeated edges the first added is kept, or the
+		// last with keep_last.
+		class RunMerge {
+			public:
+				RunMerge(std::vector<std::unique_ptr<SpillFile> > &runs, bool keep_last)
+				: runs(runs), labels(runs.size()), keep_last(keep_last) {
+					for(size_t r = 0; r < runs.size(); ++r) {
+						runs[r]->rewind();
+						advance(r);
+					}
+				}
+
+				bool next(size_t &u, size_t &v, boost::string_ref &label) {
+					if(heads.empty()) return false;
+
+					Head h = heads.top();
+					heads.pop();
+					current.swap(labels[h.run]);
+					advance(h.run);
+
+					// Ties come out in the order the edges were added
+					while(!heads.empty() && heads.top().u == h.u && heads.top().v == h.v) {
+						size_t r = heads.top().run;
+						heads.pop();
+						if(keep_last) current.swap(labels[r]);
+						advance(r);
+					}
+
+					u = h.u;
+					v = h.v;
+					label = current;
+					return true;
+				}
+
+			private:
+				struct Head {
+					uint64_t u, v;
+					size_t run;
+
+					inline bool operator>(const Head &h) const {
+						return u > h.u || (u == h.u && (v > h.v || (v == h.v && run > h.run)));
+					}
+				};
+
+				inline void advance(size_t r) {
+					Head h;
+					h.run = r;
+					if(runs[r]->read(h.u)) {
+						if(!runs[r]->read(h.v) || !runs[r]->readString(labels[r])) {
+							throw GraphIOException("Truncated temporary file");
+						}
+						heads.push(h);
+					}
+				}
+
+				std::vector<std::unique_ptr<SpillFile> > &runs;
+				std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heads;
+				std::vector<std::string> labels;
+				std::string current;
+				bool keep_last;
+		};
+	}
+
+	// Collects edges from many threads and builds a graph from them.
+	// Each thread appends to its own Handle without locking. Labeled
+	// vertices are numbered in order of first appearance, handle by handle,
+	// and id records refer to vertex ids directly.
+	//
+	// With a memory budget, handles move their edges to temporary files
+	// when over their share of it. Building then sorts the edges in runs
+	// of at most the budget, writes the runs to temporary files and
+	// merges them, so only the result and the vertex labels need to fit
+	// in memory. writeBinaryCSR() avoids holding the result as well.
+	class GraphBuilder {
+		public:
+			class Handle {
+				public:
+					inline void addVertex(const std::string &label) {
+						Record r;
+						r.u = push(label);
+						r.v = r.label = NONE;
+						records.push_back(r);
+						vertices++;
+						check();
+					}
+
+					inline void addEdge(const std::string &u, const std::string &v, const std::string &label = "") {
+						Record r;
+						r.u = push(u);
+						r.v = push(v);
+						r.label = push(label);
+						records.push_back(r);
+						check();
+					}
+
+					inline void addEdge(size_t u, size_t v) {
+						ids.push_back(std::make_pair(u, v));
+						check();
+					}
+
+					inline size_t size() const {
+						return records.size() - vertices + ids.size() + spilled;
+					}
+
+				private:
+					friend class GraphBuilder;
+
+					struct Record {
+						size_t u, v, label;
+					};
+
+					static const size_t NONE = ~size_t(0);
+
+					Handle(GraphBuilder *owner) : owner(owner), vertices(0), spilled(0) { }
+					Handle(const Handle&);
+					Handle &operator=(const Handle&);
+
+					// Labels are stored length-prefixed in a per-handle arena
+					inline size_t push(const std::string &str) {
+						return detail::pushBuilderLabel(arena, str);
+					}
+
+					inline boost::string_ref get(size_t offset) const {
+						return detail::getBuilderLabel(arena, offset);
+					}
+
+					inline void check() {
+						if(owner->budget > 0 && memory() > owner->handleBudget()) {
+							spill();
+						}
+					}
+
+					inline size_t memory() const {
+						return arena.size() + records.size() * sizeof(Record) + ids.size() * sizeof(ids[0]);
+					}
+
+					// Appends the buffered records to the handle's temporary
+					// files, as local vertex numbers and edge labels
+					void spill() {
+						if(!spilled_records) {
+							spilled_records.reset(new SpillFile(owner->directory));
+							spilled_ids.reset(new SpillFile(owner->directory));
+						}
+
+						for(size_t j = 0; j < records.size(); ++j) {
+							uint64_t u = localId(get(records[j].u));
+							if(records[j].v == NONE) continue;
+							uint64_t v = localId(get(records[j].v));
+							spilled_records->write(u);
+							spilled_records->write(v);
+							spilled_records->writeString(get(records[j].label));
+							spilled++;
+						}
+						for(size_t j = 0; j < ids.size(); ++j) {
+							spilled_ids->write(uint64_t(ids[j].first));
+							spilled_ids->write(uint64_t(ids[j].second));
+							spilled++;
+						}
+
+						decltype(arena)().swap(arena);
+						decltype(records)().swap(records);
+						decltype(ids)().swap(ids);
+						vertices = 0;
+					}
+
+					inline size_t localId(const boost::string_ref &label) {
+						auto it = local.find(label);
+						if(it != local.end()) return it->second;
+
+						names.push_back(label.to_string());
+						order.push_back(names.back());
+						local.insert(std::make_pair(order.back(), order.size() - 1));
+						return order.size() - 1;
+					}
+
+					GraphBuilder *owner;
+					std::vector<char, HugePageAllocator<char> > arena;
+					std::vector<Record, HugePageAllocator<Record> > records;
+					size_t vertices;
+					std::vector<std::pair<size_t, size_t>, HugePageAllocator<std::pair<size_t, size_t> > > ids;
+
+					// Spilled edges and the labels they refer to, numbered
+					// in order of first appearance
+					std::unique_ptr<SpillFile> spilled_records, spilled_ids;
+					size_t spilled;
+					std::deque<std::string> names;
+					std::vector<boost::string_ref> order;
+					detail::BuilderDictionary local;
+			};
+
+			GraphBuilder() : directed(false), keep_last(false), budget(0), handle_count(0) { }
+
+			// Limits the memory of edges buffered in handles, shared evenly
+			// between them, and of each sorted run while building to about
+			// bytes. Edges beyond it go to temporary files in directory.
+			// Vertex labels are always kept in memory. 0 removes the limit.
+			void setMemoryBudget(size_t bytes, const std::string &directory = spillDirectory()) {
+				budget = bytes;
+				this->directory = directory;
+			}
+
+			// Keeps the label of the last occurrence of a repeated edge
+			// instead of the first, as adjacency lists with setS edges and
+			// removeParallelEdges() do
+			void setKeepLast(bool keep) {
+				keep_last = keep;
+			}
+
+			// Returns a new handle owned by the builder.
+			// Safe to call concurrently; use one handle per thread.
+			Handle &handle() {
+				std::lock_guard<std::mutex> lock(mutex);
+				handles.push_back(std::unique_ptr<Handle>(new Handle(this)));
+				handle_count = handles.size();
+				return *handles.back();
+			}
+
+			// Merges all handles, removes duplicate edges and fills g.
+			// Handles must not be written to while building.
+			template<class G>
+			void build(G &g, Executor &executor = defaultExecutor()) {
+				directed = boost::is_directed(g);
+
+				Edges edges;
+				collect(edges, executor);
+
+				g = G(edges.n);
+				for(size_t i = 0; i < edges.labels.size(); ++i) {
+					g[i].label = edges.labels[i].to_string();
+				}
+
+				edges.each([&g](size_t u, size_t v, const boost::string_ref &label) {
+					auto e = add_edge(u, v, g);
+					if(e.second) {
+						g[e.first].label = label.to_string();
+					}
+				});
+			}
+
+			// Builds g in CSR form directly from the sorted edges,
+			// without an intermediate adjacency list
+			template<typename VP, typename EP, typename GP>
+			void build(CSRGraph<VP, EP, GP> &g, Executor &executor = defaultExecutor()) {
+				directed = false;
+
+				Edges edges;
+				collect(edges, executor);
+				size_t n = edges.n;
+				if(n > UINT32_MAX) {
+					throw GraphIOException("Too many vertices for CSR representation");
+				}
+
+				g.offsets.assign(n+1, 0);
+				size_t m = 0;
+				edges.each([&g, &m](size_t u, size_t v, const boost::string_ref&) {
+					g.offsets[u+1]++;
+					if(u != v) g.offsets[v+1]++;
+					m++;
+				});
+				parallel_prefix_sum(g.offsets, executor);
+
+				g.targets.resize(g.offsets[n]);
+				g.edge_ids.resize(g.offsets[n]);
+				g.vertex_props.assign(n, VP());
+				g.edge_props.assign(m, EP());
+				for(size_t i = 0; i < edges.labels.size(); ++i) {
+					g.vertex_props[i].label = edges.labels[i].to_string();
+				}
+
+				// Edges arrive sorted with u <= v, so every adjacency is
+				// filled in target order: lower neighbours before the
+				// vertex's own edges
+				std::vector<size_t> next(g.offsets.begin(), g.offsets.end() - 1);
+				size_t k = 0;
+				edges.each([&g, &next, &k](size_t u, size_t v, const boost::string_ref &label) {
+					g.targets[next[u]] = v;
+					g.edge_ids[next[u]++] = k;
+					if(u != v) {
+						g.targets[next[v]] = u;
+						g.edge_ids[next[v]++] = k;
+					}
+					g.edge_props[k++].label = label.to_string();
+				});
+			}
+
+			// Builds the directed CSR graph g. Edges come out of the merge
+			// sorted by source and target, which is the out-adjacency; the
+			// in-adjacency is only derived when g keeps one.
+			template<typename VP, typename EP, typename GP, bool I>
+			void build(DirectedCSRGraph<VP, EP, GP, I> &g, Executor &executor = defaultExecutor()) {
+				directed = true;
+
+				Edges edges;
+				collect(edges, executor);
+				size_t n = edges.n;
+				if(n > UINT32_MAX) {
+					throw GraphIOException("Too many vertices for CSR representation");
+				}
+
+				g.offsets.assign(n+1, 0);
+				g.targets.clear();
+				g.edge_props.clear();
+				g.vertex_props.assign(n, VP());
+				for(size_t i = 0; i < edges.labels.size(); ++i) {
+					g.vertex_props[i].label = edges.labels[i].to_string();
+				}
+
+				edges.each([&g](size_t u, size_t v, const boost::string_ref &label) {
+					g.offsets[u+1]++;
+					g.targets.push_back(v);
+					g.edge_props.push_back(EP());
+					g.edge_props.back().label = label.to_string();
+				});
+				parallel_prefix_sum(g.offsets, executor);
+				buildInEdges(g, executor);
+			}
+
+			// Writes the undirected graph as a binary CSR file with label
+			// sidecars (see formats/Ligra.hpp) without building it, using
+			// sequential writes only. Each adjacency is the vertex's lower
+			// neighbours, merged from transposed runs, followed by its own
+			// edges. Only the vertex offsets are held in memory.
+			void writeBinaryCSR(const std::string &filename, Executor &executor = defaultExecutor()) {
+				directed = false;
+
+				Edges edges;
+				collect(edges, executor);
+				size_t n = edges.n;
+				if(n > UINT32_MAX) {
+					throw GraphIOException("Too many vertices for 32 bit vertex numbers");
+				}
+
+				std::string elabels = edgeLabelSidecar(filename);
+				std::ofstream sidecar(elabels, std::ios::binary);
+				if(!sidecar.good()) {
+					throw GraphIOException(std::string("Could not open file: ") + elabels);
+				}
+
+				// Count degrees, write edge labels and transpose
+				std::vector<uint64_t> offsets(n+1, 0);
+				std::vector<std::unique_ptr<SpillFile> > lower;
+				detail::RunWriter transposed(lower, budget, directory, executor);
+				std::string buf;
+				bool labeled = false;
+				edges.each([&](size_t u, size_t v, const boost::string_ref &label) {
+					offsets[u+1]++;
+					if(u != v) {
+						offsets[v+1]++;
+						transposed.add(v, u, boost::string_ref());
+					}
+
+					detail::writeSidecarLine(buf, label.to_string());
+					labeled = labeled || !label.empty();
+					if(buf.size() >= GRAPHIO_INPUT_BLOCK_SIZE) {
+						sidecar.write(buf.data(), buf.size());
+						buf.clear();
+					}
+				});
+				transposed.flush();
+				sidecar.write(buf.data(), buf.size());
+				sidecar.close();
+				if(sidecar.fail()) {
+					throw GraphIOException(std::string("Could not write file: ") + elabels);
+				}
+				if(!labeled) {
+					std::remove(elabels.c_str());
+				}
+				std::remove(directedSidecar(filename).c_str());
+				parallel_prefix_sum(offsets, executor);
+
+				std::ofstream out(filename, std::ios::binary);
+				if(!out.good()) {
+					throw GraphIOException(std::string("Could not open file: ") + filename);
+				}
+
+				uint64_t header[3];
+				header[0] = n;
+				header[1] = offsets[n];
+				header[2] = sizeof(header) + (n+1) * sizeof(uint64_t) + offsets[n] * sizeof(uint32_t);
+				out.write(reinterpret_cast<const char*>(header), sizeof(header));
+				out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+				std::vector<uint64_t>().swap(offsets);
+
+				Edges::Cursor upper(edges);
+				detail::RunMerge below(lower, false);
+				size_t uu, uv, lu, lv;
+				boost::string_ref label;
+				bool has_upper = upper.next(uu, uv, label);
+				bool has_lower = below.next(lu, lv, label);
+
+				std::vector<uint32_t> targets;
+				targets.reserve(GRAPHIO_INPUT_BLOCK_SIZE / sizeof(uint32_t));
+				for(size_t x = 0; x < n; ++x) {
+					for(; has_lower && lu == x; has_lower = below.next(lu, lv, label)) {
+						targets.push_back(lv);
+					}
+					for(; has_upper && uu == x; has_upper = upper.next(uu, uv, label)) {
+						targets.push_back(uv);
+					}
+					if(targets.size() >= GRAPHIO_INPUT_BLOCK_SIZE / sizeof(uint32_t)) {
+						out.write(reinterpret_cast<const char*>(targets.data()), targets.size() * sizeof(uint32_t));
+						targets.clear();
+					}
+				}
+				out.write(reinterpret_cast<const char*>(targets.data()), targets.size() * sizeof(uint32_t));
+				out.close();
+				if(out.fail()) {
+					throw GraphIOException(std::string("Could not write file: ") + filename);
+				}
+
+				writeLabelSidecar(vertexLabelSidecar(filename), n, [&edges](size_t i) {
+					return i < edges.labels.size() ? edges.labels[i].to_string() : std::string();
+				});
+			}
+
+		private:
+			typedef detail::BuilderDictionary Dictionary;
+
+			// Numbered vertex labels and the sorted, deduplicated edges,
+			// either in memory or as sorted runs in temporary files
+			struct Edges {
+				std::vector<boost::string_ref> labels;
+				size_t n;
+				bool keep_last;
+				std::vector<detail::BuilderEdge, HugePageAllocator<detail::BuilderEdge> > edges;
+				std::vector<std::unique_ptr<SpillFile> > runs;
+
+				// Reads the edges in order
+				class Cursor {
+					public:
+						Cursor(Edges &edges) : edges(edges), pos(0), merge(edges.runs, edges.keep_last) { }
+
+						inline bool next(size_t &u, size_t &v, boost::string_ref &label) {
+							if(!edges.runs.empty()) {
+								return merge.next(u, v, label);
+							}
+							if(pos == edges.edges.size()) return false;
+
+							u = edges.edges[pos].u;
+							v = edges.edges[pos].v;
+							label = edges.edges[pos].label;
+							pos++;
+							return true;
+						}
+
+					private:
+						Edges &edges;
+						size_t pos;
+						detail::RunMerge merge;
+				};
+
+				// Calls f(u, v, label) for every edge in order
+				template<typename F>
+				void each(F f) {
+					Cursor cursor(*this);
+					size_t u, v;
+					boost::string_ref label;
+					while(cursor.next(u, v, label)) {
+						f(u, v, label);
+					}
+				}
+			};
+
+			void collect(Edges &out, Executor &executor) {
+				bool spilled = false;
+				for(size_t i = 0; i < handles.size(); ++i) {
+					spilled = spilled || handles[i]->spilled_records;
+				}
+
+				out.keep_last = keep_last;
+				if(spilled) {
+					out.n = collectSpilled(out.labels, out.runs, executor);
+				} else {
+					out.n = collect(out.labels, out.edges, executor);
+				}
+			}
+
+			// Numbers all labels and produces the sorted, deduplicated edge list.
+			// Returns the number of vertices.
+			template<class EdgeVector>
+			size_t collect(std::vector<boost::string_ref> &labels, EdgeVector &edges, Executor &executor) {
+				size_t h = handles.size();
+
+				// Number labels locally within each handle in parallel
+				std::vector<Dictionary> local(h);
+				std::vector<std::vector<boost::string_ref> > order(h);
+				parallel_for(h, executor, [&](size_t begin, size_t end) {
+					for(size_t i = begin; i < end; ++i) {
+						const Handle &hd = *handles[i];
+						for(size_t j = 0; j < hd.records.size(); ++j) {
+							insert(local[i], order[i], hd.get(hd.records[j].u));
+							if(hd.records[j].v != Handle::NONE) {
+								insert(local[i], order[i], hd.get(hd.records[j].v));
+							}
+						}
+					}
+				});
+
+				// Merge local dictionaries in handle order
+				Dictionary global;
+				std::vector<std::vector<size_t> > remap(h);
+				for(size_t i = 0; i < h; ++i) {
+					remap[i].resize(order[i].size());
+					for(size_t j = 0; j < order[i].size(); ++j) {
+						remap[i][j] = insert(global, labels, order[i][j]);
+					}
+				}
+
+				// Translate records into edges in parallel
+				std::vector<size_t> offsets(h+1, 0);
+				for(size_t i = 0; i < h; ++i) {
+					offsets[i+1] = offsets[i] + handles[i]->size();
+				}
+				edges.resize(offsets[h]);
+
+				size_t n = labels.size();
+				std::vector<size_t> max_id(h, 0);
+				parallel_for(h, executor, [&](size_t begin, size_t end) {
+					for(size_t i = begin; i < end; ++i) {
+						const Handle &hd = *handles[i];
+						const Dictionary &dict = local[i];
+						const std::vector<size_t> &ids = remap[i];
+
+						size_t pos = offsets[i];
+						for(size_t j = 0; j < hd.records.size(); ++j) {
+							const Handle::Record &r = hd.records[j];
+							if(r.v == Handle::NONE) continue;
+
+							edges[pos].u = ids[dict.find(hd.get(r.u))->second];
+							edges[pos].v = ids[dict.find(hd.get(r.v))->second];
+							edges[pos].label = hd.get(r.label);
+							normalize(edges[pos]);
+							pos++;
+						}
+						for(size_t j = 0; j < hd.ids.size(); ++j, ++pos) {
+							edges[pos].u = hd.ids[j].first;
+							edges[pos].v = hd.ids[j].second;
+							edges[pos].label = boost::string_ref();
+							max_id[i] = std::max(max_id[i], std::max(hd.ids[j].first, hd.ids[j].second) + 1);
+							normalize(edges[pos]);
+						}
+					}
+				});
+				for(size_t i = 0; i < h; ++i) {
+					n = std::max(n, max_id[i]);
+				}
+
+				// Sort and keep the first occurrence of each edge, or the last
+				parallel_stable_sort(edges.begin(), edges.end(), std::less<detail::BuilderEdge>(), executor);
+				size_t m = 0;
+				for(size_t i = 0; i < edges.size(); ++i) {
+					if(m == 0 || edges[m-1].u != edges[i].u || edges[m-1].v != edges[i].v) {
+						edges[m++] = edges[i];
+					} else if(keep_last) {
+						edges[m-1].label = edges[i].label;
+					}
+				}
+				edges.resize(m);
+
+				return n;
+			}
+
+			// Like collect() for handles that spilled: the rest of every handle
+			// is spilled too, then its edges are read back in handle order,
+			// translated to global vertex numbers and written as sorted runs
+			size_t collectSpilled(std::vector<boost::string_ref> &labels, std::vector<std::unique_ptr<SpillFile> > &runs, Executor &executor) {
+				size_t h = handles.size();
+				for(size_t i = 0; i < h; ++i) {
+					handles[i]->spill();
+				}
+
+				Dictionary global;
+				std::vector<std::vector<size_t> > remap(h);
+				for(size_t i = 0; i < h; ++i) {
+					const Handle &hd = *handles[i];
+					remap[i].resize(hd.order.size());
+					for(size_t j = 0; j < hd.order.size(); ++j) {
+						remap[i][j] = insert(global, labels, hd.order[j]);
+					}
+				}
+
+				size_t n = labels.size();
+				detail::RunWriter writer(runs, budget, directory, executor);
+				detail::BuilderEdge e;
+				std::string label;
+				for(size_t i = 0; i < h; ++i) {
+					Handle &hd = *handles[i];
+					uint64_t u, v;
+
+					hd.spilled_records->rewind();
+					while(hd.spilled_records->read(u)) {
+						if(!hd.spilled_records->read(v) || !hd.spilled_records->readString(label)) {
+							throw GraphIOException("Truncated temporary file");
+						}
+						e.u = remap[i][u];
+						e.v = remap[i][v];
+						normalize(e);
+						writer.add(e.u, e.v, label);
+					}
+
+					hd.spilled_ids->rewind();
+					while(hd.spilled_ids->read(u)) {
+						if(!hd.spilled_ids->read(v)) {
+							throw GraphIOException("Truncated temporary file");
+						}
+						e.u = u;
+						e.v = v;
+						normalize(e);
+						writer.add(e.u, e.v, boost::string_ref());
+						n = std::max<size_t>(n, std::max(u, v) + 1);
+					}
+				}
+				writer.flush();
+
+				return n;
+			}
+
+			static inline size_t insert(Dictionary &dict, std::vector<boost::string_ref> &order, const boost::string_ref &label) {
+				auto it = dict.insert(std::make_pair(label, order.size()));
+				if(it.second) {
+					order.push_back(label);
+				}
+				return it.first->second;
+			}
+
+			inline size_t handleBudget() const {
+				return budget / std::max<size_t>(1, handle_count);
+			}
+
+			inline void normalize(detail::BuilderEdge &e) const {
+				if(!directed && e.v < e.u) {
+					std::swap(e.u, e.v);
+				}
+			}
+
+			std::mutex mutex;
+			std::vector<std::unique_ptr<Handle> > handles;
+			bool directed;
+			bool keep_last;
+			size_t budget;
+			std::string directory;
+			std::atomic<size_t> handle_count;
+	};
+}
+
+#endif
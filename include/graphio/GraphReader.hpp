@@ -4,28 +4,55 @@
 #include <string>
 #include <graphio/GraphIOException.hpp>
 #include <graphio/GraphTypes.hpp>
+#include <graphio/ParsePolicy.hpp>
 #include <graphio/formats/LEDA.hpp>
 #include <graphio/formats/SIF.hpp>
 #include <graphio/formats/XGMML.hpp>
 #include <graphio/formats/Tab.hpp>
+#include <graphio/formats/GraphML.hpp>
+#include <graphio/formats/Ligra.hpp>
+#include <graphio/formats/Arrow.hpp>
+#include <graphio/formats/Delimited.hpp>
+#include <graphio/formats/CytoscapeJSON.hpp>
 
 namespace graphio {
-	template<typename G>
+	template<typename Policy = StrictPolicy, typename G>
 	inline void readGraph(const std::string &filename, G &g) {
 		Type type = graphFileType(filename);
 
 		switch(type) {
 			case LEDA:
-				readLEDAFile(filename, g);
+				readLEDAFile<Policy>(filename, g);
 				break;
 			case SIF:
-				readSIFFile(filename, g);
+				readSIFFile<Policy>(filename, g);
 				break;
 			case XGMML:
-				readXGMMLFile(filename, g);
+				readXGMMLFileParallel(filename, g);
 				break;
 			case Tab:
-				readTabFile(filename, g);
+				readTabFile<Policy>(filename, g);
+				break;
+			case GraphML:
+				readGraphMLFile(filename, g);
+				break;
+			case AdjacencyGraph:
+				readAdjacencyGraphFile(filename, g);
+				break;
+			case BinaryCSR:
+				readBinaryCSRFile(filename, g);
+				break;
+			case BinaryEdgeList:
+				readBinaryEdgeListFile(filename, g);
+				break;
+			case Arrow:
+				readArrowFile(filename, g);
+				break;
+			case CSV:
+				readDelimitedFile(filename, g, DelimitedOptions::csv());
+				break;
+			case CytoscapeJSON:
+				readCytoscapeJSONFile(filename, g);
 				break;
 			default:
 				throw GraphIOException("Unknown filetype for file: " + filename);
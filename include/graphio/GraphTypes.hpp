@@ -10,7 +10,14 @@ namespace graphio {
 		LEDA,
 		SIF,
 		XGMML,
-		Tab
+		Tab,
+		GraphML,
+		AdjacencyGraph,
+		BinaryCSR,
+		BinaryEdgeList,
+		Arrow,
+		CSV,
+		CytoscapeJSON
 	};
 
 	inline Type graphFileType(const std::string &filename) {
@@ -27,9 +34,36 @@ namespace graphio {
 		if(boost::algorithm::iends_with(filename, ".tab")) {
 			return Type::Tab;
 		}
+		if(boost::algorithm::iends_with(filename, ".graphml")) {
+			return Type::GraphML;
+		}
+		if(boost::algorithm::iends_with(filename, ".adj")) {
+			return Type::AdjacencyGraph;
+		}
+		if(boost::algorithm::iends_with(filename, ".bcsr")) {
+			return Type::BinaryCSR;
+		}
+		if(boost::algorithm::iends_with(filename, ".bel")) {
+			return Type::BinaryEdgeList;
+		}
+		if(boost::algorithm::iends_with(filename, ".arrow")) {
+			return Type::Arrow;
+		}
+		if(boost::algorithm::iends_with(filename, ".csv")) {
+			return Type::CSV;
+		}
+		if(boost::algorithm::iends_with(filename, ".cyjs")
+		|| boost::algorithm::iends_with(filename, ".json")) {
+			return Type::CytoscapeJSON;
+		}
 
 		return Type::NONE;
 	}
+
+	// Formats that keep part of the graph in files next to the graph file
+	inline bool hasSidecars(Type type) {
+		return type == AdjacencyGraph || type == BinaryCSR || type == BinaryEdgeList || type == Arrow;
+	}
 }
 
 #endif
@@ -2,6 +2,8 @@
 #define GRAPHIO_GRAPHWRITER_HPP
 
 #include <string>
+#include <ostream>
+#include <fstream>
 #include <graphio/GraphIOException.hpp>
 #include <graphio/GraphTypes.hpp>
 #include <graphio/VertexVisitor.hpp>
@@ -10,6 +12,11 @@
 #include <graphio/formats/SIF.hpp>
 #include <graphio/formats/XGMML.hpp>
 #include <graphio/formats/Tab.hpp>
+#include <graphio/formats/GraphML.hpp>
+#include <graphio/formats/Ligra.hpp>
+#include <graphio/formats/Arrow.hpp>
+#include <graphio/formats/Delimited.hpp>
+#include <graphio/formats/CytoscapeJSON.hpp>
 
 namespace graphio {
 	template<typename G>
@@ -28,26 +35,151 @@ namespace graphio {
 		const std::string &filename,
 		const VV &vv,
 		const EV &ev
+	) {
+		writeGraph(g, filename, vv, ev, get(boost::vertex_index, g));
+	}
+
+	template<typename G, typename VV, typename EV, typename IndexMap>
+	inline void writeGraph(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
 	) {
 		Type type = graphFileType(filename);
 
 		switch(type) {
 			case LEDA:
-				writeLEDAFile(g, filename);
+				writeLEDAFile(g, filename, index);
 				break;
 			case SIF:
-				writeSIFFile(g, filename);
+				writeSIFFile(g, filename, index);
 				break;
 			case XGMML:
-				writeXGMMLFile(g, filename, vv, ev);
+				writeXGMMLFile(g, filename, vv, ev, index);
 				break;
 			case Tab:
-				writeTabFile(g, filename, vv, ev);
+				writeTabFile(g, filename, vv, ev, index);
+				break;
+			case GraphML:
+				writeGraphMLFile(g, filename, vv, ev, index);
+				break;
+			case AdjacencyGraph:
+				writeAdjacencyGraphFile(g, filename, index);
+				break;
+			case BinaryCSR:
+				writeBinaryCSRFile(g, filename, index);
+				break;
+			case BinaryEdgeList:
+				writeBinaryEdgeListFile(g, filename, index);
+				break;
+			case Arrow:
+				writeArrowFile(g, filename, vv, ev, index);
+				break;
+			case CSV:
+				writeCSVFile(g, filename, ev, index);
+				break;
+			case CytoscapeJSON:
+				writeCytoscapeJSONFile(g, filename, vv, ev, index);
 				break;
 			default:
 				throw GraphIOException("Unknown filetype for file: " + filename);
 		}
 	}
+
+	// Writes g to out in the given format. title names the graph
+	// in formats that store one. Formats with sidecars write the main
+	// file only, see writeSidecars().
+	template<typename G, typename VV, typename EV, typename IndexMap>
+	inline void writeGraph(
+		const G &g,
+		std::ostream &out,
+		Type type,
+		const std::string &title,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		switch(type) {
+			case LEDA:
+				writeLEDA(g, out, index);
+				break;
+			case SIF:
+				writeSIF(g, out, index);
+				break;
+			case XGMML:
+				writeXGMML(g, out, title, vv, ev, index);
+				break;
+			case Tab:
+				writeTab(g, out, vv, ev, index);
+				break;
+			case GraphML:
+				writeGraphML(g, out, title, vv, ev, index);
+				break;
+			case AdjacencyGraph:
+				writeAdjacencyGraph(g, out, index);
+				break;
+			case BinaryCSR:
+				writeBinaryCSR(g, out, index);
+				break;
+			case BinaryEdgeList:
+				writeBinaryEdgeList(g, out, index);
+				break;
+			case Arrow:
+				writeArrowEdges(g, out, ev, index);
+				break;
+			case CSV:
+				writeCSV(g, out, ev, index);
+				break;
+			case CytoscapeJSON:
+				writeCytoscapeJSON(g, out, title, vv, ev, index);
+				break;
+			default:
+				throw GraphIOException("Unknown filetype for graph: " + title);
+		}
+	}
+
+	// Writes the files that formats with sidecars keep next to filename
+	// through output
+	template<typename G, typename VV, typename EV, typename IndexMap>
+	inline void writeSidecars(
+		const G &g,
+		const std::string &filename,
+		Type type,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index,
+		SidecarOutput &output
+	) {
+		switch(type) {
+			case AdjacencyGraph:
+			case BinaryCSR:
+			case BinaryEdgeList:
+				writeLigraSidecars(g, filename, index, output);
+				break;
+			case Arrow:
+				output.write(arrowVertexFile(filename), [&](std::ostream &out) {
+					writeArrowVertices(g, out, vv, index);
+				});
+				break;
+			default:
+				break;
+		}
+	}
+
+	template<typename G, typename VV, typename EV, typename IndexMap>
+	inline void writeSidecars(
+		const G &g,
+		const std::string &filename,
+		Type type,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		SidecarFiles output;
+		writeSidecars(g, filename, type, vv, ev, index, output);
+	}
 }
 
 #endif
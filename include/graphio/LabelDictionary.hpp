@@ -0,0 +1,422 @@
+#ifndef GRAPHIO_LABELDICTIONARY_HPP
+#define GRAPHIO_LABELDICTIONARY_HPP
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <boost/utility/string_ref.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/utility/parallel.hpp>
+
+namespace graphio {
+	namespace detail {
+		inline uint64_t mixLabelHash(uint64_t x) {
+			x ^= x >> 33;
+			x *= 0xff51afd7ed558ccdULL;
+			x ^= x >> 33;
+			x *= 0xc4ceb9fe1a85ec53ULL;
+			x ^= x >> 33;
+			return x;
+		}
+
+		inline uint64_t hashLabel(const char *s, size_t len) {
+			uint64_t h = 0x9e3779b97f4a7c15ULL ^ (len * 0xc6a4a7935bd1e995ULL);
+			size_t i = 0;
+			for(; i + 8 <= len; i += 8) {
+				uint64_t w;
+				std::memcpy(&w, s + i, 8);
+				h = mixLabelHash(h ^ w) * 0x9e3779b97f4a7c15ULL;
+			}
+			uint64_t w = 0;
+			std::memcpy(&w, s + i, len - i);
+			return mixLabelHash(h ^ w);
+		}
+
+		inline void putVarint(std::vector<uint8_t> &out, size_t &pos, uint64_t x) {
+			while(x >= 0x80) {
+				out[pos++] = uint8_t(x) | 0x80;
+				x >>= 7;
+			}
+			out[pos++] = uint8_t(x);
+		}
+
+		inline size_t varintSize(uint64_t x) {
+			size_t n = 1;
+			while(x >= 0x80) {
+				x >>= 7;
+				n++;
+			}
+			return n;
+		}
+
+		inline uint64_t getVarint(const uint8_t *&p) {
+			uint64_t x = 0;
+			for(int shift = 0; ; shift += 7) {
+				uint8_t b = *p++;
+				x |= uint64_t(b & 0x7f) << shift;
+				if(b < 0x80) return x;
+			}
+		}
+
+		template<typename T>
+		inline void writeVector(std::ostream &out, const std::vector<T> &v) {
+			uint64_t n = v.size();
+			out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+			out.write(reinterpret_cast<const char*>(v.data()), n * sizeof(T));
+		}
+
+		template<typename T>
+		inline void readVector(std::istream &in, std::vector<T> &v) {
+			uint64_t n = 0;
+			in.read(reinterpret_cast<char*>(&n), sizeof(n));
+			if(!in.good()) throw GraphIOException("Truncated label dictionary");
+			v.resize(n);
+			in.read(reinterpret_cast<char*>(v.data()), n * sizeof(T));
+			if(!in.good()) throw GraphIOException("Truncated label dictionary");
+		}
+	}
+
+	// Immutable bidirectional map between vertex ids 0..n-1 and their labels.
+	// Labels are stored sorted and front-coded in blocks of LABELS_PER_BLOCK;
+	// label(id) decodes at most one block. find(label) uses a minimal
+	// perfect hash over the labels and checks the candidate's label, so
+	// both directions take constant time.
+	class LabelDictionary {
+		public:
+			static const size_t LABELS_PER_BLOCK = 16;
+			static const size_t npos = ~size_t(0);
+
+			LabelDictionary() { }
+
+			// Numbers labels by their position. A label given more than
+			// once is found under its first id.
+			LabelDictionary(const std::vector<std::string> &labels, Executor &executor = defaultExecutor()) {
+				std::vector<boost::string_ref> refs(labels.begin(), labels.end());
+				build(refs, executor);
+			}
+
+			// Builds from a reader's label to id map with ids 0..n-1
+			template<class Map>
+			static LabelDictionary fromMap(const Map &map, Executor &executor = defaultExecutor()) {
+				std::vector<boost::string_ref> refs(map.size());
+				for(auto it = map.begin(); it != map.end(); ++it) {
+					size_t id = it->second;
+					if(id >= refs.size()) {
+						throw GraphIOException("Label ids are not contiguous");
+					}
+					refs[id] = it->first;
+				}
+				LabelDictionary dict;
+				dict.build(refs, executor);
+				return dict;
+			}
+
+			// Builds from the vertex labels of g, keyed by vertex index
+			template<class G>
+			static LabelDictionary fromGraph(const G &g, Executor &executor = defaultExecutor()) {
+				std::vector<boost::string_ref> refs(num_vertices(g));
+				for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+					refs[get(boost::vertex_index, g, *vp.first)] = g[*vp.first].label;
+				}
+				LabelDictionary dict;
+				dict.build(refs, executor);
+				return dict;
+			}
+
+			inline size_t size() const {
+				return rank_of.size();
+			}
+
+			std::string label(size_t id) const {
+				std::string s;
+				decode(rank_of[id], s);
+				return s;
+			}
+
+			// Returns the id of label, or npos if it is not in the dictionary
+			size_t find(const boost::string_ref &label) const {
+				if(slots.empty()) return npos;
+
+				uint64_t h = detail::hashLabel(label.data(), label.size());
+				uint32_t id = slots[slot(h)];
+
+				std::string s;
+				decode(rank_of[id], s);
+				return label == s ? id : npos;
+			}
+
+			// Bytes held by the dictionary
+			size_t memoryUsage() const {
+				return data.size()
+					+ block_offsets.size() * sizeof(uint64_t)
+					+ (rank_of.size() + slots.size() + remap.size() + pilots.size()) * sizeof(uint32_t);
+			}
+
+			void save(std::ostream &out) const {
+				out.write(magic(), 8);
+				detail::writeVector(out, data);
+				detail::writeVector(out, block_offsets);
+				detail::writeVector(out, rank_of);
+				detail::writeVector(out, slots);
+				detail::writeVector(out, remap);
+				detail::writeVector(out, pilots);
+				if(!out.good()) {
+					throw GraphIOException("Could not write label dictionary");
+				}
+			}
+
+			static LabelDictionary load(std::istream &in) {
+				char header[8];
+				in.read(header, sizeof(header));
+				if(!in.good() || std::memcmp(header, magic(), sizeof(header)) != 0) {
+					throw GraphIOException("Not a label dictionary");
+				}
+
+				LabelDictionary dict;
+				detail::readVector(in, dict.data);
+				detail::readVector(in, dict.block_offsets);
+				detail::readVector(in, dict.rank_of);
+				detail::readVector(in, dict.slots);
+				detail::readVector(in, dict.remap);
+				detail::readVector(in, dict.pilots);
+				if(dict.slots.size() > dict.rank_of.size()
+				|| dict.block_offsets.size() != (dict.rank_of.size() + LABELS_PER_BLOCK - 1) / LABELS_PER_BLOCK + 1
+				|| dict.remap.size() != dict.slots.size() / 32
+				|| (dict.pilots.empty() && !dict.slots.empty())) {
+					throw GraphIOException("Corrupt label dictionary");
+				}
+
+				// Every index a lookup follows must stay in bounds
+				size_t n = dict.rank_of.size();
+				if(dict.block_offsets[0] != 0 || dict.block_offsets.back() > dict.data.size()) {
+					throw GraphIOException("Corrupt label dictionary");
+				}
+				for(size_t b = 1; b < dict.block_offsets.size(); ++b) {
+					if(dict.block_offsets[b] < dict.block_offsets[b-1]) {
+						throw GraphIOException("Corrupt label dictionary");
+					}
+				}
+				for(size_t i = 0; i < n; ++i) {
+					if(dict.rank_of[i] >= n) {
+						throw GraphIOException("Corrupt label dictionary");
+					}
+				}
+				for(size_t i = 0; i < dict.slots.size(); ++i) {
+					if(dict.slots[i] >= n) {
+						throw GraphIOException("Corrupt label dictionary");
+					}
+				}
+				for(size_t i = 0; i < dict.remap.size(); ++i) {
+					if(dict.remap[i] >= dict.slots.size()) {
+						throw GraphIOException("Corrupt label dictionary");
+					}
+				}
+				return dict;
+			}
+
+		private:
+			static inline const char *magic() {
+				return "GIOLDIC1";
+			}
+
+			void decode(size_t rank, std::string &s) const {
+				const uint8_t *p = data.data() + block_offsets[rank / LABELS_PER_BLOCK];
+				size_t len = detail::getVarint(p);
+				s.assign(reinterpret_cast<const char*>(p), len);
+				p += len;
+				for(size_t k = rank % LABELS_PER_BLOCK; k > 0; --k) {
+					size_t shared = detail::getVarint(p);
+					size_t suffix = detail::getVarint(p);
+					s.resize(shared);
+					s.append(reinterpret_cast<const char*>(p), suffix);
+					p += suffix;
+				}
+			}
+
+			void build(const std::vector<boost::string_ref> &labels, Executor &executor) {
+				size_t n = labels.size();
+				if(n > UINT32_MAX) {
+					throw GraphIOException("Too many labels for label dictionary");
+				}
+
+				// Sort ids by label
+				std::vector<uint32_t> order(n);
+				for(size_t i = 0; i < n; ++i) order[i] = i;
+				parallel_stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+					return labels[a] < labels[b];
+				}, executor);
+
+				// The sort is stable, so the first id of each label comes first
+				rank_of.resize(n);
+				std::vector<char> first(n);
+				parallel_for(n, executor, [&](size_t begin, size_t end) {
+					for(size_t r = begin; r < end; ++r) {
+						rank_of[order[r]] = r;
+						first[r] = r == 0 || labels[order[r]] != labels[order[r-1]];
+					}
+				});
+
+				std::vector<uint32_t> keys;
+				for(size_t r = 0; r < n; ++r) {
+					if(first[r]) keys.push_back(order[r]);
+				}
+
+				encode(labels, order, executor);
+				buildHash(labels, keys, executor);
+			}
+
+			// Front-codes each block against its first label
+			void encode(const std::vector<boost::string_ref> &labels, const std::vector<uint32_t> &order, Executor &executor) {
+				size_t n = labels.size();
+				size_t blocks = (n + LABELS_PER_BLOCK - 1) / LABELS_PER_BLOCK;
+
+				auto encodeBlock = [&](size_t b, std::vector<uint8_t> *out, size_t pos) {
+					size_t bytes = 0;
+					size_t end = std::min(n, (b+1) * LABELS_PER_BLOCK);
+					for(size_t r = b * LABELS_PER_BLOCK; r < end; ++r) {
+						const boost::string_ref &s = labels[order[r]];
+						size_t shared = 0;
+						if(r > b * LABELS_PER_BLOCK) {
+							const boost::string_ref &prev = labels[order[r-1]];
+							size_t limit = std::min(s.size(), prev.size());
+							while(shared < limit && s[shared] == prev[shared]) shared++;
+							bytes += detail::varintSize(shared);
+							if(out) detail::putVarint(*out, pos, shared);
+						}
+						size_t suffix = s.size() - shared;
+						bytes += detail::varintSize(suffix) + suffix;
+						if(out) {
+							detail::putVarint(*out, pos, suffix);
+							std::memcpy(out->data() + pos, s.data() + shared, suffix);
+							pos += suffix;
+						}
+					}
+					return bytes;
+				};
+
+				block_offsets.assign(blocks + 1, 0);
+				parallel_for(blocks, executor, [&](size_t begin, size_t end) {
+					for(size_t b = begin; b < end; ++b) {
+						block_offsets[b+1] = encodeBlock(b, NULL, 0);
+					}
+				});
+
+				parallel_prefix_sum(block_offsets, executor);
+
+				data.resize(block_offsets[blocks]);
+				parallel_for(blocks, executor, [&](size_t begin, size_t end) {
+					for(size_t b = begin; b < end; ++b) {
+						encodeBlock(b, &data, block_offsets[b]);
+					}
+				});
+			}
+
+			// Hash and displace: keys are grouped into buckets of about three,
+			// with 60% of keys going to 30% of buckets, and each bucket, largest
+			// first, searches for a pilot that sends all of its keys to free
+			// positions. Positions range over a table 3% larger than n; those
+			// past n are remapped to the slots left free below n. Only the
+			// ids in keys, whose labels are distinct, are hashed.
+			void buildHash(const std::vector<boost::string_ref> &labels, const std::vector<uint32_t> &keys, Executor &executor) {
+				size_t n = keys.size();
+				slots.assign(n, 0);
+				remap.assign(n / 32, 0);
+				pilots.assign(std::max<size_t>(1, n / 3), 0);
+				if(n == 0) return;
+
+				std::vector<uint64_t> hashes(n);
+				parallel_for(n, executor, [&](size_t begin, size_t end) {
+					for(size_t i = begin; i < end; ++i) {
+						const boost::string_ref &label = labels[keys[i]];
+						hashes[i] = detail::hashLabel(label.data(), label.size());
+					}
+				});
+
+				size_t m = pilots.size();
+				std::vector<size_t> start(m+1, 0);
+				for(size_t i = 0; i < n; ++i) start[bucket(hashes[i]) + 1]++;
+				for(size_t b = 0; b < m; ++b) start[b+1] += start[b];
+
+				std::vector<uint32_t> members(n);
+				std::vector<size_t> fill(start.begin(), start.end() - 1);
+				for(size_t i = 0; i < n; ++i) members[fill[bucket(hashes[i])]++] = i;
+
+				std::vector<uint32_t> buckets(m);
+				for(size_t b = 0; b < m; ++b) buckets[b] = b;
+				std::stable_sort(buckets.begin(), buckets.end(), [&](uint32_t a, uint32_t b) {
+					return start[a+1] - start[a] > start[b+1] - start[b];
+				});
+
+				std::vector<bool> taken(n + remap.size(), false);
+				std::vector<size_t> pos;
+				for(size_t k = 0; k < m; ++k) {
+					size_t b = buckets[k];
+					if(start[b] == start[b+1]) break;
+
+					for(uint64_t pilot = 0; ; ++pilot) {
+						if(pilot > UINT32_MAX) {
+							throw GraphIOException("Could not build label hash");
+						}
+
+						pos.clear();
+						bool ok = true;
+						for(size_t j = start[b]; j < start[b+1] && ok; ++j) {
+							size_t p = position(hashes[members[j]], pilot);
+							ok = !taken[p] && std::find(pos.begin(), pos.end(), p) == pos.end();
+							pos.push_back(p);
+						}
+						if(!ok) continue;
+
+						for(size_t j = 0; j < pos.size(); ++j) {
+							taken[pos[j]] = true;
+							if(pos[j] < n) slots[pos[j]] = keys[members[start[b] + j]];
+							else remap[pos[j] - n] = keys[members[start[b] + j]];
+						}
+						pilots[b] = pilot;
+						break;
+					}
+				}
+
+				// Move keys placed past n into the free slots
+				size_t free = 0;
+				for(size_t p = 0; p < remap.size(); ++p) {
+					if(!taken[n + p]) continue;
+					while(taken[free]) free++;
+					slots[free] = remap[p];
+					remap[p] = free++;
+				}
+			}
+
+			inline size_t bucket(uint64_t h) const {
+				size_t m = pilots.size();
+				size_t dense = m * 3 / 10;
+				if(dense == 0) return h % m;
+				if((h >> 32) < uint64_t(0.6 * 4294967296.0)) return h % dense;
+				return dense + h % (m - dense);
+			}
+
+			inline size_t position(uint64_t h, uint32_t pilot) const {
+				return detail::mixLabelHash(h ^ (uint64_t(pilot) * 0x9e3779b97f4a7c15ULL)) % (slots.size() + remap.size());
+			}
+
+			inline size_t slot(uint64_t h) const {
+				size_t p = position(h, pilots[bucket(h)]);
+				return p < slots.size() ? p : remap[p - slots.size()];
+			}
+
+			std::vector<uint8_t> data;
+			std::vector<uint64_t> block_offsets;
+			std::vector<uint32_t> rank_of;
+			std::vector<uint32_t> slots;
+			std::vector<uint32_t> remap;
+			std::vector<uint32_t> pilots;
+	};
+}
+
+#endif
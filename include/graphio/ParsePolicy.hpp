@@ -0,0 +1,113 @@
+#ifndef GRAPHIO_PARSEPOLICY_HPP
+#define GRAPHIO_PARSEPOLICY_HPP
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <graphio/utility/split.hpp>
+#include <graphio/GraphIOException.hpp>
+
+namespace graphio {
+	// Default policy. Trims lines, handles quoting and throws on malformed input.
+	struct StrictPolicy {
+		template<class Input>
+		static inline Input &readLEDALine(Input &is, std::string &str) {
+			do {
+				if(!getline(is, str)) {
+					throw GraphIOException("Unexpected end of LEDA file");
+				}
+				boost::algorithm::trim(str);
+			} while(str.length() == 0 || str[0] == '#');
+
+			return is;
+		}
+
+		static inline void split(const std::string &str, const std::string &sep, std::vector<std::string> &parts) {
+			escaped_split(str, sep, parts);
+		}
+
+		static inline void checkColumns(const std::string &line, const std::vector<std::string> &parts, size_t count) {
+			if(parts.size() < count) {
+				throw GraphIOException(std::string("Too few columns in line: ") + line);
+			}
+		}
+
+		static inline size_t parseSize(const std::string &str) {
+			try {
+				return boost::lexical_cast<size_t>(str);
+			} catch(boost::bad_lexical_cast &) {
+				throw GraphIOException("Malformed number: " + str);
+			}
+		}
+
+		static inline std::string parseLEDALabel(const std::string &str) {
+			size_t begin = str.find("|{");
+			size_t end = str.rfind("}|");
+
+			if(begin == std::string::npos || end == std::string::npos || end < begin+2) {
+				throw GraphIOException("Malformed label: " + str);
+			}
+
+			return str.substr(begin+2, end-begin-2);
+		}
+
+		static inline void parseLEDAEdge(const std::string &line, size_t &u, size_t &v, std::string &label) {
+			std::vector<std::string> parts;
+			boost::split(parts, line, boost::is_any_of(" \t"), boost::token_compress_on);
+			checkColumns(line, parts, 4);
+
+			u = parseSize(parts[0]);
+			v = parseSize(parts[1]);
+			if(u == 0 || v == 0) {
+				throw GraphIOException("Malformed edge: " + line);
+			}
+			u--; v--;
+
+			label = parseLEDALabel(line);
+		}
+	};
+
+	// Policy for well-formed, machine-generated input.
+	// No trimming, quote handling or bounds checks are performed.
+	struct TrustedPolicy {
+		template<class Input>
+		static inline Input &readLEDALine(Input &is, std::string &str) {
+			do {
+				getline(is, str);
+			} while(is && (str.length() == 0 || str[0] == '#'));
+
+			return is;
+		}
+
+		static inline void split(const std::string &str, const std::string &sep, std::vector<std::string> &parts) {
+			fast_split(str, sep, parts);
+		}
+
+		static inline void checkColumns(const std::string &, const std::vector<std::string> &, size_t) { }
+
+		static inline size_t parseSize(const std::string &str) {
+			return std::strtoul(str.c_str(), NULL, 10);
+		}
+
+		// Labels are always written as "|{label}|"
+		static inline std::string parseLEDALabel(const std::string &str) {
+			return str.substr(2, str.length()-4);
+		}
+
+		// Edges are always written as "u v 0 |{label}|"
+		static inline void parseLEDAEdge(const std::string &line, size_t &u, size_t &v, std::string &label) {
+			const char *begin = line.c_str();
+			char *end;
+			u = std::strtoul(begin, &end, 10) - 1;
+			v = std::strtoul(end, &end, 10) - 1;
+			std::strtoul(end, &end, 10);
+
+			size_t pos = end - begin + 1;
+			label.assign(line, pos+2, line.length()-pos-4);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef GRAPHIO_SNAPSHOTWRITER_HPP
+#define GRAPHIO_SNAPSHOTWRITER_HPP
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <future>
+#include <ostream>
+#include <cstdio>
+#include <type_traits>
+#include <boost/graph/graph_traits.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/GraphTypes.hpp>
+#include <graphio/GraphWriter.hpp>
+#include <graphio/CSRGraph.hpp>
+#include <graphio/DirectedCSRGraph.hpp>
+#include <graphio/Freeze.hpp>
+#include <graphio/utility/basename.hpp>
+#include <graphio/utility/Executor.hpp>
+#include <graphio/utility/LabelSidecar.hpp>
+#include <graphio/utility/ThrottledOutput.hpp>
+
+namespace graphio {
+	struct SnapshotOptions {
+		// Executor for capturing the snapshot and, unless low_priority
+		// is set, for writing it. NULL selects defaultExecutor().
+		Executor *executor;
+		// Write rate limit in bytes per second, 0 for none
+		size_t bandwidth;
+		// Write on a dedicated thread at idle I/O and lowest CPU priority.
+		// The thread's priority cannot be raised again afterwards, so it
+		// is never an executor thread.
+		bool low_priority;
+
+		SnapshotOptions() : executor(NULL), bandwidth(0), low_priority(true) { }
+
+		inline Executor &getExecutor() const {
+			return executor ? *executor : defaultExecutor();
+		}
+	};
+
+	namespace detail {
+		// Writes sidecars to temporary files at the snapshot's bandwidth.
+		// commit() renames them into place and removes stale ones, the
+		// destructor removes whatever was not committed.
+		class SnapshotSidecars : public SidecarOutput {
+			public:
+				SnapshotSidecars(size_t bandwidth) : bandwidth(bandwidth) { }
+
+				~SnapshotSidecars() {
+					for(size_t i = 0; i < staged.size(); ++i) {
+						std::remove(staged[i].first.c_str());
+					}
+				}
+
+				void write(const std::string &filename, const std::function<void(std::ostream&)> &write) {
+					std::string tmp = filename + ".tmp";
+					staged.push_back(std::make_pair(tmp, filename));
+
+					ThrottledFileBuffer buf(tmp, bandwidth);
+					std::ostream out(&buf);
+					write(out);
+					out.flush();
+					if(!out.good() || !buf.close()) {
+						throw GraphIOException("Could not write file: " + tmp);
+					}
+				}
+
+				void remove(const std::string &filename) {
+					stale.push_back(filename);
+				}
+
+				void commit() {
+					for(size_t i = 0; i < staged.size(); ++i) {
+						if(std::rename(staged[i].first.c_str(), staged[i].second.c_str()) != 0) {
+							throw GraphIOException("Could not rename " + staged[i].first + " to " + staged[i].second);
+						}
+					}
+					staged.clear();
+					for(size_t i = 0; i < stale.size(); ++i) {
+						std::remove(stale[i].c_str());
+					}
+				}
+
+			private:
+				size_t bandwidth;
+				std::vector<std::pair<std::string, std::string> > staged;
+				std::vector<std::string> stale;
+		};
+
+		// Writes g and its sidecars to temporary files that are renamed
+		// into place once all are complete, so readers never see a
+		// partial snapshot.
+		template<class G>
+		void writeSnapshotFile(const G &g, const std::string &filename, const SnapshotOptions &options) {
+			Type type = graphFileType(filename);
+			if(type == NONE) {
+				throw GraphIOException("Unknown filetype for file: " + filename);
+			}
+
+			if(options.low_priority) {
+				lowerThreadPriority();
+			}
+
+			std::string tmp = filename + ".tmp";
+			{
+				ThrottledFileBuffer buf(tmp, options.bandwidth);
+				std::ostream out(&buf);
+				VertexVisitor vv;
+				EdgeVisitor ev;
+				writeGraph(g, out, type, basename(filename), vv, ev, get(boost::vertex_index, g));
+				out.flush();
+				if(!out.good() || !buf.close()) {
+					std::remove(tmp.c_str());
+					throw GraphIOException("Could not write file: " + tmp);
+				}
+			}
+
+			SnapshotSidecars sidecars(options.bandwidth);
+			try {
+				VertexVisitor vv;
+				EdgeVisitor ev;
+				writeSidecars(g, filename, type, vv, ev, get(boost::vertex_index, g), sidecars);
+				sidecars.commit();
+			} catch(...) {
+				std::remove(tmp.c_str());
+				throw;
+			}
+
+			if(std::rename(tmp.c_str(), filename.c_str()) != 0) {
+				std::remove(tmp.c_str());
+				throw GraphIOException("Could not rename " + tmp + " to " + filename);
+			}
+		}
+	}
+
+	// Writes an immutable snapshot in the background. The returned
+	// future becomes ready when the file is in place and rethrows any
+	// write error.
+	template<class G>
+	inline std::future<void> writeSnapshot(
+		std::shared_ptr<const G> g,
+		const std::string &filename,
+		const SnapshotOptions &options = SnapshotOptions()
+	) {
+		auto write = [g, filename, options]() {
+			detail::writeSnapshotFile(*g, filename, options);
+		};
+
+		if(options.low_priority) {
+			return std::async(std::launch::async, write);
+		}
+		return runAsync(options.getExecutor(), write);
+	}
+
+	// Captures a CSR copy of the live graph g, a DirectedCSRGraph if g
+	// is directed, and writes it in the background. Only the capture,
+	// which runs on the options' executor before returning, needs g to
+	// be unchanged; g may be modified as soon as this returns.
+	template<class G>
+	inline std::future<void> writeSnapshot(
+		const G &g,
+		const std::string &filename,
+		const SnapshotOptions &options = SnapshotOptions()
+	) {
+		typedef typename std::conditional<boost::is_directed_graph<G>::value,
+			DirectedCSRGraph<typename G::vertex_bundled, typename G::edge_bundled, typename G::graph_bundled>,
+			CSRGraph<typename G::vertex_bundled, typename G::edge_bundled, typename G::graph_bundled>
+		>::type Frozen;
+
+		std::shared_ptr<Frozen> frozen = std::make_shared<Frozen>();
+		freeze(g, *frozen, options.getExecutor());
+		return writeSnapshot(std::shared_ptr<const Frozen>(frozen), filename, options);
+	}
+}
+
+#endif
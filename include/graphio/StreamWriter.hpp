@@ -0,0 +1,785 @@
+#ifndef GRAPHIO_STREAMWRITER_HPP
+#define GRAPHIO_STREAMWRITER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <streambuf>
+#include <graphio/Graph.hpp>
+#include <graphio/CSRGraph.hpp>
+#include <graphio/DirectedCSRGraph.hpp>
+#include <graphio/GraphBuilder.hpp>
+#include <graphio/GraphWriter.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/GraphTypes.hpp>
+#include <graphio/VertexVisitor.hpp>
+#include <graphio/EdgeVisitor.hpp>
+#include <graphio/utility/SpillFile.hpp>
+#include <graphio/utility/LabelSidecar.hpp>
+#include <graphio/utility/basename.hpp>
+#include <graphio/utility/escape.hpp>
+
+// Writers that take vertices and edges one at a time and write them to
+// the file as they come, for graphs that are generated rather than held:
+//
+//   graphio::StreamWriter<> w("network.xgmml");
+//   size_t a = w.addVertex("TP53"), b = w.addVertex("MDM2");
+//   w.addEdge(a, b, "pp");
+//   w.close();
+//
+// Records are written as by writeGraph(), edges in the order they are
+// added. Formats listing all vertices before any edge (LEDA, XGMML,
+// GraphML, Cytoscape JSON) spool the edges to a temporary file until
+// close(); LEDA patches its vertex count in afterwards. SIF, tab, CSV,
+// Arrow and the Ligra formats keep the vertex labels in memory to write
+// them with the edges or at the end.
+namespace graphio {
+	struct StreamWriterOptions {
+		// Written as directed, as writeGraph() does for directed graphs
+		bool directed;
+		// Graph label for formats that store one; the file's basename if empty
+		std::string title;
+		// Memory for sorting the edges of .adj and .bcsr files, which need
+		// them grouped by vertex, and where to spill beyond it. 0 for no limit.
+		size_t memory;
+		std::string directory;
+
+		StreamWriterOptions() : directed(false), memory(0), directory(spillDirectory()) { }
+	};
+
+	namespace detail {
+		// Attribute columns of a visitor
+		struct StreamAttributes {
+			std::vector<std::string> names, types;
+
+			template<typename Visitor>
+			StreamAttributes(const Visitor &visitor) {
+				for(size_t a = 0; a < visitor.count(); ++a) {
+					names.push_back(visitor.name(a));
+					types.push_back(visitor.type(a));
+				}
+			}
+
+			inline size_t count() const {
+				return names.size();
+			}
+		};
+
+		// One output format. Vertices are numbered in the order they are
+		// given, attributes come as strings in visitor order.
+		class StreamFormat {
+			public:
+				virtual ~StreamFormat() { }
+
+				virtual void vertex(size_t id, const std::string &label, const std::vector<std::string> &attributes) = 0;
+				virtual void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string> &attributes) = 0;
+				virtual void finish() = 0;
+		};
+
+		inline void openStreamFile(std::ofstream &file, const std::string &filename, std::ios::openmode mode = std::ios::out) {
+			file.open(filename, mode);
+			if(!file.good()) {
+				throw GraphIOException(std::string("Could not open file: ") + filename);
+			}
+		}
+
+		inline void closeStreamFile(std::ofstream &file, const std::string &filename) {
+			file.close();
+			if(file.fail()) {
+				throw GraphIOException(std::string("Could not write file: ") + filename);
+			}
+		}
+
+		// Stream buffer appending to a SpillFile, so the format writers
+		// can spool text through an ostream
+		class SpillStreamBuffer : public std::streambuf {
+			public:
+				SpillStreamBuffer(SpillFile &file) : file(file) { }
+
+			protected:
+				int_type overflow(int_type c) {
+					if(c != traits_type::eof()) {
+						char ch = traits_type::to_char_type(c);
+						file.write(&ch, 1);
+					}
+					return traits_type::not_eof(c);
+				}
+
+				std::streamsize xsputn(const char *s, std::streamsize n) {
+					file.write(s, n);
+					return n;
+				}
+
+			private:
+				SpillFile &file;
+		};
+
+		// Edge text held back until all vertices are written
+		class EdgeSpool {
+			public:
+				EdgeSpool(const std::string &directory) : file(directory), buffer(file), out(&buffer) { }
+
+				// Copies the spooled text to dest
+				void copyTo(std::ostream &dest) {
+					file.rewind();
+					std::vector<char> buf(GRAPHIO_INPUT_BLOCK_SIZE);
+					for(uint64_t left = file.size(); left > 0; ) {
+						size_t n = std::min<uint64_t>(left, buf.size());
+						file.read(buf.data(), n);
+						dest.write(buf.data(), n);
+						left -= n;
+					}
+				}
+
+				SpillFile file;
+				SpillStreamBuffer buffer;
+				std::ostream out;
+		};
+
+		class SIFStreamFormat : public StreamFormat {
+			public:
+				SIFStreamFormat(const std::string &filename) : filename(filename) {
+					openStreamFile(file, filename);
+				}
+
+				void vertex(size_t, const std::string &label, const std::vector<std::string>&) {
+					labels.push_back(label);
+					linked.push_back(false);
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string>&) {
+					const EscapeScanner &scanner = sifEscapes();
+					writeField(file, labels[u], scanner);
+					file << " ";
+					if(label.length() > 0) {
+						writeField(file, label, scanner);
+					} else {
+						file << "?";
+					}
+					file << " ";
+					writeField(file, labels[v], scanner);
+					file << "\n";
+					linked[u] = linked[v] = true;
+				}
+
+				// Vertices without edges go on lines of their own
+				void finish() {
+					for(size_t i = 0; i < labels.size(); ++i) {
+						if(!linked[i]) {
+							writeField(file, labels[i], sifEscapes());
+							file << "\n";
+						}
+					}
+					closeStreamFile(file, filename);
+				}
+
+			private:
+				std::string filename;
+				std::ofstream file;
+				std::vector<std::string> labels;
+				std::vector<bool> linked;
+		};
+
+		class TabStreamFormat : public StreamFormat {
+			public:
+				TabStreamFormat(const std::string &filename, const StreamAttributes &ea) : filename(filename) {
+					openStreamFile(file, filename);
+					file << "INTERACTOR_A\tINTERACTOR_B\tlabel";
+					for(size_t a = 0; a < ea.count(); ++a) {
+						file << "\t";
+						writeField(file, ea.names[a], tabEscapes());
+					}
+					file << "\n";
+				}
+
+				void vertex(size_t, const std::string &label, const std::vector<std::string>&) {
+					labels.push_back(label);
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string> &attributes) {
+					const EscapeScanner &scanner = tabEscapes();
+					writeField(file, labels[u], scanner);
+					file << "\t";
+					writeField(file, labels[v], scanner);
+					if(label.length() > 0) {
+						file << "\t";
+						writeField(file, label, scanner);
+					} else {
+						file << "\tNA";
+					}
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						file << "\t";
+						writeField(file, attributes[a], scanner);
+					}
+					file << "\n";
+				}
+
+				void finish() {
+					closeStreamFile(file, filename);
+				}
+
+			private:
+				std::string filename;
+				std::ofstream file;
+				std::vector<std::string> labels;
+		};
+
+		class CSVStreamFormat : public StreamFormat {
+			public:
+				CSVStreamFormat(const std::string &filename, const StreamAttributes &ea) : filename(filename) {
+					openStreamFile(file, filename);
+					file << "source,target,label";
+					for(size_t a = 0; a < ea.count(); ++a) {
+						file << ",";
+						writeCSVField(file, ea.names[a]);
+					}
+					file << "\n";
+				}
+
+				void vertex(size_t, const std::string &label, const std::vector<std::string>&) {
+					labels.push_back(label);
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string> &attributes) {
+					writeCSVField(file, labels[u]);
+					file << ",";
+					writeCSVField(file, labels[v]);
+					file << ",";
+					writeCSVField(file, label);
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						file << ",";
+						writeCSVField(file, attributes[a]);
+					}
+					file << "\n";
+				}
+
+				void finish() {
+					closeStreamFile(file, filename);
+				}
+
+			private:
+				std::string filename;
+				std::ofstream file;
+				std::vector<std::string> labels;
+		};
+
+		// The vertex count goes before the vertices, so it is written as
+		// a blank placeholder and patched in by finish()
+		class LEDAStreamFormat : public StreamFormat {
+			public:
+				LEDAStreamFormat(const std::string &filename, const StreamWriterOptions &options)
+				: filename(filename), spool(options.directory), n(0), m(0) {
+					openStreamFile(file, filename);
+					file << "LEDA.GRAPH\nstring\nstring\n";
+					file << (options.directed ? "-1" : "-2") << "\n";
+					count_pos = file.tellp();
+					file << std::string(COUNT_WIDTH, ' ') << "\n";
+				}
+
+				void vertex(size_t, const std::string &label, const std::vector<std::string>&) {
+					file << "|{" << label << "}|\n";
+					n++;
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string>&) {
+					spool.out << (u+1) << " " << (v+1) << " 0 |{" << label << "}|\n";
+					m++;
+				}
+
+				void finish() {
+					file << m << "\n";
+					spool.copyTo(file);
+					file.seekp(count_pos);
+					file << std::setw(COUNT_WIDTH) << n;
+					closeStreamFile(file, filename);
+				}
+
+			private:
+				static const int COUNT_WIDTH = 20;
+
+				std::string filename;
+				std::ofstream file;
+				std::streampos count_pos;
+				EdgeSpool spool;
+				size_t n, m;
+		};
+
+		class XGMMLStreamFormat : public StreamFormat {
+			public:
+				XGMMLStreamFormat(const std::string &filename, const StreamAttributes &va, const StreamAttributes &ea, const StreamWriterOptions &options)
+				: filename(filename), va(va), ea(ea), spool(options.directory) {
+					openStreamFile(file, filename);
+					file << "<?xml version=\"1.0\"?>\n";
+					file << "<graph label=\"";
+					writeXMLEscaped(file, options.title);
+					file << "\" ";
+					file << "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" ";
+					file << "xmlns:xlink=\"http://www.w3.org/1999/xlink\" ";
+					file << "xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\" ";
+					file << "xmlns=\"http://www.cs.rpi.edu/XGMML\" ";
+					file << "directed=\"" << (options.directed ? 1 : 0) << "\">\n";
+				}
+
+				void vertex(size_t id, const std::string &label, const std::vector<std::string> &attributes) {
+					file << "\t<node id=\"" << (id+1) << "\" label=\"";
+					writeXMLEscaped(file, label);
+					file << "\">\n";
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						writeXGMMLAttribute(file, va.names[a], va.types[a], attributes[a], "/>\n");
+					}
+					file << "\t</node>\n";
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string> &attributes) {
+					std::ostream &out = spool.out;
+					out << "\t<edge source=\"" << (u+1) << "\" target=\"" << (v+1) << "\" label=\"";
+					writeXMLEscaped(out, label);
+					out << "\">\n";
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						writeXGMMLAttribute(out, ea.names[a], ea.types[a], attributes[a], " />\n");
+					}
+					out << "\t</edge>\n";
+				}
+
+				void finish() {
+					spool.copyTo(file);
+					file << "</graph>";
+					closeStreamFile(file, filename);
+				}
+
+			private:
+				std::string filename;
+				std::ofstream file;
+				StreamAttributes va, ea;
+				EdgeSpool spool;
+		};
+
+		class GraphMLStreamFormat : public StreamFormat {
+			public:
+				GraphMLStreamFormat(const std::string &filename, const StreamAttributes &va, const StreamAttributes &ea, const StreamWriterOptions &options)
+				: filename(filename), spool(options.directory) {
+					openStreamFile(file, filename);
+					file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+					file << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\" ";
+					file << "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" ";
+					file << "xsi:schemaLocation=\"http://graphml.graphdrawing.org/xmlns ";
+					file << "http://graphml.graphdrawing.org/xmlns/1.0/graphml.xsd\">\n";
+
+					writeGraphMLKey(file, "label", "node", "label", "string");
+					writeGraphMLKey(file, "elabel", "edge", "label", "string");
+					for(size_t a = 0; a < va.count(); ++a) {
+						writeGraphMLKey(file, "v" + std::to_string(a), "node", va.names[a], va.types[a]);
+					}
+					for(size_t a = 0; a < ea.count(); ++a) {
+						writeGraphMLKey(file, "e" + std::to_string(a), "edge", ea.names[a], ea.types[a]);
+					}
+
+					file << "\t<graph id=\"";
+					writeXMLEscaped(file, options.title);
+					file << "\" edgedefault=\"" << (options.directed ? "directed" : "undirected") << "\">\n";
+				}
+
+				void vertex(size_t id, const std::string &label, const std::vector<std::string> &attributes) {
+					file << "\t\t<node id=\"n" << id << "\">\n";
+					writeGraphMLData(file, "\t\t\t", "label", label);
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						writeGraphMLData(file, "\t\t\t", "v" + std::to_string(a), attributes[a]);
+					}
+					file << "\t\t</node>\n";
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string> &attributes) {
+					std::ostream &out = spool.out;
+					out << "\t\t<edge source=\"n" << u << "\" target=\"n" << v << "\"";
+					if(label.empty() && attributes.empty()) {
+						out << "/>\n";
+						return;
+					}
+					out << ">\n";
+					if(label.size() > 0) {
+						writeGraphMLData(out, "\t\t\t", "elabel", label);
+					}
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						writeGraphMLData(out, "\t\t\t", "e" + std::to_string(a), attributes[a]);
+					}
+					out << "\t\t</edge>\n";
+				}
+
+				void finish() {
+					spool.copyTo(file);
+					file << "\t</graph>\n";
+					file << "</graphml>\n";
+					closeStreamFile(file, filename);
+				}
+
+			private:
+				std::string filename;
+				std::ofstream file;
+				EdgeSpool spool;
+		};
+
+		class CytoscapeStreamFormat : public StreamFormat {
+			public:
+				CytoscapeStreamFormat(const std::string &filename, const StreamAttributes &va, const StreamAttributes &ea, const StreamWriterOptions &options)
+				: filename(filename), va(va), ea(ea), spool(options.directory), n(0), m(0) {
+					openStreamFile(file, filename);
+					file << "{\"data\":{\"name\":\"";
+					writeJSONEscaped(file, options.title);
+					file << "\"},\n\"elements\":{\n\"nodes\":[";
+				}
+
+				void vertex(size_t id, const std::string &label, const std::vector<std::string> &attributes) {
+					file << (n++ == 0 ? "\n" : ",\n") << "{\"data\":{\"id\":\"n" << id << "\",\"label\":\"";
+					writeJSONEscaped(file, label);
+					file << '"';
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						file << ",\"";
+						writeJSONEscaped(file, va.names[a]);
+						file << "\":";
+						writeCytoscapeValue(file, va.types[a], attributes[a]);
+					}
+					file << "}}";
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string> &attributes) {
+					std::ostream &out = spool.out;
+					out << (m == 0 ? "\n" : ",\n") << "{\"data\":{\"id\":\"e" << m << "\",\"source\":\"n" << u << "\",\"target\":\"n" << v << "\",\"label\":\"";
+					writeJSONEscaped(out, label);
+					out << '"';
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						out << ",\"";
+						writeJSONEscaped(out, ea.names[a]);
+						out << "\":";
+						writeCytoscapeValue(out, ea.types[a], attributes[a]);
+					}
+					out << "}}";
+					m++;
+				}
+
+				void finish() {
+					file << "\n],\n\"edges\":[";
+					spool.copyTo(file);
+					file << "\n]}}\n";
+					closeStreamFile(file, filename);
+				}
+
+			private:
+				std::string filename;
+				std::ofstream file;
+				StreamAttributes va, ea;
+				EdgeSpool spool;
+				size_t n, m;
+		};
+
+		// Edge pairs and both label sidecars are written as they come.
+		// The edge label sidecar is removed again if no edge had a label.
+		class BinaryEdgeListStreamFormat : public StreamFormat {
+			public:
+				BinaryEdgeListStreamFormat(const std::string &filename)
+				: filename(filename), vertex_sidecar(vertexLabelSidecar(filename)), edge_sidecar(edgeLabelSidecar(filename)), labeled(false) {
+					openStreamFile(file, filename, std::ios::binary);
+					openStreamFile(vertex_labels, vertex_sidecar, std::ios::binary);
+					openStreamFile(edge_labels, edge_sidecar, std::ios::binary);
+				}
+
+				void vertex(size_t id, const std::string &label, const std::vector<std::string>&) {
+					if(id > UINT32_MAX) {
+						throw GraphIOException("Too many vertices for 32 bit vertex numbers");
+					}
+					line.clear();
+					writeSidecarLine(line, label);
+					vertex_labels.write(line.data(), line.size());
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string>&) {
+					uint32_t pair[2] = { uint32_t(u), uint32_t(v) };
+					file.write(reinterpret_cast<const char*>(pair), sizeof(pair));
+
+					line.clear();
+					writeSidecarLine(line, label);
+					edge_labels.write(line.data(), line.size());
+					labeled = labeled || !label.empty();
+				}
+
+				void finish() {
+					closeStreamFile(file, filename);
+					closeStreamFile(vertex_labels, vertex_sidecar);
+					closeStreamFile(edge_labels, edge_sidecar);
+					if(!labeled) std::remove(edge_sidecar.c_str());
+				}
+
+			private:
+				std::string filename, vertex_sidecar, edge_sidecar;
+				std::ofstream file, vertex_labels, edge_labels;
+				std::string line;
+				bool labeled;
+		};
+
+		// Adjacency formats list edges grouped by vertex, so edges are
+		// collected by a GraphBuilder, within its memory budget, and the
+		// file is written by finish(). Undirected .bcsr files are written
+		// straight from the sorted runs, the others from a CSR graph.
+		// As with the builder, repeated edges are written once and
+		// vertices are told apart by label.
+		class LigraAdjacencyStreamFormat : public StreamFormat {
+			public:
+				LigraAdjacencyStreamFormat(const std::string &filename, const StreamWriterOptions &options)
+				: filename(filename), directed(options.directed), h(builder.handle()) {
+					builder.setMemoryBudget(options.memory, options.directory);
+				}
+
+				void vertex(size_t, const std::string &label, const std::vector<std::string>&) {
+					labels.push_back(label);
+					h.addVertex(label);
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string>&) {
+					h.addEdge(labels[u], labels[v], label);
+				}
+
+				void finish() {
+					if(!directed && graphFileType(filename) == BinaryCSR) {
+						builder.writeBinaryCSR(filename);
+					}
+					else if(directed) {
+						DirectedCSRGraph<> g;
+						builder.build(g);
+						writeGraph(g, filename);
+					}
+					else {
+						CSRGraph<> g;
+						builder.build(g);
+						writeGraph(g, filename);
+					}
+				}
+
+			private:
+				std::string filename;
+				bool directed;
+				std::vector<std::string> labels;
+				GraphBuilder builder;
+				GraphBuilder::Handle &h;
+		};
+
+		// Vertex and edge tables are written in record batches as they
+		// fill up. Edge endpoints are written as labels, which the reader
+		// looks up in the vertex table, since the label dictionary of
+		// writeArrowEdges() would have to precede the edges.
+		class ArrowStreamFormat : public StreamFormat {
+			public:
+				ArrowStreamFormat(const std::string &filename, const StreamAttributes &va, const StreamAttributes &ea)
+				: filename(filename), vertex_filename(arrowVertexFile(filename)) {
+					openStreamFile(edge_file, filename, std::ios::binary);
+					openStreamFile(vertex_file, vertex_filename, std::ios::binary);
+
+					std::vector<ArrowField> vertex_fields(1, arrowStringField("label", 0));
+					for(size_t a = 0; a < va.count(); ++a) {
+						vertex_fields.push_back(arrowAttributeField(va.names[a], va.types[a]));
+					}
+					std::vector<ArrowField> edge_fields;
+					edge_fields.push_back(arrowStringField("source", 0));
+					edge_fields.push_back(arrowStringField("target", 0));
+					edge_fields.push_back(arrowStringField("label", 0));
+					for(size_t a = 0; a < ea.count(); ++a) {
+						edge_fields.push_back(arrowAttributeField(ea.names[a], ea.types[a]));
+					}
+
+					vertex_writer.reset(new ArrowWriter(vertex_file, vertex_fields));
+					edge_writer.reset(new ArrowWriter(edge_file, edge_fields));
+					vertex_columns.assign(vertex_fields.begin(), vertex_fields.end());
+					edge_columns.assign(edge_fields.begin(), edge_fields.end());
+				}
+
+				void vertex(size_t, const std::string &label, const std::vector<std::string> &attributes) {
+					labels.push_back(label);
+					vertex_columns[0].addString(label.data(), label.size());
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						vertex_columns[a+1].addValue(attributes[a]);
+					}
+					if(full(vertex_columns)) vertex_writer->writeBatch(vertex_columns);
+				}
+
+				void edge(size_t u, size_t v, const std::string &label, const std::vector<std::string> &attributes) {
+					edge_columns[0].addString(labels[u].data(), labels[u].size());
+					edge_columns[1].addString(labels[v].data(), labels[v].size());
+					edge_columns[2].addString(label.data(), label.size());
+					for(size_t a = 0; a < attributes.size(); ++a) {
+						edge_columns[a+3].addValue(attributes[a]);
+					}
+					if(full(edge_columns)) edge_writer->writeBatch(edge_columns);
+				}
+
+				void finish() {
+					if(edge_columns[0].rows > 0) edge_writer->writeBatch(edge_columns);
+					edge_writer->finish();
+					closeStreamFile(edge_file, filename);
+
+					if(vertex_columns[0].rows > 0) vertex_writer->writeBatch(vertex_columns);
+					vertex_writer->finish();
+					closeStreamFile(vertex_file, vertex_filename);
+				}
+
+			private:
+				// Batches end at the row limit, or well before string
+				// columns outgrow their 32 bit offsets
+				static bool full(const std::vector<ArrowColumn> &columns) {
+					if(columns[0].rows == ARROW_BATCH_ROWS) return true;
+					for(size_t c = 0; c < columns.size(); ++c) {
+						if(columns[c].bytes() > INT32_MAX / 2) return true;
+					}
+					return false;
+				}
+
+				std::string filename, vertex_filename;
+				std::ofstream edge_file, vertex_file;
+				std::unique_ptr<ArrowWriter> vertex_writer, edge_writer;
+				std::vector<ArrowColumn> vertex_columns, edge_columns;
+				std::vector<std::string> labels;
+		};
+	}
+
+	// Writes a graph to a file, in the format its name selects, as vertices
+	// and edges are added. Attributes are taken from vertex and edge
+	// properties through the visitors, as by writeGraph(). close() must
+	// be called to finish the file; the destructor finishes it otherwise,
+	// ignoring errors.
+	template<typename VV = VertexVisitor, typename EV = EdgeVisitor>
+	class StreamWriter {
+		public:
+			StreamWriter(const std::string &filename, const VV &vv = VV(), const EV &ev = EV(), const StreamWriterOptions &options = StreamWriterOptions())
+			: vv(vv), ev(ev), n(0), m(0), closed(false) {
+				StreamWriterOptions o = options;
+				if(o.title.empty()) o.title = basename(filename);
+
+				detail::StreamAttributes va(vv), ea(ev);
+				switch(graphFileType(filename)) {
+					case LEDA:
+						format.reset(new detail::LEDAStreamFormat(filename, o));
+						break;
+					case SIF:
+						format.reset(new detail::SIFStreamFormat(filename));
+						break;
+					case XGMML:
+						format.reset(new detail::XGMMLStreamFormat(filename, va, ea, o));
+						break;
+					case Tab:
+						format.reset(new detail::TabStreamFormat(filename, ea));
+						break;
+					case GraphML:
+						format.reset(new detail::GraphMLStreamFormat(filename, va, ea, o));
+						break;
+					case AdjacencyGraph:
+					case BinaryCSR:
+						format.reset(new detail::LigraAdjacencyStreamFormat(filename, o));
+						break;
+					case BinaryEdgeList:
+						format.reset(new detail::BinaryEdgeListStreamFormat(filename));
+						break;
+					case Arrow:
+						format.reset(new detail::ArrowStreamFormat(filename, va, ea));
+						break;
+					case CSV:
+						format.reset(new detail::CSVStreamFormat(filename, ea));
+						break;
+					case CytoscapeJSON:
+						format.reset(new detail::CytoscapeStreamFormat(filename, va, ea, o));
+						break;
+					default:
+						throw GraphIOException("Unknown filetype for file: " + filename);
+				}
+
+				vertex_values.resize(vv.count());
+				edge_values.resize(ev.count());
+			}
+
+			~StreamWriter() {
+				try {
+					close();
+				} catch(...) {
+				}
+			}
+
+			// Adds a vertex and returns its number, counting from 0.
+			// Attributes are written empty.
+			size_t addVertex(const std::string &label) {
+				std::fill(vertex_values.begin(), vertex_values.end(), std::string());
+				return vertex(label);
+			}
+
+			// Adds a vertex whose attributes the visitor reads from properties
+			template<typename VP>
+			size_t addVertex(const std::string &label, const VP &properties) {
+				for(size_t a = 0; a < vv.count(); ++a) {
+					vertex_values[a] = vv.value_str(properties, a);
+				}
+				return vertex(label);
+			}
+
+			// Adds an edge between the vertices numbered u and v
+			void addEdge(size_t u, size_t v, const std::string &label = "") {
+				std::fill(edge_values.begin(), edge_values.end(), std::string());
+				edge(u, v, label);
+			}
+
+			template<typename EP>
+			void addEdge(size_t u, size_t v, const std::string &label, const EP &properties) {
+				for(size_t a = 0; a < ev.count(); ++a) {
+					edge_values[a] = ev.value_str(properties, a);
+				}
+				edge(u, v, label);
+			}
+
+			// Writes what the format holds back and closes the file.
+			// Nothing can be added afterwards.
+			void close() {
+				if(closed) return;
+				closed = true;
+				format->finish();
+			}
+
+			inline size_t vertexCount() const {
+				return n;
+			}
+
+			inline size_t edgeCount() const {
+				return m;
+			}
+
+		private:
+			StreamWriter(const StreamWriter&);
+			StreamWriter &operator=(const StreamWriter&);
+
+			inline size_t vertex(const std::string &label) {
+				check();
+				format->vertex(n, label, vertex_values);
+				return n++;
+			}
+
+			inline void edge(size_t u, size_t v, const std::string &label) {
+				check();
+				if(u >= n || v >= n) {
+					throw GraphIOException("Edge refers to a vertex not added yet");
+				}
+				format->edge(u, v, label, edge_values);
+				m++;
+			}
+
+			inline void check() const {
+				if(closed) throw GraphIOException("Writer is closed");
+			}
+
+			VV vv;
+			EV ev;
+			std::unique_ptr<detail::StreamFormat> format;
+			std::vector<std::string> vertex_values, edge_values;
+			size_t n, m;
+			bool closed;
+	};
+}
+
+#endif
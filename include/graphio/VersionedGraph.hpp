@@ -0,0 +1,104 @@
+#ifndef GRAPHIO_VERSIONEDGRAPH_HPP
+#define GRAPHIO_VERSIONEDGRAPH_HPP
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <graphio/GraphReader.hpp>
+#include <graphio/utility/Executor.hpp>
+
+namespace graphio {
+	// Handle to the current immutable version of a graph.
+	// New versions are published atomically while readers keep using
+	// the version they hold. A version is freed once the last Reader or
+	// snapshot referring to it has moved on.
+	template<class G>
+	class VersionedGraph {
+		public:
+			typedef std::shared_ptr<const G> Snapshot;
+
+			// Per-thread read handle. get() costs a single atomic load
+			// unless a new version has been published since the last call.
+			class Reader {
+				public:
+					Reader(const VersionedGraph &vg) : vg(vg), cached_version(0) {
+						refresh();
+					}
+
+					inline const G &get() {
+						if(vg.current_version.load(std::memory_order_acquire) != cached_version) {
+							refresh();
+						}
+						return *cached;
+					}
+
+					inline size_t version() const {
+						return cached_version;
+					}
+
+					// Drops the reference to the held version
+					inline void release() {
+						cached.reset();
+						cached_version = 0;
+					}
+
+				private:
+					void refresh() {
+						std::lock_guard<std::mutex> lock(vg.mutex);
+						cached = vg.current;
+						cached_version = vg.current_version.load(std::memory_order_relaxed);
+					}
+
+					const VersionedGraph &vg;
+					Snapshot cached;
+					size_t cached_version;
+			};
+
+			VersionedGraph() : current(std::make_shared<G>()), current_version(1) { }
+
+			VersionedGraph(Snapshot g) : current(g), current_version(1) { }
+
+			Snapshot snapshot() const {
+				std::lock_guard<std::mutex> lock(mutex);
+				return current;
+			}
+
+			size_t version() const {
+				return current_version.load(std::memory_order_acquire);
+			}
+
+			void publish(Snapshot g) {
+				Snapshot old;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					old.swap(current);
+					current = g;
+					current_version.fetch_add(1, std::memory_order_release);
+				}
+				// old is released outside the lock if no reader holds it
+			}
+
+			// Reads filename into a new version on executor
+			// and publishes it when done.
+			template<typename Policy = StrictPolicy>
+			std::future<void> reload(const std::string &filename, Executor &executor = defaultExecutor()) {
+				return runAsync(executor, [this, filename]() {
+					std::shared_ptr<G> g = std::make_shared<G>();
+					readGraph<Policy>(filename, *g);
+					publish(g);
+				});
+			}
+
+		private:
+			VersionedGraph(const VersionedGraph&);
+			VersionedGraph &operator=(const VersionedGraph&);
+
+			mutable std::mutex mutex;
+			Snapshot current;
+			std::atomic<size_t> current_version;
+	};
+}
+
+#endif
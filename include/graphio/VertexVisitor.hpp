@@ -32,6 +32,10 @@ namespace graphio {
 			inline std::string value_str(const V &v, size_t i) const {
 				return "";
 			}
+
+			template<typename V>
+			inline void from_str(V &v, size_t i, const std::string &value) const {
+			}
 	};
 }
 
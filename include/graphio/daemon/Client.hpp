@@ -0,0 +1,217 @@
+#ifndef GRAPHIO_DAEMON_CLIENT_HPP
+#define GRAPHIO_DAEMON_CLIENT_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/daemon/Protocol.hpp>
+
+namespace graphio {
+	namespace daemon {
+		// Blocking client for graphiod.
+		// The vector overloads pipeline all requests in a single write.
+		class Client {
+			public:
+				Client(const std::string &path) : next_id(0) {
+					sockaddr_un addr;
+					if(path.length() >= sizeof(addr.sun_path)) {
+						throw GraphIOException("Socket path too long: " + path);
+					}
+
+					fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+					if(fd < 0) {
+						throw GraphIOException(std::string("Could not create socket: ") + std::strerror(errno));
+					}
+
+					std::memset(&addr, 0, sizeof(addr));
+					addr.sun_family = AF_UNIX;
+					std::strcpy(addr.sun_path, path.c_str());
+					if(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+						close(fd);
+						throw GraphIOException("Could not connect to: " + path);
+					}
+				}
+
+				~Client() {
+					close(fd);
+				}
+
+				inline uint32_t numVertices(uint16_t graph) {
+					request(OP_INFO, graph, "");
+					return readU32(&response[0]);
+				}
+
+				inline uint32_t numEdges(uint16_t graph) {
+					request(OP_INFO, graph, "");
+					return readU32(&response[4]);
+				}
+
+				inline uint32_t degree(uint16_t graph, uint32_t v) {
+					return degree(graph, std::vector<uint32_t>(1, v))[0];
+				}
+
+				std::vector<uint32_t> degree(uint16_t graph, const std::vector<uint32_t> &vs) {
+					std::vector<uint32_t> out(vs.size());
+					uint16_t error = STATUS_OK;
+					send(OP_DEGREE, graph, vs);
+					for(size_t i = 0; i < vs.size(); ++i) {
+						uint16_t status = receive();
+						if(status == STATUS_OK) out[i] = readU32(&response[0]);
+						else error = status;
+					}
+					check(error);
+					return out;
+				}
+
+				std::vector<uint32_t> neighbors(uint16_t graph, uint32_t v) {
+					return neighbors(graph, std::vector<uint32_t>(1, v))[0];
+				}
+
+				std::vector<std::vector<uint32_t> > neighbors(uint16_t graph, const std::vector<uint32_t> &vs) {
+					std::vector<std::vector<uint32_t> > out(vs.size());
+					uint16_t error = STATUS_OK;
+					send(OP_NEIGHBORS, graph, vs);
+					for(size_t i = 0; i < vs.size(); ++i) {
+						uint16_t status = receive();
+						if(status != STATUS_OK) {
+							error = status;
+							continue;
+						}
+						uint32_t count = readU32(&response[0]);
+						out[i].resize(count);
+						if(count > 0) {
+							std::memcpy(&out[i][0], &response[4], count * sizeof(uint32_t));
+						}
+					}
+					check(error);
+					return out;
+				}
+
+				std::string label(uint16_t graph, uint32_t v) {
+					std::string payload;
+					appendU32(payload, v);
+					request(OP_LABEL, graph, payload);
+					return response;
+				}
+
+				// Returns NO_VERTEX if no vertex has the given label
+				inline uint32_t lookup(uint16_t graph, const std::string &label) {
+					return lookup(graph, std::vector<std::string>(1, label))[0];
+				}
+
+				std::vector<uint32_t> lookup(uint16_t graph, const std::vector<std::string> &labels) {
+					std::string buf;
+					for(size_t i = 0; i < labels.size(); ++i) {
+						appendHeader(buf, labels[i].length(), next_id++, OP_LOOKUP, graph);
+						buf.append(labels[i]);
+					}
+					write(buf);
+
+					std::vector<uint32_t> out(labels.size());
+					uint16_t error = STATUS_OK;
+					for(size_t i = 0; i < labels.size(); ++i) {
+						uint16_t status = receive();
+						if(status == STATUS_OK) out[i] = readU32(&response[0]);
+						else if(status == STATUS_NOT_FOUND) out[i] = NO_VERTEX;
+						else error = status;
+					}
+					check(error);
+					return out;
+				}
+
+				// Returns the edges induced by the given vertices
+				std::vector<std::pair<uint32_t, uint32_t> > subgraph(uint16_t graph, const std::vector<uint32_t> &vs) {
+					std::string payload;
+					appendU32(payload, vs.size());
+					for(size_t i = 0; i < vs.size(); ++i) {
+						appendU32(payload, vs[i]);
+					}
+					request(OP_SUBGRAPH, graph, payload);
+
+					uint32_t count = readU32(&response[0]);
+					std::vector<std::pair<uint32_t, uint32_t> > edges(count);
+					for(size_t i = 0; i < count; ++i) {
+						edges[i].first = readU32(&response[4 + 8*i]);
+						edges[i].second = readU32(&response[8 + 8*i]);
+					}
+					return edges;
+				}
+
+			private:
+				Client(const Client&);
+				Client &operator=(const Client&);
+
+				void request(uint16_t op, uint16_t graph, const std::string &payload) {
+					std::string buf;
+					appendHeader(buf, payload.length(), next_id++, op, graph);
+					buf.append(payload);
+					write(buf);
+					check(receive());
+				}
+
+				// Sends one request per vertex
+				void send(uint16_t op, uint16_t graph, const std::vector<uint32_t> &vs) {
+					std::string buf;
+					buf.reserve(vs.size() * (sizeof(Header) + 4));
+					for(size_t i = 0; i < vs.size(); ++i) {
+						appendHeader(buf, 4, next_id++, op, graph);
+						appendU32(buf, vs[i]);
+					}
+					write(buf);
+				}
+
+				void write(const std::string &buf) {
+					size_t done = 0;
+					while(done < buf.length()) {
+						ssize_t n = ::send(fd, buf.data() + done, buf.length() - done, MSG_NOSIGNAL);
+						if(n < 0) {
+							if(errno == EINTR) continue;
+							throw GraphIOException(std::string("Could not send request: ") + std::strerror(errno));
+						}
+						done += n;
+					}
+				}
+
+				void read(char *data, size_t length) {
+					size_t done = 0;
+					while(done < length) {
+						ssize_t n = ::recv(fd, data + done, length - done, 0);
+						if(n < 0 && errno == EINTR) continue;
+						if(n <= 0) {
+							throw GraphIOException("Connection to graphiod lost");
+						}
+						done += n;
+					}
+				}
+
+				// Reads the next response payload into response and returns its status
+				uint16_t receive() {
+					Header h;
+					read(reinterpret_cast<char*>(&h), sizeof(h));
+					response.resize(h.length);
+					if(h.length > 0) {
+						read(&response[0], h.length);
+					}
+					return h.code;
+				}
+
+				inline void check(uint16_t status) {
+					if(status != STATUS_OK) {
+						throw GraphIOException(std::string("graphiod: ") + statusString(status));
+					}
+				}
+
+				int fd;
+				uint32_t next_id;
+				std::string response;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef GRAPHIO_DAEMON_PROTOCOL_HPP
+#define GRAPHIO_DAEMON_PROTOCOL_HPP
+
+#include <string>
+#include <cstring>
+#include <cstdint>
+
+// Every message is a Header followed by header.length payload bytes.
+// All integers are in host byte order since both ends share a host.
+namespace graphio {
+	namespace daemon {
+		enum Op {
+			OP_INFO = 1,     // -> u32 vertices, u32 edges
+			OP_DEGREE,       // u32 vertex -> u32 degree
+			OP_NEIGHBORS,    // u32 vertex -> u32 count, count * u32 vertex
+			OP_LABEL,        // u32 vertex -> label bytes
+			OP_LOOKUP,       // label bytes -> u32 vertex
+			OP_SUBGRAPH      // u32 count, count * u32 vertex -> u32 count, count * (u32, u32)
+		};
+
+		enum Status {
+			STATUS_OK = 0,
+			STATUS_BAD_REQUEST,
+			STATUS_NO_GRAPH,
+			STATUS_NO_VERTEX,
+			STATUS_NOT_FOUND
+		};
+
+		struct Header {
+			uint32_t length;
+			uint32_t id;
+			// Op in requests, Status in responses
+			uint16_t code;
+			uint16_t graph;
+		};
+
+		const uint32_t NO_VERTEX = 0xFFFFFFFF;
+		const uint32_t MAX_MESSAGE_LENGTH = 1 << 28;
+
+		inline void appendHeader(std::string &buf, uint32_t length, uint32_t id, uint16_t code, uint16_t graph) {
+			Header h;
+			h.length = length;
+			h.id = id;
+			h.code = code;
+			h.graph = graph;
+			buf.append(reinterpret_cast<const char*>(&h), sizeof(h));
+		}
+
+		inline void appendU32(std::string &buf, uint32_t value) {
+			buf.append(reinterpret_cast<const char*>(&value), sizeof(value));
+		}
+
+		inline uint32_t readU32(const char *data) {
+			uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		inline const char *statusString(uint16_t status) {
+			switch(status) {
+				case STATUS_OK: return "ok";
+				case STATUS_BAD_REQUEST: return "bad request";
+				case STATUS_NO_GRAPH: return "no such graph";
+				case STATUS_NO_VERTEX: return "no such vertex";
+				case STATUS_NOT_FOUND: return "label not found";
+				default: return "unknown status";
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,1018 @@
+#ifndef GRAPHIO_FORMATS_ARROW_HPP
+#define GRAPHIO_FORMATS_ARROW_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <ostream>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <graphio/utility/basename.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/flatbuffers.hpp>
+#include <graphio/utility/hash.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/VertexVisitor.hpp>
+#include <graphio/EdgeVisitor.hpp>
+
+// Apache Arrow IPC files (Feather v2), written and read without the
+// Arrow libraries. A graph is stored as two tables: FILE.arrow holds the
+// edges, with source and target dictionary-encoded over the vertex labels
+// and the edge label dictionary-encoded over the distinct labels, and
+// FILE.vertices.arrow holds the vertex labels. Visitor attributes become
+// columns of either table. Message bodies start at 64 byte aligned file
+// offsets and their buffers are padded to 64 bytes, so consumers can map
+// the files and use the columns in place. Compressed record batches are
+// not supported.
+namespace graphio {
+	inline std::string arrowVertexFile(const std::string &filename) {
+		if(boost::algorithm::iends_with(filename, ".arrow")) {
+			return filename.substr(0, filename.size() - 6) + ".vertices.arrow";
+		}
+		return filename + ".vertices.arrow";
+	}
+
+	namespace detail {
+		// Members of the Type union in Arrow's Schema.fbs
+		enum ArrowTypeId {
+			ARROW_INT = 2,
+			ARROW_FLOAT = 3,
+			ARROW_BINARY = 4,
+			ARROW_UTF8 = 5,
+			ARROW_BOOL = 6,
+			ARROW_LARGE_BINARY = 19,
+			ARROW_LARGE_UTF8 = 20
+		};
+
+		// Members of the MessageHeader union in Message.fbs
+		enum ArrowMessageType {
+			ARROW_SCHEMA = 1,
+			ARROW_DICTIONARY_BATCH = 2,
+			ARROW_RECORD_BATCH = 3
+		};
+
+		const int16_t ARROW_METADATA_V5 = 4;
+		const size_t ARROW_ALIGNMENT = 64;
+		const size_t ARROW_BATCH_ROWS = 1 << 20;
+
+		struct ArrowField {
+			std::string name;
+			// Value type; for dictionary-encoded fields the type of the dictionary
+			int type;
+			int bit_width;
+			bool is_signed;
+			// Float precision, 1 for single and 2 for double
+			int16_t precision;
+			// Dictionary id or -1, and the type of the indices
+			int64_t dictionary;
+			int index_width;
+			bool index_signed;
+
+			ArrowField(const std::string &name = "", int type = ARROW_UTF8)
+			: name(name), type(type), bit_width(0), is_signed(true), precision(2),
+			dictionary(-1), index_width(32), index_signed(true) { }
+
+			inline bool large() const {
+				return type == ARROW_LARGE_UTF8 || type == ARROW_LARGE_BINARY;
+			}
+
+			inline bool binary() const {
+				return type == ARROW_UTF8 || type == ARROW_BINARY || large();
+			}
+		};
+
+		// Column for a visitor attribute of the given type
+		inline ArrowField arrowAttributeField(const std::string &name, const std::string &type) {
+			ArrowField field(name);
+			if(type == "integer" || type == "int" || type == "long") {
+				field.type = ARROW_INT;
+				field.bit_width = 64;
+			}
+			else if(type == "real" || type == "double" || type == "float") {
+				field.type = ARROW_FLOAT;
+			}
+			else if(type == "boolean" || type == "bool") {
+				field.type = ARROW_BOOL;
+			}
+			return field;
+		}
+
+		inline ArrowField arrowStringField(const std::string &name, size_t bytes, int64_t dictionary = -1) {
+			ArrowField field(name, bytes > INT32_MAX ? ARROW_LARGE_UTF8 : ARROW_UTF8);
+			field.dictionary = dictionary;
+			return field;
+		}
+
+		inline size_t arrowPadded(size_t length) {
+			return (length + ARROW_ALIGNMENT - 1) / ARROW_ALIGNMENT * ARROW_ALIGNMENT;
+		}
+
+		// Values of one column of the record batch being written
+		class ArrowColumn {
+			public:
+				ArrowColumn(const ArrowField &field) : field(field) {
+					clear();
+				}
+
+				inline void clear() {
+					rows = 0;
+					values.clear();
+					offsets32.assign(1, 0);
+					offsets64.assign(1, 0);
+				}
+
+				inline void addIndex(uint32_t index) {
+					append(&index, sizeof(index));
+				}
+
+				inline void addString(const char *s, size_t length) {
+					values.insert(values.end(), s, s + length);
+					if(field.large()) offsets64.push_back(values.size());
+					else offsets32.push_back(values.size());
+					rows++;
+				}
+
+				// Adds a visitor value given as a string
+				void addValue(const std::string &s) {
+					if(field.type == ARROW_INT) {
+						int64_t x = std::strtoll(s.c_str(), NULL, 10);
+						append(&x, sizeof(x));
+					}
+					else if(field.type == ARROW_FLOAT) {
+						double x = std::strtod(s.c_str(), NULL);
+						append(&x, sizeof(x));
+					}
+					else if(field.type == ARROW_BOOL) {
+						if(rows % 8 == 0) values.push_back(0);
+						if(s == "true" || s == "TRUE" || s == "True" || s == "1") {
+							values.back() |= 1 << (rows % 8);
+						}
+						rows++;
+					}
+					else {
+						addString(s.data(), s.size());
+					}
+				}
+
+				// Appends the buffers of the column: validity, offsets and values
+				void buffers(std::vector<std::pair<const void*, size_t> > &out) const {
+					out.push_back(std::make_pair((const void*)NULL, size_t(0)));
+					if(field.dictionary < 0 && field.binary()) {
+						if(field.large()) out.push_back(std::make_pair((const void*)offsets64.data(), offsets64.size() * 8));
+						else out.push_back(std::make_pair((const void*)offsets32.data(), offsets32.size() * 4));
+					}
+					out.push_back(std::make_pair((const void*)values.data(), values.size()));
+				}
+
+				// Bytes of values held
+				inline size_t bytes() const {
+					return values.size();
+				}
+
+				ArrowField field;
+				size_t rows;
+
+			private:
+				inline void append(const void *p, size_t length) {
+					const uint8_t *bytes = static_cast<const uint8_t*>(p);
+					values.insert(values.end(), bytes, bytes + length);
+					rows++;
+				}
+
+				std::vector<uint8_t> values;
+				std::vector<int32_t> offsets32;
+				std::vector<int64_t> offsets64;
+		};
+
+		struct ArrowBlock {
+			int64_t offset;
+			int32_t metadata;
+			int32_t padding;
+			int64_t body;
+		};
+
+		// Writes an Arrow IPC file: the schema, dictionaries and record
+		// batches as they are given, then the footer indexing them.
+		class ArrowWriter {
+			public:
+				ArrowWriter(std::ostream &out, const std::vector<ArrowField> &fields) : out(out), fields(fields), pos(0) {
+					write("ARROW1\0\0", 8);
+
+					fb::Builder b;
+					writeMessage(b, ARROW_SCHEMA, buildSchema(b), 0);
+				}
+
+				// Writes dictionary id holding the strings get(i) for i in [0, count)
+				template<typename F>
+				void writeDictionary(int64_t id, size_t count, bool large, F get) {
+					std::vector<int64_t> offsets(count + 1, 0);
+					for(size_t i = 0; i < count; ++i) {
+						offsets[i+1] = offsets[i] + get(i).size();
+					}
+
+					std::vector<size_t> lengths;
+					lengths.push_back(0);
+					lengths.push_back((count + 1) * (large ? 8 : 4));
+					lengths.push_back(offsets[count]);
+
+					fb::Builder b;
+					int64_t body;
+					fb::Builder::Ref data = buildRecordBatch(b, count, 1, lengths, body);
+					b.startTable();
+					b.addScalar<int64_t>(0, id);
+					b.addOffset(1, data);
+					fb::Builder::Ref header = b.endTable();
+					dictionaries.push_back(writeMessage(b, ARROW_DICTIONARY_BATCH, header, body));
+
+					// Body: offsets, then the string data straight from get()
+					if(large) {
+						write(offsets.data(), lengths[1]);
+					} else {
+						std::vector<int32_t> narrow(offsets.begin(), offsets.end());
+						write(narrow.data(), lengths[1]);
+					}
+					pad(lengths[1]);
+					for(size_t i = 0; i < count; ++i) {
+						const std::string &s = get(i);
+						write(s.data(), s.size());
+					}
+					pad(lengths[2]);
+				}
+
+				// Writes the columns as a record batch and clears them
+				void writeBatch(std::vector<ArrowColumn> &columns) {
+					std::vector<std::pair<const void*, size_t> > buffers;
+					for(size_t c = 0; c < columns.size(); ++c) {
+						columns[c].buffers(buffers);
+					}
+					std::vector<size_t> lengths;
+					for(size_t i = 0; i < buffers.size(); ++i) {
+						lengths.push_back(buffers[i].second);
+					}
+
+					fb::Builder b;
+					int64_t body;
+					size_t rows = columns.empty() ? 0 : columns[0].rows;
+					fb::Builder::Ref header = buildRecordBatch(b, rows, columns.size(), lengths, body);
+					batches.push_back(writeMessage(b, ARROW_RECORD_BATCH, header, body));
+
+					for(size_t i = 0; i < buffers.size(); ++i) {
+						write(buffers[i].first, buffers[i].second);
+						pad(buffers[i].second);
+					}
+					for(size_t c = 0; c < columns.size(); ++c) {
+						columns[c].clear();
+					}
+				}
+
+				// Writes the end of stream marker and the footer
+				void finish() {
+					uint32_t eos[2] = { 0xFFFFFFFF, 0 };
+					write(eos, sizeof(eos));
+
+					fb::Builder b;
+					fb::Builder::Ref schema = buildSchema(b);
+					fb::Builder::Ref dicts = b.createStructVector(dictionaries.data(), dictionaries.size(), sizeof(ArrowBlock), 8);
+					fb::Builder::Ref records = b.createStructVector(batches.data(), batches.size(), sizeof(ArrowBlock), 8);
+					b.startTable();
+					b.addOffset(1, schema);
+					b.addOffset(2, dicts);
+					b.addOffset(3, records);
+					b.addScalar<int16_t>(0, ARROW_METADATA_V5);
+					const std::vector<uint8_t> &footer = b.finish(b.endTable());
+
+					int32_t length = footer.size();
+					write(footer.data(), footer.size());
+					write(&length, sizeof(length));
+					write("ARROW1", 6);
+				}
+
+			private:
+				inline void write(const void *p, size_t length) {
+					out.write(static_cast<const char*>(p), length);
+					pos += length;
+				}
+
+				inline void pad(size_t length) {
+					static const char zeros[ARROW_ALIGNMENT] = { 0 };
+					write(zeros, arrowPadded(length) - length);
+				}
+
+				static fb::Builder::Ref buildType(fb::Builder &b, int type, int bit_width, bool is_signed, int16_t precision) {
+					b.startTable();
+					if(type == ARROW_INT) {
+						b.addScalar<int32_t>(0, bit_width);
+						b.addScalar<uint8_t>(1, is_signed);
+					}
+					else if(type == ARROW_FLOAT) {
+						b.addScalar<int16_t>(0, precision);
+					}
+					return b.endTable();
+				}
+
+				fb::Builder::Ref buildSchema(fb::Builder &b) const {
+					std::vector<fb::Builder::Ref> refs;
+					for(size_t i = 0; i < fields.size(); ++i) {
+						const ArrowField &f = fields[i];
+						fb::Builder::Ref name = b.createString(f.name);
+						fb::Builder::Ref type = buildType(b, f.type, f.bit_width, f.is_signed, f.precision);
+						fb::Builder::Ref dictionary = 0;
+						if(f.dictionary >= 0) {
+							fb::Builder::Ref index = buildType(b, ARROW_INT, f.index_width, f.index_signed, 0);
+							b.startTable();
+							b.addScalar<int64_t>(0, f.dictionary);
+							b.addOffset(1, index);
+							dictionary = b.endTable();
+						}
+						fb::Builder::Ref children = b.createOffsetVector(std::vector<fb::Builder::Ref>());
+
+						b.startTable();
+						b.addOffset(0, name);
+						b.addOffset(3, type);
+						if(f.dictionary >= 0) b.addOffset(4, dictionary);
+						b.addOffset(5, children);
+						b.addScalar<uint8_t>(1, 0);
+						b.addScalar<uint8_t>(2, f.type);
+						refs.push_back(b.endTable());
+					}
+					fb::Builder::Ref list = b.createOffsetVector(refs);
+
+					b.startTable();
+					b.addOffset(1, list);
+					b.addScalar<int16_t>(0, 0);
+					return b.endTable();
+				}
+
+				// Lays out buffers of the given lengths and returns the
+				// RecordBatch table and the body length
+				static fb::Builder::Ref buildRecordBatch(fb::Builder &b, int64_t rows, size_t columns, const std::vector<size_t> &lengths, int64_t &body) {
+					std::vector<int64_t> buffers;
+					body = 0;
+					for(size_t i = 0; i < lengths.size(); ++i) {
+						buffers.push_back(body);
+						buffers.push_back(lengths[i]);
+						body += arrowPadded(lengths[i]);
+					}
+					std::vector<int64_t> nodes;
+					for(size_t c = 0; c < columns; ++c) {
+						nodes.push_back(rows);
+						nodes.push_back(0);
+					}
+
+					fb::Builder::Ref node_list = b.createStructVector(nodes.data(), columns, 16, 8);
+					fb::Builder::Ref buffer_list = b.createStructVector(buffers.data(), lengths.size(), 16, 8);
+					b.startTable();
+					b.addScalar<int64_t>(0, rows);
+					b.addOffset(1, node_list);
+					b.addOffset(2, buffer_list);
+					return b.endTable();
+				}
+
+				ArrowBlock writeMessage(fb::Builder &b, uint8_t type, fb::Builder::Ref header, int64_t body) {
+					b.startTable();
+					b.addScalar<int64_t>(3, body);
+					b.addOffset(2, header);
+					b.addScalar<int16_t>(0, ARROW_METADATA_V5);
+					b.addScalar<uint8_t>(1, type);
+					const std::vector<uint8_t> &metadata = b.finish(b.endTable());
+
+					// Pad the metadata so that the body starts on an aligned offset.
+					// Bodies are padded too, so every message stays aligned.
+					size_t padding = (ARROW_ALIGNMENT - (pos + 8 + metadata.size()) % ARROW_ALIGNMENT) % ARROW_ALIGNMENT;
+
+					ArrowBlock block;
+					block.offset = pos;
+					block.metadata = 8 + metadata.size() + padding;
+					block.padding = 0;
+					block.body = body;
+
+					static const char zeros[ARROW_ALIGNMENT] = { 0 };
+					uint32_t prefix[2] = { 0xFFFFFFFF, uint32_t(metadata.size() + padding) };
+					write(prefix, sizeof(prefix));
+					write(metadata.data(), metadata.size());
+					write(zeros, padding);
+					return block;
+				}
+
+				std::ostream &out;
+				std::vector<ArrowField> fields;
+				size_t pos;
+				std::vector<ArrowBlock> dictionaries, batches;
+		};
+
+		// Column of a record batch in a mapped file
+		struct ArrowColumnView {
+			const ArrowField *field;
+			const std::vector<boost::string_ref> *dictionary;
+			size_t length, null_count;
+			const uint8_t *validity, *offsets, *values;
+			size_t values_size;
+
+			inline bool valid(size_t i) const {
+				return null_count == 0 || validity == NULL || ((validity[i >> 3] >> (i & 7)) & 1);
+			}
+
+			// Integer value or dictionary index
+			inline int64_t integer(size_t i) const {
+				int width = field->dictionary >= 0 ? field->index_width : field->bit_width;
+				bool is_signed = field->dictionary >= 0 ? field->index_signed : field->is_signed;
+				switch(width) {
+					case 8: return is_signed ? int64_t(fb::Table::read<int8_t>(values + i)) : int64_t(values[i]);
+					case 16: return is_signed ? int64_t(fb::Table::read<int16_t>(values + 2*i)) : int64_t(fb::Table::read<uint16_t>(values + 2*i));
+					case 32: return is_signed ? int64_t(fb::Table::read<int32_t>(values + 4*i)) : int64_t(fb::Table::read<uint32_t>(values + 4*i));
+					default: return fb::Table::read<int64_t>(values + 8*i);
+				}
+			}
+
+			// Value of a string column, or of a dictionary-encoded one
+			inline boost::string_ref string(size_t i) const {
+				if(field->dictionary >= 0) {
+					int64_t index = integer(i);
+					if(index < 0 || size_t(index) >= dictionary->size()) {
+						throw GraphIOException("Arrow: Dictionary index out of range");
+					}
+					return (*dictionary)[index];
+				}
+
+				int64_t begin, end;
+				if(field->large()) {
+					begin = fb::Table::read<int64_t>(offsets + 8*i);
+					end = fb::Table::read<int64_t>(offsets + 8*(i+1));
+				} else {
+					begin = fb::Table::read<int32_t>(offsets + 4*i);
+					end = fb::Table::read<int32_t>(offsets + 4*(i+1));
+				}
+				if(begin < 0 || end < begin || size_t(end) > values_size) {
+					throw GraphIOException("Arrow: String offsets out of range");
+				}
+				return boost::string_ref(reinterpret_cast<const char*>(values) + begin, end - begin);
+			}
+
+			// Any supported value as text, as passed to the visitors
+			std::string str(size_t i) const {
+				if(field->dictionary >= 0 || field->binary()) {
+					return string(i).to_string();
+				}
+				if(field->type == ARROW_INT) {
+					return std::to_string(integer(i));
+				}
+				if(field->type == ARROW_BOOL) {
+					return ((values[i >> 3] >> (i & 7)) & 1) ? "true" : "false";
+				}
+
+				char buf[32];
+				double x = field->precision == 1 ? fb::Table::read<float>(values + 4*i) : fb::Table::read<double>(values + 8*i);
+				std::snprintf(buf, sizeof(buf), "%.17g", x);
+				return buf;
+			}
+		};
+
+		// Read-only view of a mapped Arrow IPC file
+		class ArrowFile {
+			public:
+				ArrowFile(const std::string &filename) : filename(filename), file(filename) {
+					const uint8_t *p = reinterpret_cast<const uint8_t*>(file.data());
+					size_t size = file.size();
+					if(size < 18 || std::memcmp(p, "ARROW1", 6) != 0 || std::memcmp(p + size - 6, "ARROW1", 6) != 0) {
+						throw GraphIOException("Not an Arrow file: " + filename);
+					}
+
+					int32_t length = fb::Table::read<int32_t>(p + size - 10);
+					if(length <= 0 || size_t(length) > size - 18) {
+						throw GraphIOException("Arrow: Invalid footer in " + filename);
+					}
+					fb::Table footer = fb::Table::root(p + size - 10 - length, length);
+
+					fb::Table schema = footer.child(1);
+					if(!schema.valid() || schema.scalar<int16_t>(0) != 0) {
+						throw GraphIOException("Arrow: Missing or big endian schema in " + filename);
+					}
+					for(size_t i = 0; i < schema.vectorSize(1, 4); ++i) {
+						fields.push_back(readField(schema.tableAt(1, i)));
+					}
+
+					for(size_t i = 0; i < footer.vectorSize(2, sizeof(ArrowBlock)); ++i) {
+						readDictionary(block(footer.structAt(2, sizeof(ArrowBlock), i)));
+					}
+					for(size_t i = 0; i < footer.vectorSize(3, sizeof(ArrowBlock)); ++i) {
+						batches.push_back(block(footer.structAt(3, sizeof(ArrowBlock), i)));
+					}
+				}
+
+				// Index of the field called name, or -1
+				inline int column(const std::string &name) const {
+					for(size_t i = 0; i < fields.size(); ++i) {
+						if(fields[i].name == name) return i;
+					}
+					return -1;
+				}
+
+				inline size_t batchCount() const {
+					return batches.size();
+				}
+
+				// Column views of record batch b, returning its row count
+				size_t batch(size_t b, std::vector<ArrowColumnView> &columns) const {
+					fb::Table header;
+					const uint8_t *body;
+					size_t body_size;
+					message(batches[b], ARROW_RECORD_BATCH, header, body, body_size);
+					return readColumns(header, body, body_size, fields, columns);
+				}
+
+			private:
+				ArrowFile(const ArrowFile&);
+				ArrowFile &operator=(const ArrowFile&);
+
+				static ArrowBlock block(const uint8_t *p) {
+					ArrowBlock block;
+					std::memcpy(&block, p, sizeof(block));
+					return block;
+				}
+
+				ArrowField readField(const fb::Table &t) const {
+					if(t.vectorSize(5, 4) > 0) {
+						throw GraphIOException("Arrow: Nested column types are not supported in " + filename);
+					}
+
+					ArrowField field(t.string(0), t.scalar<uint8_t>(2));
+					fb::Table type = t.child(3);
+					if(field.type == ARROW_INT) {
+						field.bit_width = type.scalar<int32_t>(0);
+						field.is_signed = type.scalar<uint8_t>(1);
+					}
+					else if(field.type == ARROW_FLOAT) {
+						field.precision = type.scalar<int16_t>(0);
+						if(field.precision == 0) throw GraphIOException("Arrow: Half precision floats are not supported");
+					}
+					else if(!field.binary() && field.type != ARROW_BOOL) {
+						throw GraphIOException("Arrow: Unsupported type of column " + field.name + " in " + filename);
+					}
+					if(field.type == ARROW_INT && field.bit_width != 8 && field.bit_width != 16 && field.bit_width != 32 && field.bit_width != 64) {
+						throw GraphIOException("Arrow: Invalid integer width in " + filename);
+					}
+
+					fb::Table dictionary = t.child(4);
+					if(dictionary.valid()) {
+						if(!field.binary()) {
+							throw GraphIOException("Arrow: Only string dictionaries are supported in " + filename);
+						}
+						field.dictionary = dictionary.scalar<int64_t>(0);
+						fb::Table index = dictionary.child(1);
+						field.index_width = index.valid() ? index.scalar<int32_t>(0) : 32;
+						field.index_signed = index.valid() ? index.scalar<uint8_t>(1) : true;
+						if(field.index_width != 8 && field.index_width != 16 && field.index_width != 32 && field.index_width != 64) {
+							throw GraphIOException("Arrow: Invalid dictionary index width in " + filename);
+						}
+					}
+					return field;
+				}
+
+				// Finds the message of block and its body
+				void message(const ArrowBlock &block, uint8_t type, fb::Table &header, const uint8_t *&body, size_t &body_size) const {
+					const uint8_t *p = reinterpret_cast<const uint8_t*>(file.data());
+					size_t size = file.size();
+					if(block.offset < 0 || block.metadata < 8 || block.body < 0
+					|| size_t(block.offset) + block.metadata + block.body > size) {
+						throw GraphIOException("Arrow: Block out of range in " + filename);
+					}
+
+					// Messages start with a continuation marker since format 0.15
+					const uint8_t *m = p + block.offset;
+					size_t skip = fb::Table::read<uint32_t>(m) == 0xFFFFFFFF ? 8 : 4;
+					fb::Table msg = fb::Table::root(m + skip, block.metadata - skip);
+					if(msg.scalar<uint8_t>(1) != type) {
+						throw GraphIOException("Arrow: Unexpected message type in " + filename);
+					}
+					header = msg.child(2);
+					if(!header.valid()) {
+						throw GraphIOException("Arrow: Message without header in " + filename);
+					}
+					body = m + block.metadata;
+					body_size = block.body;
+				}
+
+				void readDictionary(const ArrowBlock &block) {
+					fb::Table header;
+					const uint8_t *body;
+					size_t body_size;
+					message(block, ARROW_DICTIONARY_BATCH, header, body, body_size);
+
+					int64_t id = header.scalar<int64_t>(0);
+					const ArrowField *value = NULL;
+					for(size_t i = 0; i < fields.size(); ++i) {
+						if(fields[i].dictionary == id) value = &fields[i];
+					}
+					if(value == NULL) {
+						throw GraphIOException("Arrow: Dictionary without column in " + filename);
+					}
+
+					// The dictionary is a one column batch of the value type
+					ArrowField plain = *value;
+					plain.dictionary = -1;
+					std::vector<ArrowField> one(1, plain);
+					std::vector<ArrowColumnView> columns;
+					size_t rows = readColumns(header.child(1), body, body_size, one, columns);
+
+					std::vector<boost::string_ref> &values = dictionaries[id];
+					if(!header.scalar<uint8_t>(2)) values.clear();
+					for(size_t i = 0; i < rows; ++i) {
+						values.push_back(columns[0].string(i));
+					}
+				}
+
+				size_t readColumns(const fb::Table &batch, const uint8_t *body, size_t body_size, const std::vector<ArrowField> &fields, std::vector<ArrowColumnView> &columns) const {
+					if(!batch.valid()) {
+						throw GraphIOException("Arrow: Missing record batch in " + filename);
+					}
+					// BodyCompression, written by LZ4 or ZSTD compressing writers
+					if(batch.has(3)) {
+						throw GraphIOException("Arrow: Compressed Arrow IPC is not supported (" + filename + " has compressed record batches)");
+					}
+
+					size_t rows = batch.scalar<int64_t>(0);
+					size_t buffer = 0;
+					columns.resize(fields.size());
+					for(size_t c = 0; c < fields.size(); ++c) {
+						const ArrowField &field = fields[c];
+						ArrowColumnView &col = columns[c];
+						const uint8_t *node = batch.structAt(1, 16, c);
+						col.field = &field;
+						col.dictionary = NULL;
+						col.length = fb::Table::read<int64_t>(node);
+						col.null_count = fb::Table::read<int64_t>(node + 8);
+						if(col.length != rows) {
+							throw GraphIOException("Arrow: Column length mismatch in " + filename);
+						}
+
+						size_t size;
+						col.validity = this->buffer(batch, body, body_size, buffer++, size);
+						if(col.null_count > 0 && size * 8 < rows) {
+							throw GraphIOException("Arrow: Validity buffer too short in " + filename);
+						}
+
+						col.offsets = NULL;
+						if(field.dictionary < 0 && field.binary()) {
+							col.offsets = this->buffer(batch, body, body_size, buffer++, size);
+							if(rows > 0 && size < (rows + 1) * (field.large() ? 8 : 4)) {
+								throw GraphIOException("Arrow: Offsets buffer too short in " + filename);
+							}
+						}
+
+						col.values = this->buffer(batch, body, body_size, buffer++, col.values_size);
+						size_t width = field.dictionary >= 0 ? field.index_width / 8
+							: field.type == ARROW_INT ? field.bit_width / 8
+							: field.type == ARROW_FLOAT ? (field.precision == 1 ? 4 : 8)
+							: 0;
+						if(field.type == ARROW_BOOL && field.dictionary < 0 && col.values_size * 8 < rows) {
+							throw GraphIOException("Arrow: Values buffer too short in " + filename);
+						}
+						if(col.values_size < rows * width) {
+							throw GraphIOException("Arrow: Values buffer too short in " + filename);
+						}
+
+						if(field.dictionary >= 0) {
+							auto it = dictionaries.find(field.dictionary);
+							if(it == dictionaries.end()) {
+								throw GraphIOException("Arrow: Missing dictionary for column " + field.name + " in " + filename);
+							}
+							col.dictionary = &it->second;
+						}
+					}
+					return rows;
+				}
+
+				const uint8_t *buffer(const fb::Table &batch, const uint8_t *body, size_t body_size, size_t i, size_t &size) const {
+					const uint8_t *p = batch.structAt(2, 16, i);
+					int64_t offset = fb::Table::read<int64_t>(p);
+					int64_t length = fb::Table::read<int64_t>(p + 8);
+					if(offset < 0 || length < 0 || size_t(offset) + length > body_size) {
+						throw GraphIOException("Arrow: Buffer out of range in " + filename);
+					}
+					size = length;
+					return length > 0 ? body + offset : NULL;
+				}
+
+				std::string filename;
+				MappedFile file;
+				std::vector<ArrowField> fields;
+				std::unordered_map<int64_t, std::vector<boost::string_ref> > dictionaries;
+				std::vector<ArrowBlock> batches;
+		};
+
+		// Finds the columns of a file matching the visitor's names
+		template<typename Visitor>
+		inline std::vector<int> arrowVisitorColumns(const ArrowFile &file, const Visitor &visitor) {
+			std::vector<int> columns(visitor.count());
+			for(size_t a = 0; a < visitor.count(); ++a) {
+				columns[a] = file.column(visitor.name(a));
+			}
+			return columns;
+		}
+
+		// Numbers vertex labels, resolving each dictionary entry only once
+		class ArrowVertexIds {
+			public:
+				ArrowVertexIds(std::vector<std::string> &labels) : labels(labels), known(labels.size()) {
+					for(size_t i = 0; i < labels.size(); ++i) {
+						ids.insert(std::make_pair(labels[i], i));
+					}
+				}
+
+				size_t get(const ArrowColumnView &col, size_t i) {
+					if(!col.valid(i)) {
+						throw GraphIOException("Arrow: Missing edge endpoint in column " + col.field->name);
+					}
+
+					if(col.dictionary == NULL) {
+						return get(col.str(i));
+					}
+
+					std::vector<size_t> &cache = cached[col.dictionary];
+					if(cache.empty()) initialize(*col.dictionary, cache);
+					cache.resize(col.dictionary->size(), ~size_t(0));
+					int64_t index = col.integer(i);
+					if(index < 0 || size_t(index) >= cache.size()) {
+						throw GraphIOException("Arrow: Dictionary index out of range");
+					}
+					if(cache[index] == ~size_t(0)) {
+						cache[index] = get((*col.dictionary)[index].to_string());
+					}
+					return cache[index];
+				}
+
+			private:
+				// A dictionary listing the vertex table's labels in order, as
+				// written by writeArrowEdges(), maps to the vertices directly.
+				// This keeps vertices with equal labels apart.
+				void initialize(const std::vector<boost::string_ref> &dictionary, std::vector<size_t> &cache) {
+					if(dictionary.size() != known) return;
+					for(size_t i = 0; i < known; ++i) {
+						if(dictionary[i] != labels[i]) return;
+					}
+					cache.resize(known);
+					for(size_t i = 0; i < known; ++i) cache[i] = i;
+				}
+
+				size_t get(const std::string &label) {
+					auto it = ids.insert(std::make_pair(label, labels.size()));
+					if(it.second) labels.push_back(label);
+					return it.first->second;
+				}
+
+				std::vector<std::string> &labels;
+				size_t known;
+				std::unordered_map<std::string, size_t> ids;
+				std::unordered_map<const void*, std::vector<size_t> > cached;
+		};
+	}
+
+	template<class G, typename VV, class IndexMap>
+	inline void writeArrowVertices(const G &g, std::ostream &out, const VV &vv, IndexMap index) {
+		typedef typename boost::graph_traits<G>::vertex_descriptor V;
+
+		auto number = numberVertices(g, index);
+		std::vector<V> order(number.size());
+		size_t bytes = 0;
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			order[number(*vp.first)] = *vp.first;
+			bytes += g[*vp.first].label.size();
+		}
+
+		std::vector<detail::ArrowField> fields(1, detail::arrowStringField("label", bytes));
+		for(size_t a = 0; a < vv.count(); ++a) {
+			fields.push_back(detail::arrowAttributeField(vv.name(a), vv.type(a)));
+		}
+
+		detail::ArrowWriter writer(out, fields);
+		std::vector<detail::ArrowColumn> columns(fields.begin(), fields.end());
+		for(size_t i = 0; i < order.size(); ++i) {
+			const std::string &label = g[order[i]].label;
+			columns[0].addString(label.data(), label.size());
+			for(size_t a = 0; a < vv.count(); ++a) {
+				columns[a+1].addValue(vv.value_str(g[order[i]], a));
+			}
+			if(columns[0].rows == detail::ARROW_BATCH_ROWS) {
+				writer.writeBatch(columns);
+			}
+		}
+		if(columns[0].rows > 0) {
+			writer.writeBatch(columns);
+		}
+		writer.finish();
+	}
+
+	// Writes the edge table. Vertices are referred to by their number,
+	// an index into the vertex label dictionary.
+	template<class G, typename EV, class IndexMap>
+	inline void writeArrowEdges(const G &g, std::ostream &out, const EV &ev, IndexMap index) {
+		auto number = numberVertices(g, index);
+		std::vector<const std::string*> labels(number.size());
+		size_t bytes = 0;
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			labels[number(*vp.first)] = &g[*vp.first].label;
+			bytes += g[*vp.first].label.size();
+		}
+
+		// Number the distinct edge labels
+		std::unordered_map<boost::string_ref, uint32_t, detail::StringRefHash> edge_ids;
+		std::vector<const std::string*> edge_labels;
+		size_t edge_bytes = 0;
+		OutEdgeFilter<G> numbers(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				if(!numbers(i, number(target(*it.first, g)), *it.first)) continue;
+				const std::string &label = g[*it.first].label;
+				if(edge_ids.insert(std::make_pair(boost::string_ref(label), uint32_t(edge_labels.size()))).second) {
+					edge_labels.push_back(&label);
+					edge_bytes += label.size();
+				}
+			}
+		}
+
+		std::vector<detail::ArrowField> fields;
+		fields.push_back(detail::arrowStringField("source", bytes, 0));
+		fields.push_back(detail::arrowStringField("target", bytes, 0));
+		fields.push_back(detail::arrowStringField("label", edge_bytes, 1));
+		for(size_t a = 0; a < ev.count(); ++a) {
+			fields.push_back(detail::arrowAttributeField(ev.name(a), ev.type(a)));
+		}
+
+		detail::ArrowWriter writer(out, fields);
+		writer.writeDictionary(0, labels.size(), fields[0].large(), [&labels](size_t i) -> const std::string& {
+			return *labels[i];
+		});
+		writer.writeDictionary(1, edge_labels.size(), fields[2].large(), [&edge_labels](size_t i) -> const std::string& {
+			return *edge_labels[i];
+		});
+
+		std::vector<detail::ArrowColumn> columns(fields.begin(), fields.end());
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				size_t j = number(target(*it.first, g));
+				if(!writes(i, j, *it.first)) continue;
+
+				columns[0].addIndex(i);
+				columns[1].addIndex(j);
+				columns[2].addIndex(edge_ids.find(g[*it.first].label)->second);
+				for(size_t a = 0; a < ev.count(); ++a) {
+					columns[a+3].addValue(ev.value_str(g[*it.first], a));
+				}
+				if(columns[0].rows == detail::ARROW_BATCH_ROWS) {
+					writer.writeBatch(columns);
+				}
+			}
+		}
+		if(columns[0].rows > 0) {
+			writer.writeBatch(columns);
+		}
+		writer.finish();
+	}
+
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeArrowFile(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		std::string names[2] = { filename, arrowVertexFile(filename) };
+		for(int k = 0; k < 2; ++k) {
+			std::ofstream file(names[k], std::ios::binary);
+			if(!file.good()) {
+				throw GraphIOException(std::string("Could not open file: ") + names[k]);
+			}
+			if(k == 0) writeArrowEdges(g, file, ev, index);
+			else writeArrowVertices(g, file, vv, index);
+			file.close();
+			if(file.fail()) {
+				throw GraphIOException(std::string("Could not write file: ") + names[k]);
+			}
+		}
+	}
+
+	namespace detail {
+		// Reads the labels of the vertex table of filename into labels.
+		// Returns the table, or NULL if there is none.
+		inline std::unique_ptr<ArrowFile> readArrowVertexLabels(const std::string &filename, std::vector<std::string> &labels) {
+			std::unique_ptr<ArrowFile> vertex_file;
+			std::string vertex_filename = arrowVertexFile(filename);
+			if(!fileExists(vertex_filename)) return vertex_file;
+
+			vertex_file.reset(new ArrowFile(vertex_filename));
+			int label = vertex_file->column("label");
+			if(label < 0) {
+				throw GraphIOException("Arrow: No label column in " + vertex_filename);
+			}
+			std::vector<ArrowColumnView> columns;
+			for(size_t b = 0; b < vertex_file->batchCount(); ++b) {
+				size_t rows = vertex_file->batch(b, columns);
+				for(size_t i = 0; i < rows; ++i) {
+					labels.push_back(columns[label].valid(i) ? columns[label].str(i) : std::string());
+				}
+			}
+			return vertex_file;
+		}
+
+		// Finds the endpoint and label columns of an edge table. label is -1 if missing.
+		inline void arrowEdgeColumns(const std::string &filename, const ArrowFile &file, int &source, int &target, int &label) {
+			source = file.column("source");
+			target = file.column("target");
+			label = file.column("label");
+			if(source < 0 || target < 0) {
+				throw GraphIOException("Arrow: No source and target columns in " + filename);
+			}
+		}
+	}
+
+	// Reads the edge table filename and, if present, its vertex table.
+	// Edge endpoints may be string, dictionary-encoded string or integer
+	// columns named source and target; vertices not in the vertex table
+	// are added in order of appearance. Columns named like visitor
+	// attributes are passed to the visitors through from_str().
+	template<class G, typename VV, typename EV>
+	inline void readArrowFile(const std::string &filename, G &g, const VV &vv, const EV &ev) {
+		typedef typename G::vertex_descriptor V;
+
+		std::vector<std::string> labels;
+		std::unique_ptr<detail::ArrowFile> vertex_file = detail::readArrowVertexLabels(filename, labels);
+		std::vector<detail::ArrowColumnView> columns;
+
+		detail::ArrowFile edge_file(filename);
+		int source, target, label;
+		detail::arrowEdgeColumns(filename, edge_file, source, target, label);
+
+		// Resolve endpoints first to know the vertex count
+		std::vector<std::pair<size_t, size_t> > endpoints;
+		{
+			detail::ArrowVertexIds ids(labels);
+			for(size_t b = 0; b < edge_file.batchCount(); ++b) {
+				size_t rows = edge_file.batch(b, columns);
+				for(size_t i = 0; i < rows; ++i) {
+					size_t u = ids.get(columns[source], i);
+					endpoints.push_back(std::make_pair(u, ids.get(columns[target], i)));
+				}
+			}
+		}
+
+		g = G(labels.size());
+		g[boost::graph_bundle].label = basename(filename);
+		for(size_t i = 0; i < labels.size(); ++i) {
+			g[V(i)].label.swap(labels[i]);
+		}
+
+		if(vertex_file) {
+			std::vector<int> attrs = detail::arrowVisitorColumns(*vertex_file, vv);
+			size_t v = 0;
+			for(size_t b = 0; b < vertex_file->batchCount(); ++b) {
+				size_t rows = vertex_file->batch(b, columns);
+				for(size_t i = 0; i < rows; ++i, ++v) {
+					for(size_t a = 0; a < attrs.size(); ++a) {
+						if(attrs[a] >= 0 && columns[attrs[a]].valid(i)) {
+							vv.from_str(g[V(v)], a, columns[attrs[a]].str(i));
+						}
+					}
+				}
+			}
+		}
+
+		std::vector<int> attrs = detail::arrowVisitorColumns(edge_file, ev);
+		size_t k = 0;
+		for(size_t b = 0; b < edge_file.batchCount(); ++b) {
+			size_t rows = edge_file.batch(b, columns);
+			for(size_t i = 0; i < rows; ++i, ++k) {
+				auto e = add_edge(endpoints[k].first, endpoints[k].second, g);
+				if(label >= 0 && columns[label].valid(i)) {
+					g[e.first].label = columns[label].str(i);
+				}
+				for(size_t a = 0; a < attrs.size(); ++a) {
+					if(attrs[a] >= 0 && columns[attrs[a]].valid(i)) {
+						ev.from_str(g[e.first], a, columns[attrs[a]].str(i));
+					}
+				}
+			}
+		}
+	}
+
+	template<class G>
+	inline void readArrowFile(const std::string &filename, G &g) {
+		VertexVisitor vv;
+		EdgeVisitor ev;
+		readArrowFile(filename, g, vv, ev);
+	}
+}
+
+#endif
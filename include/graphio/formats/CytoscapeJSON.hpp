@@ -0,0 +1,403 @@
+#ifndef GRAPHIO_FORMATS_CYTOSCAPEJSON_HPP
+#define GRAPHIO_FORMATS_CYTOSCAPEJSON_HPP
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <fstream>
+#include <unordered_map>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <graphio/utility/basename.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/hash.hpp>
+#include <graphio/utility/escape.hpp>
+#include <graphio/utility/json.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/VertexVisitor.hpp>
+#include <graphio/EdgeVisitor.hpp>
+
+namespace graphio {
+	namespace detail {
+		enum CytoscapeGroup { CYTOSCAPE_ANY, CYTOSCAPE_NODES, CYTOSCAPE_EDGES };
+
+		// Value of a visitor column for the node or edge item
+		struct CytoscapeValue {
+			size_t item;
+			size_t column;
+			boost::string_ref value;
+		};
+
+		struct CytoscapeElements {
+			std::vector<boost::string_ref> nodes, node_labels;
+			std::vector<std::pair<boost::string_ref, boost::string_ref> > edges;
+			std::vector<boost::string_ref> edge_labels;
+			std::vector<CytoscapeValue> node_data, edge_data;
+			std::deque<std::string> decoded;
+			// data.name of a Cytoscape export
+			boost::string_ref graph_label;
+			// Scratch space for the data members of one element
+			std::vector<std::pair<boost::string_ref, boost::string_ref> > data;
+		};
+
+		template<typename Visitor>
+		inline size_t cytoscapeColumn(const Visitor &visitor, const boost::string_ref &name) {
+			for(size_t a = 0; a < visitor.count(); ++a) {
+				if(visitor.name(a) == name) return a;
+			}
+			return ~size_t(0);
+		}
+
+		inline bool cytoscapeMember(
+			const std::vector<std::pair<boost::string_ref, boost::string_ref> > &data,
+			const char *key, boost::string_ref &value
+		) {
+			for(size_t i = 0; i < data.size(); ++i) {
+				if(data[i].first == key) {
+					value = data[i].second;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Parses the element object at p, a node or an edge depending on its
+		// group member, the array it was found in or whether it has a source.
+		template<typename VV, typename EV>
+		inline const char *parseCytoscapeElement(
+			const char *p, const char *end, CytoscapeGroup group,
+			CytoscapeElements &elements, const VV &vv, const EV &ev
+		) {
+			elements.data.clear();
+			boost::string_ref key, value;
+
+			p = json::expect(p, end, '{');
+			bool first = true;
+			while(json::next(p, end, '}', first)) {
+				p = json::parseKey(p, end, key, elements.decoded);
+				if(key == "data" && json::peek(p, end) == '{') {
+					p = json::expect(p, end, '{');
+					bool first_data = true;
+					while(json::next(p, end, '}', first_data)) {
+						p = json::parseKey(p, end, key, elements.decoded);
+						p = json::parseScalar(p, end, value, elements.decoded);
+						elements.data.push_back(std::make_pair(key, value));
+					}
+				}
+				else if(key == "group") {
+					p = json::parseScalar(p, end, value, elements.decoded);
+					if(value == "nodes") group = CYTOSCAPE_NODES;
+					else if(value == "edges") group = CYTOSCAPE_EDGES;
+				}
+				else {
+					p = json::skipValue(p, end);
+				}
+			}
+
+			boost::string_ref source, target, label;
+			if(group == CYTOSCAPE_ANY) {
+				group = cytoscapeMember(elements.data, "source", source) ? CYTOSCAPE_EDGES : CYTOSCAPE_NODES;
+			}
+
+			if(group == CYTOSCAPE_NODES) {
+				boost::string_ref id;
+				if(!cytoscapeMember(elements.data, "id", id)) {
+					throw GraphIOException("Cytoscape JSON: Node without id");
+				}
+				if(!cytoscapeMember(elements.data, "label", label)
+				&& !cytoscapeMember(elements.data, "name", label)) {
+					label = id;
+				}
+				for(size_t i = 0; i < elements.data.size(); ++i) {
+					size_t column = cytoscapeColumn(vv, elements.data[i].first);
+					if(column == ~size_t(0)) continue;
+					CytoscapeValue v = { elements.nodes.size(), column, elements.data[i].second };
+					elements.node_data.push_back(v);
+				}
+				elements.nodes.push_back(id);
+				elements.node_labels.push_back(label);
+			}
+			else {
+				if(!cytoscapeMember(elements.data, "source", source)
+				|| !cytoscapeMember(elements.data, "target", target)) {
+					throw GraphIOException("Cytoscape JSON: Edge without source or target");
+				}
+				if(!cytoscapeMember(elements.data, "label", label)) {
+					cytoscapeMember(elements.data, "interaction", label);
+				}
+				for(size_t i = 0; i < elements.data.size(); ++i) {
+					size_t column = cytoscapeColumn(ev, elements.data[i].first);
+					if(column == ~size_t(0)) continue;
+					CytoscapeValue v = { elements.edges.size(), column, elements.data[i].second };
+					elements.edge_data.push_back(v);
+				}
+				elements.edges.push_back(std::make_pair(source, target));
+				elements.edge_labels.push_back(label);
+			}
+			return p;
+		}
+
+		template<typename VV, typename EV>
+		inline const char *parseCytoscapeArray(
+			const char *p, const char *end, CytoscapeGroup group,
+			CytoscapeElements &elements, const VV &vv, const EV &ev
+		) {
+			p = json::expect(p, end, '[');
+			bool first = true;
+			while(json::next(p, end, ']', first)) {
+				p = parseCytoscapeElement(p, end, group, elements, vv, ev);
+			}
+			return p;
+		}
+
+		// Parses an elements object with nodes and edges arrays
+		template<typename VV, typename EV>
+		inline const char *parseCytoscapeGroups(
+			const char *p, const char *end,
+			CytoscapeElements &elements, const VV &vv, const EV &ev
+		) {
+			boost::string_ref key;
+			p = json::expect(p, end, '{');
+			bool first = true;
+			while(json::next(p, end, '}', first)) {
+				p = json::parseKey(p, end, key, elements.decoded);
+				if(key == "nodes") p = parseCytoscapeArray(p, end, CYTOSCAPE_NODES, elements, vv, ev);
+				else if(key == "edges") p = parseCytoscapeArray(p, end, CYTOSCAPE_EDGES, elements, vv, ev);
+				else p = json::skipValue(p, end);
+			}
+			return p;
+		}
+
+		// Parses the elements of a mapped Cytoscape JSON file
+		template<typename VV, typename EV>
+		inline void parseCytoscapeFile(
+			const std::string &filename, const MappedFile &file,
+			CytoscapeElements &elements, const VV &vv, const EV &ev
+		) {
+			const char *p = file.data(), *end = p + file.size();
+			boost::string_ref key, value;
+
+			if(json::peek(p, end) == '[') {
+				p = parseCytoscapeArray(p, end, CYTOSCAPE_ANY, elements, vv, ev);
+			} else {
+				p = json::expect(p, end, '{');
+				bool first = true;
+				while(json::next(p, end, '}', first)) {
+					p = json::parseKey(p, end, key, elements.decoded);
+					if(key == "elements") {
+						if(json::peek(p, end) == '[') {
+							p = parseCytoscapeArray(p, end, CYTOSCAPE_ANY, elements, vv, ev);
+						} else {
+							p = parseCytoscapeGroups(p, end, elements, vv, ev);
+						}
+					}
+					else if(key == "nodes") {
+						p = parseCytoscapeArray(p, end, CYTOSCAPE_NODES, elements, vv, ev);
+					}
+					else if(key == "edges") {
+						p = parseCytoscapeArray(p, end, CYTOSCAPE_EDGES, elements, vv, ev);
+					}
+					else if(key == "data" && json::peek(p, end) == '{') {
+						p = json::expect(p, end, '{');
+						bool first_data = true;
+						while(json::next(p, end, '}', first_data)) {
+							p = json::parseKey(p, end, key, elements.decoded);
+							p = json::parseScalar(p, end, value, elements.decoded);
+							if(key == "name") elements.graph_label = value;
+						}
+					}
+					else {
+						p = json::skipValue(p, end);
+					}
+				}
+			}
+			if(json::skipSpace(p, end) != end) {
+				throw GraphIOException("Cytoscape JSON: Trailing data in " + filename);
+			}
+		}
+
+		// Numbers the nodes of elements in file order
+		template<class Map>
+		inline void cytoscapeNodeIds(const CytoscapeElements &elements, Map &ids) {
+			ids.reserve(elements.nodes.size());
+			for(size_t i = 0; i < elements.nodes.size(); ++i) {
+				if(!ids.insert(std::make_pair(elements.nodes[i], typename Map::mapped_type(i))).second) {
+					throw GraphIOException("Cytoscape JSON: Duplicate node id " + elements.nodes[i].to_string());
+				}
+			}
+		}
+
+		// Writes value as a JSON number or boolean if the visitor type
+		// calls for one and it is valid JSON as such, otherwise as a string
+		inline void writeCytoscapeValue(std::ostream &out, const std::string &type, const std::string &value) {
+			if(type == "integer" || type == "int" || type == "long"
+			|| type == "real" || type == "double" || type == "float") {
+				if(json::isNumber(value)) {
+					out << value;
+					return;
+				}
+			}
+			else if(type == "boolean" || type == "bool") {
+				if(value == "true" || value == "1") {
+					out << "true";
+					return;
+				}
+				if(value == "false" || value == "0") {
+					out << "false";
+					return;
+				}
+			}
+			out << '"';
+			writeJSONEscaped(out, value);
+			out << '"';
+		}
+	}
+
+	// Reads Cytoscape.js elements JSON in one pass over the mapped file.
+	// Accepts an elements array, an object with nodes and edges arrays,
+	// or either of these as the elements member of a Cytoscape export,
+	// whose data.name becomes the graph label. Vertices are labeled with
+	// data.label or data.name, falling back to the id; edges with
+	// data.label or data.interaction. Other data members are passed to
+	// the visitor column of the same name through from_str().
+	template<class G, typename VV, typename EV>
+	inline void readCytoscapeJSONFile(const std::string &filename, G &g, const VV &vv, const EV &ev) {
+		typedef typename G::vertex_descriptor V;
+
+		MappedFile file(filename);
+		detail::CytoscapeElements elements;
+		detail::parseCytoscapeFile(filename, file, elements, vv, ev);
+
+		std::unordered_map<boost::string_ref, V, detail::StringRefHash> ids;
+		detail::cytoscapeNodeIds(elements, ids);
+
+		g = G(elements.nodes.size());
+		g[boost::graph_bundle].label = elements.graph_label.to_string();
+
+		for(size_t i = 0; i < elements.nodes.size(); ++i) {
+			g[V(i)].label = elements.node_labels[i].to_string();
+		}
+		for(size_t d = 0; d < elements.node_data.size(); ++d) {
+			const detail::CytoscapeValue &v = elements.node_data[d];
+			vv.from_str(g[V(v.item)], v.column, v.value.to_string());
+		}
+
+		size_t d = 0;
+		for(size_t i = 0; i < elements.edges.size(); ++i) {
+			auto u = ids.find(elements.edges[i].first);
+			auto v = ids.find(elements.edges[i].second);
+			if(u == ids.end() || v == ids.end()) {
+				throw GraphIOException("Cytoscape JSON: Edge refers to unknown node "
+					+ (u == ids.end() ? elements.edges[i].first : elements.edges[i].second).to_string());
+			}
+
+			auto e = add_edge(u->second, v->second, g).first;
+			g[e].label = elements.edge_labels[i].to_string();
+			for(; d < elements.edge_data.size() && elements.edge_data[d].item == i; ++d) {
+				ev.from_str(g[e], elements.edge_data[d].column, elements.edge_data[d].value.to_string());
+			}
+		}
+	}
+
+	template<class G>
+	inline void readCytoscapeJSONFile(const std::string &filename, G &g) {
+		VertexVisitor vv;
+		EdgeVisitor ev;
+		readCytoscapeJSONFile(filename, g, vv, ev);
+	}
+
+	// Writes g as a Cytoscape.js export with an elements object holding
+	// nodes and edges arrays, one element per line. title is used as
+	// data.name when g has no label. Visitor columns become data members,
+	// written as numbers or booleans where their type says so.
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeCytoscapeJSON(
+		const G &g,
+		std::ostream &out,
+		const std::string &title,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		out << "{\"data\":{\"name\":\"";
+		if(g[boost::graph_bundle].label.size() > 0) {
+			writeJSONEscaped(out, g[boost::graph_bundle].label);
+		} else {
+			writeJSONEscaped(out, title);
+		}
+		out << "\"},\n\"elements\":{\n\"nodes\":[";
+
+		auto number = numberVertices(g, index);
+
+		const char *sep = "\n";
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			out << sep << "{\"data\":{\"id\":\"n" << number(*vp.first) << "\",\"label\":\"";
+			writeJSONEscaped(out, g[*vp.first].label);
+			out << '"';
+			for(size_t a = 0; a < vv.count(); ++a) {
+				out << ",\"";
+				writeJSONEscaped(out, vv.name(a));
+				out << "\":";
+				detail::writeCytoscapeValue(out, vv.type(a), vv.value_str(g[*vp.first], a));
+			}
+			out << "}}";
+			sep = ",\n";
+		}
+
+		out << "\n],\n\"edges\":[";
+		sep = "\n";
+		size_t k = 0;
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				size_t j = number(target(*it.first, g));
+
+				if(writes(i, j, *it.first)) {
+					out << sep << "{\"data\":{\"id\":\"e" << k++ << "\",\"source\":\"n" << i << "\",\"target\":\"n" << j << "\",\"label\":\"";
+					writeJSONEscaped(out, g[*it.first].label);
+					out << '"';
+					for(size_t a = 0; a < ev.count(); ++a) {
+						out << ",\"";
+						writeJSONEscaped(out, ev.name(a));
+						out << "\":";
+						detail::writeCytoscapeValue(out, ev.type(a), ev.value_str(g[*it.first], a));
+					}
+					out << "}}";
+					sep = ",\n";
+				}
+			}
+		}
+		out << "\n]}}\n";
+	}
+
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeCytoscapeJSONFile(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		std::ofstream file(filename);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeCytoscapeJSON(g, file, basename(filename), vv, ev, index);
+	}
+
+	template<class G, typename VV, typename EV>
+	inline void writeCytoscapeJSONFile(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev
+	) {
+		writeCytoscapeJSONFile(g, filename, vv, ev, get(boost::vertex_index, g));
+	}
+}
+
+#endif
@@ -0,0 +1,484 @@
+#ifndef GRAPHIO_FORMATS_DELIMITED_HPP
+#define GRAPHIO_FORMATS_DELIMITED_HPP
+
+#include <string>
+#include <map>
+#include <deque>
+#include <vector>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <exception>
+#include <unordered_map>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <graphio/utility/basename.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/parallel.hpp>
+#include <graphio/utility/hash.hpp>
+#include <graphio/utility/escape.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/VertexVisitor.hpp>
+#include <graphio/EdgeVisitor.hpp>
+
+namespace graphio {
+	// Column of a delimited file, chosen by header name or by index
+	struct DelimitedColumn {
+		std::string name;
+		int index;
+
+		DelimitedColumn(int index = -1) : index(index) { }
+		DelimitedColumn(const char *name) : name(name), index(-1) { }
+		DelimitedColumn(const std::string &name) : name(name), index(-1) { }
+	};
+
+	struct DelimitedOptions {
+		char delimiter;
+		// Quote character, 0 for none
+		char quote;
+		// Escape character, 0 for none. Set it to the quote character for
+		// quotes doubled inside quoted fields as in CSV; other escape
+		// characters work inside and outside quotes and turn n into a newline.
+		char escape;
+		// Lines starting with this character are skipped, 0 for none
+		char comment;
+		// Lines skipped before the header or the first record
+		size_t skip_lines;
+		// The first record names the columns
+		bool header;
+		// Strip spaces and tabs around unquoted fields
+		bool trim;
+		DelimitedColumn source, target;
+		// Edge label column. Records without it get an empty label.
+		DelimitedColumn label;
+		// Columns of edge visitor attributes, by attribute name.
+		// Attributes not listed use the header column of the same name.
+		std::map<std::string, DelimitedColumn> attributes;
+
+		DelimitedOptions()
+		: delimiter('\t'), quote('"'), escape('\\'), comment(0), skip_lines(0),
+		header(true), trim(false), source(0), target(1), label(2) { }
+
+		// Comma separated values as in RFC 4180
+		static DelimitedOptions csv() {
+			DelimitedOptions options;
+			options.delimiter = ',';
+			options.escape = '"';
+			return options;
+		}
+
+		// Tab separated values with backslash escapes, as written by writeTab()
+		static DelimitedOptions tsv() {
+			return DelimitedOptions();
+		}
+	};
+
+	namespace detail {
+		// Characters that end the fast scan over a field
+		class DelimitedScanners {
+			public:
+				DelimitedScanners(const DelimitedOptions &options)
+				: plain(specials(options.delimiter, options.escape == options.quote ? 0 : options.escape).c_str()),
+				quoted(specials(options.quote, options.escape).c_str()) { }
+
+				// Unquoted fields stop at the delimiter, escapes and line ends
+				EscapeScanner plain;
+				// Quoted fields stop at quotes and escapes
+				EscapeScanner quoted;
+
+			private:
+				static std::string specials(char a, char b) {
+					std::string s;
+					if(a) s += a;
+					if(b && b != a) s += b;
+					return s;
+				}
+		};
+
+		inline bool isDelimitedBlank(char c) {
+			return c == ' ' || c == '\t';
+		}
+
+		// Parses the record at p into fields and returns the position after it.
+		// Fields needing unescaping are decoded into storage in decoded.
+		inline const char *parseDelimitedRecord(
+			const char *p,
+			const char *end,
+			const DelimitedOptions &options,
+			const DelimitedScanners &scanners,
+			std::vector<boost::string_ref> &fields,
+			std::deque<std::string> &decoded
+		) {
+			const char quote = options.quote, escape = options.escape, delimiter = options.delimiter;
+			const bool backslash = escape != 0 && escape != quote;
+
+			fields.clear();
+			while(true) {
+				const char *start = p;
+				std::string *buf = NULL;
+				boost::string_ref field;
+
+				if(quote && p < end && *p == quote) {
+					start = ++p;
+					while(true) {
+						const char *q = scanners.quoted.find(p, end);
+						if(q == end) throw GraphIOException("Unterminated quoted field");
+
+						if(backslash && *q == escape) {
+							if(buf == NULL) {
+								decoded.push_back(std::string(start, p));
+								buf = &decoded.back();
+							}
+							buf->append(p, q);
+							if(q + 1 < end) *buf += q[1] == 'n' ? '\n' : q[1];
+							p = std::min(q + 2, end);
+						}
+						else if(*q == quote && escape == quote && q + 1 < end && q[1] == quote) {
+							if(buf == NULL) {
+								decoded.push_back(std::string(start, p));
+								buf = &decoded.back();
+							}
+							buf->append(p, q + 1);
+							p = q + 2;
+						}
+						else if(*q == quote) {
+							if(buf) buf->append(p, q);
+							field = buf ? boost::string_ref(*buf) : boost::string_ref(start, q - start);
+							p = q + 1;
+							break;
+						}
+						else {
+							// Line breaks and other control characters are kept
+							if(buf) buf->append(p, q + 1);
+							p = q + 1;
+						}
+					}
+
+					// Anything between the closing quote and the delimiter is dropped
+					while(p < end && *p != delimiter && *p != '\n' && *p != '\r') p++;
+				}
+				else {
+					while(true) {
+						const char *q = scanners.plain.find(p, end);
+						if(q == end || *q == delimiter || *q == '\n' || *q == '\r') {
+							if(buf) buf->append(p, q);
+							field = buf ? boost::string_ref(*buf) : boost::string_ref(start, q - start);
+							p = q;
+							break;
+						}
+
+						if(backslash && *q == escape) {
+							if(buf == NULL) {
+								decoded.push_back(std::string(start, p));
+								buf = &decoded.back();
+							}
+							buf->append(p, q);
+							if(q + 1 < end) *buf += q[1] == 'n' ? '\n' : q[1];
+							p = std::min(q + 2, end);
+						}
+						else {
+							if(buf) buf->append(p, q + 1);
+							p = q + 1;
+						}
+					}
+
+					if(options.trim) {
+						while(!field.empty() && isDelimitedBlank(field.front())) field.remove_prefix(1);
+						while(!field.empty() && isDelimitedBlank(field.back())) field.remove_suffix(1);
+					}
+				}
+
+				fields.push_back(field);
+
+				if(p == end) return end;
+				if(*p == delimiter) {
+					p++;
+					continue;
+				}
+				if(*p == '\r') p++;
+				if(p < end && *p == '\n') p++;
+				return p;
+			}
+		}
+
+		// Skips empty and comment lines at p
+		inline const char *skipDelimitedBlankLines(const char *p, const char *end, char comment) {
+			while(p < end) {
+				if(*p == '\n' || *p == '\r') {
+					p++;
+				}
+				else if(comment && *p == comment) {
+					const char *q = static_cast<const char*>(std::memchr(p, '\n', end - p));
+					p = q ? q + 1 : end;
+				}
+				else {
+					break;
+				}
+			}
+			return p;
+		}
+
+		// Selected fields of the records starting in one stretch of the file
+		struct DelimitedChunk {
+			const char *begin, *stop;
+			size_t records;
+			// Per record: source, target, label and the attribute columns
+			std::vector<boost::string_ref> fields;
+			std::deque<std::string> decoded;
+			std::exception_ptr error;
+		};
+
+		// Column positions of the fields kept per record
+		struct DelimitedLayout {
+			// Source, target, label, then attributes; -1 if absent
+			std::vector<int> columns;
+			// Number of leading columns every record must have
+			size_t required;
+		};
+
+		inline void parseDelimitedChunk(
+			const char *p,
+			const char *limit,
+			const char *end,
+			const DelimitedOptions &options,
+			const DelimitedScanners &scanners,
+			const DelimitedLayout &layout,
+			DelimitedChunk &chunk
+		) {
+			chunk.begin = p;
+			chunk.records = 0;
+
+			std::vector<boost::string_ref> fields;
+			while(true) {
+				p = skipDelimitedBlankLines(p, end, options.comment);
+				if(p >= limit) break;
+
+				const char *record = p;
+				p = parseDelimitedRecord(p, end, options, scanners, fields, chunk.decoded);
+				if(fields.size() < layout.required) {
+					const char *nl = static_cast<const char*>(std::memchr(record, '\n', end - record));
+					throw GraphIOException("Too few columns in line: " + std::string(record, nl ? nl : end));
+				}
+
+				for(size_t i = 0; i < layout.columns.size(); ++i) {
+					int c = layout.columns[i];
+					chunk.fields.push_back(c >= 0 && size_t(c) < fields.size() ? fields[c] : boost::string_ref());
+				}
+				chunk.records++;
+			}
+			chunk.stop = p;
+		}
+
+		inline int delimitedColumn(const DelimitedColumn &column, const std::vector<boost::string_ref> &header, bool required) {
+			if(column.index >= 0 || column.name.empty()) {
+				return column.index;
+			}
+			for(size_t i = 0; i < header.size(); ++i) {
+				if(header[i] == column.name) return i;
+			}
+			if(required) {
+				throw GraphIOException("No column named " + column.name);
+			}
+			return -1;
+		}
+
+		// Start of the first line beginning at or after p
+		inline const char *nextDelimitedLine(const char *p, const char *end) {
+			const char *q = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			return q ? q + 1 : end;
+		}
+	}
+
+	// Reads an edge list from delimited text. Columns are selected by
+	// index or, with a header, by name. The file is split between the
+	// executor's threads at line starts; a chunk that turns out to start
+	// inside a quoted field spanning lines is parsed again from the end
+	// of the previous one. Vertices are numbered by first appearance.
+	template<class G, typename EV>
+	inline void readDelimitedFile(
+		const std::string &filename,
+		G &g,
+		const DelimitedOptions &options,
+		const EV &ev,
+		Executor &executor = defaultExecutor()
+	) {
+		typedef typename G::vertex_descriptor V;
+
+		MappedFile file(filename);
+		const char *p = file.data(), *end = p + file.size();
+		detail::DelimitedScanners scanners(options);
+
+		for(size_t i = 0; i < options.skip_lines; ++i) {
+			p = detail::nextDelimitedLine(p, end);
+		}
+
+		std::vector<boost::string_ref> header;
+		std::deque<std::string> header_decoded;
+		if(options.header) {
+			p = detail::skipDelimitedBlankLines(p, end, options.comment);
+			if(p < end) {
+				p = detail::parseDelimitedRecord(p, end, options, scanners, header, header_decoded);
+			}
+		}
+
+		detail::DelimitedLayout layout;
+		layout.columns.push_back(detail::delimitedColumn(options.source, header, true));
+		layout.columns.push_back(detail::delimitedColumn(options.target, header, true));
+		layout.columns.push_back(detail::delimitedColumn(options.label, header, true));
+		for(size_t a = 0; a < ev.count(); ++a) {
+			auto it = options.attributes.find(ev.name(a));
+			if(it != options.attributes.end()) {
+				layout.columns.push_back(detail::delimitedColumn(it->second, header, true));
+			} else {
+				layout.columns.push_back(detail::delimitedColumn(DelimitedColumn(ev.name(a)), header, false));
+			}
+		}
+		if(layout.columns[0] < 0 || layout.columns[1] < 0) {
+			throw GraphIOException("Source and target columns are required");
+		}
+		layout.required = std::max(layout.columns[0], layout.columns[1]) + 1;
+		const size_t width = layout.columns.size();
+
+		size_t k = std::max<size_t>(1, std::min<size_t>(executor.concurrency() * 4, (end - p) >> 16));
+		std::vector<detail::DelimitedChunk> chunks(k);
+		std::vector<const char*> starts(k+1, end);
+		for(size_t i = 0; i < k; ++i) {
+			starts[i] = i == 0 ? p : detail::nextDelimitedLine(p + (end - p) * i / k, end);
+		}
+
+		parallel_for(k, executor, [&](size_t begin, size_t last) {
+			for(size_t i = begin; i < last; ++i) {
+				try {
+					detail::parseDelimitedChunk(starts[i], starts[i+1], end, options, scanners, layout, chunks[i]);
+				} catch(...) {
+					chunks[i].error = std::current_exception();
+				}
+			}
+		});
+
+		// Accept chunks that start where the previous one stopped
+		// and parse the others again
+		for(size_t i = 0; i < k; ++i) {
+			if(i > 0 && (chunks[i].begin != chunks[i-1].stop || chunks[i].error)) {
+				const char *from = chunks[i-1].stop;
+				chunks[i] = detail::DelimitedChunk();
+				detail::parseDelimitedChunk(from, std::max(from, starts[i+1]), end, options, scanners, layout, chunks[i]);
+			}
+			if(chunks[i].error) std::rethrow_exception(chunks[i].error);
+		}
+
+		// Number labels within each chunk, then merge in chunk order
+		typedef std::unordered_map<boost::string_ref, size_t, detail::StringRefHash> Dictionary;
+		std::vector<Dictionary> local(k);
+		std::vector<std::vector<boost::string_ref> > order(k);
+		parallel_for(k, executor, [&](size_t begin, size_t last) {
+			for(size_t i = begin; i < last; ++i) {
+				const detail::DelimitedChunk &c = chunks[i];
+				for(size_t r = 0; r < c.records; ++r) {
+					for(size_t f = 0; f < 2; ++f) {
+						if(local[i].insert(std::make_pair(c.fields[r * width + f], order[i].size())).second) {
+							order[i].push_back(c.fields[r * width + f]);
+						}
+					}
+				}
+			}
+		});
+
+		Dictionary global;
+		std::vector<boost::string_ref> labels;
+		std::vector<std::vector<size_t> > remap(k);
+		for(size_t i = 0; i < k; ++i) {
+			remap[i].resize(order[i].size());
+			for(size_t j = 0; j < order[i].size(); ++j) {
+				auto it = global.insert(std::make_pair(order[i][j], labels.size()));
+				if(it.second) labels.push_back(order[i][j]);
+				remap[i][j] = it.first->second;
+			}
+		}
+
+		std::vector<std::vector<std::pair<V, V> > > endpoints(k);
+		parallel_for(k, executor, [&](size_t begin, size_t last) {
+			for(size_t i = begin; i < last; ++i) {
+				const detail::DelimitedChunk &c = chunks[i];
+				endpoints[i].resize(c.records);
+				for(size_t r = 0; r < c.records; ++r) {
+					endpoints[i][r].first = remap[i][local[i].find(c.fields[r * width])->second];
+					endpoints[i][r].second = remap[i][local[i].find(c.fields[r * width + 1])->second];
+				}
+			}
+		});
+
+		g = G(labels.size());
+		g[boost::graph_bundle].label = basename(filename);
+		for(size_t i = 0; i < labels.size(); ++i) {
+			g[V(i)].label = labels[i].to_string();
+		}
+
+		for(size_t i = 0; i < k; ++i) {
+			const detail::DelimitedChunk &c = chunks[i];
+			for(size_t r = 0; r < c.records; ++r) {
+				const boost::string_ref *f = &c.fields[r * width];
+				auto e = add_edge(endpoints[i][r].first, endpoints[i][r].second, g);
+				g[e.first].label = f[2].to_string();
+				for(size_t a = 0; a < ev.count(); ++a) {
+					if(layout.columns[3+a] >= 0) {
+						ev.from_str(g[e.first], a, f[3+a].to_string());
+					}
+				}
+			}
+		}
+	}
+
+	template<class G>
+	inline void readDelimitedFile(const std::string &filename, G &g, const DelimitedOptions &options = DelimitedOptions()) {
+		EdgeVisitor ev;
+		readDelimitedFile(filename, g, options, ev);
+	}
+
+	// Writes the edges of g as comma separated values with a header
+	// line, quoting fields as readDelimitedFile() with csv() reads them
+	template<class G, typename EV, class IndexMap>
+	inline void writeCSV(const G &g, std::ostream &out, const EV &ev, IndexMap index) {
+		out << "source,target,label";
+		for(size_t a = 0; a < ev.count(); ++a) {
+			out << ",";
+			writeCSVField(out, ev.name(a));
+		}
+		out << "\n";
+
+		auto number = numberVertices(g, index);
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				auto v = target(*it.first, g);
+				if(!writes(i, number(v), *it.first)) continue;
+
+				writeCSVField(out, g[*vp.first].label);
+				out << ",";
+				writeCSVField(out, g[v].label);
+				out << ",";
+				writeCSVField(out, g[*it.first].label);
+				for(size_t a = 0; a < ev.count(); ++a) {
+					out << ",";
+					writeCSVField(out, ev.value_str(g[*it.first], a));
+				}
+				out << "\n";
+			}
+		}
+	}
+
+	template<class G, typename EV, class IndexMap>
+	inline void writeCSVFile(const G &g, const std::string &filename, const EV &ev, IndexMap index) {
+		std::ofstream file(filename);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeCSV(g, file, ev, index);
+	}
+}
+
+#endif
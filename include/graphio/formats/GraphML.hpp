@@ -0,0 +1,445 @@
+#ifndef GRAPHIO_FORMATS_GRAPHML_HPP
+#define GRAPHIO_FORMATS_GRAPHML_HPP
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <graphio/utility/basename.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/hash.hpp>
+#include <graphio/utility/xml.hpp>
+#include <graphio/utility/escape.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/VertexVisitor.hpp>
+#include <graphio/EdgeVisitor.hpp>
+
+namespace graphio {
+	namespace detail {
+		enum GraphMLDomain {
+			GRAPHML_NODE,
+			GRAPHML_EDGE,
+			GRAPHML_GRAPH,
+			GRAPHML_ALL,
+			GRAPHML_OTHER
+		};
+
+		struct GraphMLKey {
+			std::string name;
+			GraphMLDomain domain;
+			bool has_default;
+			std::string value;
+		};
+
+		struct GraphMLValue {
+			// Node or edge number
+			size_t item;
+			size_t key;
+			std::string value;
+		};
+
+		inline GraphMLDomain graphMLDomain(const boost::string_ref &s) {
+			if(s == "node") return GRAPHML_NODE;
+			if(s == "edge") return GRAPHML_EDGE;
+			if(s == "graph") return GRAPHML_GRAPH;
+			if(s == "all") return GRAPHML_ALL;
+			return GRAPHML_OTHER;
+		}
+
+		inline boost::string_ref graphMLAttribute(const xml::Tag &tag, const char *name, std::deque<std::string> &decoded) {
+			boost::string_ref raw;
+			if(!tag.attribute(name, raw)) {
+				throw GraphIOException("GraphML: <" + tag.name.to_string() + "> without " + name);
+			}
+			if(raw.find('&') == boost::string_ref::npos) return raw;
+
+			decoded.push_back(xml::decode(raw));
+			return decoded.back();
+		}
+
+		// Reads the content of the element whose start tag ends at p
+		// into out and returns the position after its end tag
+		inline const char *graphMLText(const char *p, const char *end, std::string &out) {
+			const char *after = xml::skipContent(p, end);
+			const char *close = after;
+			while(*--close != '<');
+			xml::text(p, close, out);
+			return after;
+		}
+
+		// Maps visitor column names to the keys declared for a domain
+		template<typename Visitor>
+		inline std::vector<size_t> graphMLColumns(const std::vector<GraphMLKey> &keys, GraphMLDomain domain, const Visitor &visitor) {
+			std::vector<size_t> columns(keys.size(), ~size_t(0));
+			for(size_t k = 0; k < keys.size(); ++k) {
+				if(keys[k].domain != domain && keys[k].domain != GRAPHML_ALL) continue;
+				for(size_t a = 0; a < visitor.count(); ++a) {
+					if(visitor.name(a) == keys[k].name) columns[k] = a;
+				}
+			}
+			return columns;
+		}
+
+		// GraphML type for an attribute type name as used by the visitors
+		inline std::string graphMLType(const std::string &type) {
+			if(type == "integer" || type == "int") return "int";
+			if(type == "long") return "long";
+			if(type == "real" || type == "double") return "double";
+			if(type == "float") return "float";
+			if(type == "boolean" || type == "bool") return "boolean";
+			return "string";
+		}
+
+		// Nodes, edges and data of a GraphML file, as views into the
+		// mapped file or decoded
+		struct GraphMLDocument {
+			std::vector<GraphMLKey> keys;
+			std::unordered_map<std::string, size_t> key_ids;
+			std::vector<boost::string_ref> nodes;
+			std::vector<std::pair<boost::string_ref, boost::string_ref> > edges;
+			std::vector<bool> edge_directed;
+			std::vector<GraphMLValue> node_data, edge_data;
+			std::deque<std::string> decoded;
+			std::string graph_label;
+			bool graph_labeled;
+			// edgedefault of the first top-level graph
+			bool directed;
+
+			GraphMLDocument() : graph_labeled(false), directed(false) { }
+		};
+
+		inline void parseGraphML(const std::string &filename, const MappedFile &file, GraphMLDocument &doc) {
+			const char *p = file.data(), *end = p + file.size();
+
+			// Innermost open node, edge, key or graph element
+			enum { NONE, NODE, EDGE, KEY, GRAPH };
+			int item = NONE;
+			std::vector<int> stack;
+			// edgedefault of the open graph elements
+			std::vector<bool> directed;
+
+			xml::Tag tag;
+			std::string text;
+			bool root = false, top_level = false;
+			while(p != NULL && (p = static_cast<const char*>(std::memchr(p, '<', end - p))) != NULL) {
+				const char *q = xml::skipMarkup(p, end);
+				if(q != NULL) {
+					p = q;
+					continue;
+				}
+
+				p = xml::parseTag(p, end, tag);
+				if(tag.closing) {
+					if(stack.empty()) throw GraphIOException("GraphML: Unexpected </" + tag.name.to_string() + ">");
+					if(stack.back() == GRAPH) directed.pop_back();
+					stack.pop_back();
+					item = NONE;
+					for(size_t i = stack.size(); i > 0 && item == NONE; --i) {
+						item = stack[i-1];
+					}
+					continue;
+				}
+
+				if(!root) {
+					if(tag.name != "graphml") throw GraphIOException("GraphML: Root element is not <graphml> in " + filename);
+					root = true;
+					if(!tag.empty) stack.push_back(NONE);
+					continue;
+				}
+
+				int opened = NONE;
+				if(tag.name == "key") {
+					boost::string_ref id = graphMLAttribute(tag, "id", doc.decoded), value;
+					GraphMLKey key;
+					key.name = tag.attribute("attr.name", value) ? xml::decode(value) : id.to_string();
+					key.domain = tag.attribute("for", value) ? graphMLDomain(value) : GRAPHML_ALL;
+					key.has_default = false;
+					doc.key_ids[id.to_string()] = doc.keys.size();
+					doc.keys.push_back(key);
+					opened = KEY;
+				}
+				else if(tag.name == "default" && item == KEY) {
+					text.clear();
+					if(!tag.empty) p = graphMLText(p, end, text);
+					doc.keys.back().has_default = true;
+					doc.keys.back().value = text;
+					continue;
+				}
+				else if(tag.name == "graph") {
+					if(!doc.graph_labeled && doc.nodes.empty()) {
+						boost::string_ref id;
+						if(tag.attribute("id", id)) doc.graph_label = xml::decode(id);
+					}
+					boost::string_ref value;
+					bool edgedefault = tag.attribute("edgedefault", value) && value == "directed";
+					if(stack.size() == 1 && !top_level) {
+						doc.directed = edgedefault;
+						top_level = true;
+					}
+					if(!tag.empty) directed.push_back(edgedefault);
+					opened = GRAPH;
+				}
+				else if(tag.name == "node") {
+					doc.nodes.push_back(graphMLAttribute(tag, "id", doc.decoded));
+					opened = NODE;
+				}
+				else if(tag.name == "edge") {
+					boost::string_ref source = graphMLAttribute(tag, "source", doc.decoded);
+					boost::string_ref target = graphMLAttribute(tag, "target", doc.decoded);
+					doc.edges.push_back(std::make_pair(source, target));
+					boost::string_ref value;
+					if(tag.attribute("directed", value)) {
+						doc.edge_directed.push_back(value == "true" || value == "1");
+					} else {
+						doc.edge_directed.push_back(!directed.empty() && directed.back());
+					}
+					opened = EDGE;
+				}
+				else if(tag.name == "data") {
+					boost::string_ref key = graphMLAttribute(tag, "key", doc.decoded);
+					auto k = doc.key_ids.find(key.to_string());
+					if(k == doc.key_ids.end()) throw GraphIOException("GraphML: Undeclared key " + key.to_string());
+
+					text.clear();
+					if(!tag.empty) p = graphMLText(p, end, text);
+
+					GraphMLValue value;
+					value.key = k->second;
+					value.value.swap(text);
+					if(item == NODE) {
+						value.item = doc.nodes.size() - 1;
+						doc.node_data.push_back(std::move(value));
+					} else if(item == EDGE) {
+						value.item = doc.edges.size() - 1;
+						doc.edge_data.push_back(std::move(value));
+					} else if(stack.size() == 2 && doc.keys[value.key].name == "label") {
+						doc.graph_label = value.value;
+						doc.graph_labeled = true;
+					}
+					continue;
+				}
+				else if(tag.name == "hyperedge" || tag.name == "desc") {
+					if(!tag.empty) p = xml::skipContent(p, end);
+					continue;
+				}
+
+				if(!tag.empty) {
+					stack.push_back(opened);
+					if(opened != NONE) item = opened;
+				}
+			}
+
+			if(!root) throw GraphIOException("GraphML: Missing <graphml> in " + filename);
+			if(!stack.empty()) throw GraphIOException("GraphML: Unexpected end of file " + filename);
+		}
+
+		// Numbers the nodes of doc in document order
+		template<class Map>
+		inline void graphMLNodeIds(const GraphMLDocument &doc, Map &ids) {
+			ids.reserve(doc.nodes.size());
+			for(size_t i = 0; i < doc.nodes.size(); ++i) {
+				if(!ids.insert(std::make_pair(doc.nodes[i], typename Map::mapped_type(i))).second) {
+					throw GraphIOException("GraphML: Duplicate node id " + doc.nodes[i].to_string());
+				}
+			}
+		}
+	}
+
+	// Reads a GraphML file in one pass over the mapped file, without
+	// building a document tree. Keys named "label" set vertex, edge and
+	// graph labels; vertices without one are labeled with their id.
+	// Other keys are passed to the visitor column of the same name
+	// through from_str(), using the key's default where data is missing.
+	// Nested graphs are flattened and hyperedges are ignored. Undirected
+	// edges, by edgedefault or their directed attribute, are added in
+	// both directions to directed graphs.
+	template<class G, typename VV, typename EV>
+	inline void readGraphMLFile(const std::string &filename, G &g, const VV &vv, const EV &ev) {
+		using detail::GraphMLKey;
+		using detail::GraphMLValue;
+		typedef typename G::vertex_descriptor V;
+
+		MappedFile file(filename);
+		detail::GraphMLDocument doc;
+		detail::parseGraphML(filename, file, doc);
+		const std::vector<GraphMLKey> &keys = doc.keys;
+		const std::vector<boost::string_ref> &nodes = doc.nodes;
+		const std::vector<std::pair<boost::string_ref, boost::string_ref> > &edges = doc.edges;
+		const std::vector<GraphMLValue> &node_data = doc.node_data, &edge_data = doc.edge_data;
+
+		std::unordered_map<boost::string_ref, V, detail::StringRefHash> ids;
+		detail::graphMLNodeIds(doc, ids);
+
+		g = G(nodes.size());
+		g[boost::graph_bundle].label = doc.graph_label;
+
+		// Defaults first, then the data given
+		std::vector<size_t> vcols = detail::graphMLColumns(keys, detail::GRAPHML_NODE, vv);
+		std::vector<size_t> ecols = detail::graphMLColumns(keys, detail::GRAPHML_EDGE, ev);
+		for(size_t i = 0; i < nodes.size(); ++i) {
+			g[V(i)].label = nodes[i].to_string();
+			for(size_t k = 0; k < keys.size(); ++k) {
+				if(!keys[k].has_default || (keys[k].domain != detail::GRAPHML_NODE && keys[k].domain != detail::GRAPHML_ALL)) continue;
+				if(keys[k].name == "label") g[V(i)].label = keys[k].value;
+				else if(vcols[k] != ~size_t(0)) vv.from_str(g[V(i)], vcols[k], keys[k].value);
+			}
+		}
+		for(size_t d = 0; d < node_data.size(); ++d) {
+			const GraphMLValue &value = node_data[d];
+			if(keys[value.key].name == "label") g[V(value.item)].label = value.value;
+			else if(vcols[value.key] != ~size_t(0)) vv.from_str(g[V(value.item)], vcols[value.key], value.value);
+		}
+
+		size_t d = 0;
+		for(size_t i = 0; i < edges.size(); ++i) {
+			auto u = ids.find(edges[i].first);
+			auto v = ids.find(edges[i].second);
+			if(u == ids.end() || v == ids.end()) {
+				throw GraphIOException("GraphML: Edge refers to unknown node "
+					+ (u == ids.end() ? edges[i].first : edges[i].second).to_string());
+			}
+
+			auto e = add_edge(u->second, v->second, g).first;
+			for(size_t k = 0; k < keys.size(); ++k) {
+				if(!keys[k].has_default || (keys[k].domain != detail::GRAPHML_EDGE && keys[k].domain != detail::GRAPHML_ALL)) continue;
+				if(keys[k].name == "label") g[e].label = keys[k].value;
+				else if(ecols[k] != ~size_t(0)) ev.from_str(g[e], ecols[k], keys[k].value);
+			}
+			for(; d < edge_data.size() && edge_data[d].item == i; ++d) {
+				const GraphMLValue &value = edge_data[d];
+				if(keys[value.key].name == "label") g[e].label = value.value;
+				else if(ecols[value.key] != ~size_t(0)) ev.from_str(g[e], ecols[value.key], value.value);
+			}
+			mirrorUndirectedEdge(g, e, doc.edge_directed[i]);
+		}
+	}
+
+	template<class G>
+	inline void readGraphMLFile(const std::string &filename, G &g) {
+		VertexVisitor vv;
+		EdgeVisitor ev;
+		readGraphMLFile(filename, g, vv, ev);
+	}
+
+	namespace detail {
+		inline void writeGraphMLKey(std::ostream &out, const std::string &id, const char *domain, const std::string &name, const std::string &type) {
+			out << "\t<key id=\"" << id << "\" for=\"" << domain << "\" attr.name=\"";
+			writeXMLEscaped(out, name);
+			out << "\" attr.type=\"" << graphMLType(type) << "\"/>\n";
+		}
+
+		inline void writeGraphMLData(std::ostream &out, const char *indent, const std::string &key, const std::string &value) {
+			out << indent << "<data key=\"" << key << "\">";
+			writeXMLEscaped(out, value);
+			out << "</data>\n";
+		}
+	}
+
+	// Writes g as GraphML to out. title is used as the graph id
+	// when g has no label. Vertex and edge labels are written as
+	// "label" keys, visitor columns as keys of their own.
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeGraphML(
+		const G &g,
+		std::ostream &out,
+		const std::string &title,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+		out << "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\" ";
+		out << "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" ";
+		out << "xsi:schemaLocation=\"http://graphml.graphdrawing.org/xmlns ";
+		out << "http://graphml.graphdrawing.org/xmlns/1.0/graphml.xsd\">\n";
+
+		detail::writeGraphMLKey(out, "label", "node", "label", "string");
+		detail::writeGraphMLKey(out, "elabel", "edge", "label", "string");
+		for(size_t a = 0; a < vv.count(); ++a) {
+			detail::writeGraphMLKey(out, "v" + std::to_string(a), "node", vv.name(a), vv.type(a));
+		}
+		for(size_t a = 0; a < ev.count(); ++a) {
+			detail::writeGraphMLKey(out, "e" + std::to_string(a), "edge", ev.name(a), ev.type(a));
+		}
+
+		out << "\t<graph id=\"";
+		if(g[boost::graph_bundle].label.size() > 0) {
+			writeXMLEscaped(out, g[boost::graph_bundle].label);
+		} else {
+			writeXMLEscaped(out, title);
+		}
+		out << "\" edgedefault=\"" << (boost::is_directed(g) ? "directed" : "undirected") << "\">\n";
+
+		auto number = numberVertices(g, index);
+
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			out << "\t\t<node id=\"n" << number(*vp.first) << "\">\n";
+			detail::writeGraphMLData(out, "\t\t\t", "label", g[*vp.first].label);
+			for(size_t a = 0; a < vv.count(); ++a) {
+				detail::writeGraphMLData(out, "\t\t\t", "v" + std::to_string(a), vv.value_str(g[*vp.first], a));
+			}
+			out << "\t\t</node>\n";
+		}
+
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				size_t j = number(target(*it.first, g));
+
+				if(writes(i, j, *it.first)) {
+					out << "\t\t<edge source=\"n" << i << "\" target=\"n" << j << "\"";
+					if(g[*it.first].label.empty() && ev.count() == 0) {
+						out << "/>\n";
+						continue;
+					}
+					out << ">\n";
+					if(g[*it.first].label.size() > 0) {
+						detail::writeGraphMLData(out, "\t\t\t", "elabel", g[*it.first].label);
+					}
+					for(size_t a = 0; a < ev.count(); ++a) {
+						detail::writeGraphMLData(out, "\t\t\t", "e" + std::to_string(a), ev.value_str(g[*it.first], a));
+					}
+					out << "\t\t</edge>\n";
+				}
+			}
+		}
+
+		out << "\t</graph>\n";
+		out << "</graphml>\n";
+	}
+
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeGraphMLFile(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		std::ofstream file(filename);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeGraphML(g, file, basename(filename), vv, ev, index);
+	}
+
+	template<class G, typename VV, typename EV>
+	inline void writeGraphMLFile(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev
+	) {
+		writeGraphMLFile(g, filename, vv, ev, get(boost::vertex_index, g));
+	}
+}
+
+#endif
@@ -6,124 +6,118 @@
 #include <vector>
 #include <boost/format.hpp>
 #include <boost/algorithm/string.hpp>
-#include <boost/lexical_cast.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <graphio/utility/basename.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
 #include <graphio/GraphIOException.hpp>
+#include <graphio/ParsePolicy.hpp>
+#include <graphio/utility/FileInput.hpp>
 
 namespace graphio {
-	namespace {
-		inline std::istream &LEDAReadLine(std::istream &is, std::string &str) {
-			do {
-				std::getline(is, str);
-				boost::algorithm::trim(str);
-			} while(str[0] == '#' || str.length() == 0);
-
-			return is;
-		}
-	}
-
-	template<class G>
+	template<class Policy = StrictPolicy, class G>
 	inline void readLEDAFile(const std::string &filename, G &g) {
-		std::string line;
-		size_t n, m;
-		std::ifstream file(filename);
-		if(!file.good()) {
-			throw GraphIOException(std::string("Could not open file: ") + filename);
-		}
-
-		if(file.is_open() == false) {
-			throw GraphIOException("Could not open file: " + filename);
-		}
+		std::string line, label;
+		size_t n, m, u, v;
+		FileInput file(filename);
 
 		// Look for header string
-		LEDAReadLine(file, line);
+		Policy::readLEDALine(file, line);
 		if(boost::algorithm::equals(line, "LEDA.GRAPH") == false) {
 			throw GraphIOException("\"LEDA.GRAPH\" header not found");
 		}
 
  		// Node type
-		LEDAReadLine(file, line);
+		Policy::readLEDALine(file, line);
 		// Edge type
-		LEDAReadLine(file, line);
-		// Directed/undirected
-		LEDAReadLine(file, line);
+		Policy::readLEDALine(file, line);
+		// -1 for directed, -2 for undirected
+		Policy::readLEDALine(file, line);
+		bool directed = line != "-2";
 
 		// Node count
-		LEDAReadLine(file, line);
-		n = boost::lexical_cast<size_t>(line);
+		Policy::readLEDALine(file, line);
+		n = Policy::parseSize(line);
 
 		g = G(n);
 		g[boost::graph_bundle].label = basename(filename);
 
 		// Read nodes
 		for(size_t i = 0; i < n; ++i) {
-			LEDAReadLine(file, line);
-
-			size_t begin = line.find("|{") + 2;
-			size_t end = line.find("}|");
-
-			if(begin == std::string::npos || end == std::string::npos || end <= begin) {
-				throw GraphIOException("Malformed node label: " + line);
-			}
-
-			g[i].label = line.substr(begin, end-begin);
+			Policy::readLEDALine(file, line);
+			g[i].label = Policy::parseLEDALabel(line);
 		}
 
 		// Edge count
-		LEDAReadLine(file, line);
-		m = boost::lexical_cast<size_t>(line);
+		Policy::readLEDALine(file, line);
+		m = Policy::parseSize(line);
 
 		// Read edges
 		for(size_t i = 0; i < m; ++i) {
-			LEDAReadLine(file, line);
-
-			std::vector<std::string> parts;
-			boost::split(parts, line, boost::is_any_of(" \t"));
-			int u = boost::lexical_cast<int>(parts[0]) - 1;
-			int v = boost::lexical_cast<int>(parts[1]) - 1;
-
-			size_t begin = parts[3].find("|{") + 2;
-			size_t end = parts[3].find("}|");
+			Policy::readLEDALine(file, line);
+			Policy::parseLEDAEdge(line, u, v, label);
 
 			auto e = add_edge(u, v, g);
-			g[e.first].label = parts[3].substr(begin, end-begin);
-
+			g[e.first].label = label;
+			mirrorUndirectedEdge(g, e.first, directed);
 		}
 	}
 
-	template<class G>
-	inline void writeLEDAFile(const G &g, const std::string &filename) {
+	template<class G, class IndexMap>
+	inline void writeLEDA(const G &g, std::ostream &out, IndexMap index) {
 		using boost::format;
 
-		std::ofstream file(filename);
-		if(!file.good()) {
-			throw GraphIOException(std::string("Could not open file: ") + filename);
-		}
+		auto number = numberVertices(g, index);
 
-		file << "LEDA.GRAPH" << std::endl;
-		file << "string" << std::endl;
-		file << "string" << std::endl;
-		file << "-2" << std::endl;
+		out << "LEDA.GRAPH" << std::endl;
+		out << "string" << std::endl;
+		out << "string" << std::endl;
+		out << (boost::is_directed(g) ? "-1" : "-2") << std::endl;
 
-		file << num_vertices(g) << std::endl;
-		for(size_t i = 0; i < num_vertices(g); ++i) {
-			file << format("|{%s}|\n") % g[i].label;
+		out << number.size() << std::endl;
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			out << format("|{%s}|\n") % g[*vp.first].label;
 		}
 
-		file << num_edges(g) << std::endl;
+		// Count edges first since the header needs it
+		size_t m = 0;
+		OutEdgeFilter<G> counts(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				if(counts(i, number(target(*it.first, g)), *it.first)) m++;
+			}
+		}
+		out << m << std::endl;
 
-		for(size_t i = 0; i < num_vertices(g); ++i) {
-			for(auto it = out_edges(i, g); it.first != it.second; ++it.first) {
-				size_t j = target(*it.first, g);
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				size_t j = number(target(*it.first, g));
 
-				if(i <= j) {
-					file << format("%d %d 0 |{%s}|\n")
+				if(writes(i, j, *it.first)) {
+					out << format("%d %d 0 |{%s}|\n")
 						% (i+1) % (j+1) % g[*it.first].label;
 				}
 			}
 		}
 	}
+
+	template<class G, class IndexMap>
+	inline void writeLEDAFile(const G &g, const std::string &filename, IndexMap index) {
+		std::ofstream file(filename);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeLEDA(g, file, index);
+	}
+
+	template<class G>
+	inline void writeLEDAFile(const G &g, const std::string &filename) {
+		writeLEDAFile(g, filename, get(boost::vertex_index, g));
+	}
 }
 
 #endif
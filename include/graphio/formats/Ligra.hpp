@@ -0,0 +1,509 @@
+#ifndef GRAPHIO_FORMATS_LIGRA_HPP
+#define GRAPHIO_FORMATS_LIGRA_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <boost/graph/graph_traits.hpp>
+#include <graphio/utility/basename.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/LabelSidecar.hpp>
+#include <graphio/utility/HugePageAllocator.hpp>
+#include <graphio/utility/parallel.hpp>
+#include <graphio/GraphIOException.hpp>
+
+// Formats of the Ligra and GBBS graph processing frameworks, which
+// store vertex numbers only; labels go to sidecar files.
+//
+// AdjacencyGraph (.adj): text, the line "AdjacencyGraph", then n, m, n
+//   offsets and m targets, whitespace separated.
+// Binary CSR (.bcsr): the GBBS binary layout, uint64 n, m and file size,
+//   n+1 uint64 offsets and m uint32 targets.
+// Binary edge list (.bel): uint32 source and target pairs.
+//
+// Both adjacency formats list every undirected edge from both endpoints,
+// the edge list lists it once. Directed graphs list each edge once, at
+// its source. Binary data is in native byte order.
+namespace graphio {
+	namespace detail {
+		typedef std::vector<uint64_t, HugePageAllocator<uint64_t> > LigraOffsets;
+		typedef std::vector<uint32_t, HugePageAllocator<uint32_t> > LigraTargets;
+
+		// Symmetric adjacency of g in vertex number order, each list sorted
+		// by target, with the labels of the edges seen from their lower end.
+		// Directed graphs give their out-adjacency and every edge label.
+		template<class G>
+		struct LigraAdjacency {
+			LigraOffsets offsets;
+			LigraTargets targets;
+			std::vector<const std::string*> edge_labels;
+			bool labeled, directed;
+
+			template<class IndexMap>
+			LigraAdjacency(const G &g, IndexMap index) : offsets(1, 0), labeled(false), directed(boost::is_directed(g)) {
+				auto number = numberVertices(g, index);
+				if(number.size() > UINT32_MAX) {
+					throw GraphIOException("Too many vertices for 32 bit vertex numbers");
+				}
+
+				std::vector<std::pair<uint32_t, const std::string*> > adj;
+				std::vector<const void*> loops;
+				for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+					size_t i = number(*vp.first);
+					adj.clear();
+					loops.clear();
+					for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+						size_t j = number(target(*it.first, g));
+						const std::string *label = &g[*it.first].label;
+						// Undirected self-loops are listed twice
+						if(i == j && !directed) {
+							if(std::find(loops.begin(), loops.end(), label) != loops.end()) continue;
+							loops.push_back(label);
+						}
+						adj.push_back(std::make_pair(uint32_t(j), label));
+					}
+
+					std::stable_sort(adj.begin(), adj.end(), [](const std::pair<uint32_t, const std::string*> &a, const std::pair<uint32_t, const std::string*> &b) {
+						return a.first < b.first;
+					});
+					for(size_t k = 0; k < adj.size(); ++k) {
+						targets.push_back(adj[k].first);
+						if(writesOutEdge(g, i, adj[k].first)) {
+							edge_labels.push_back(adj[k].second);
+							labeled = labeled || !adj[k].second->empty();
+						}
+					}
+					offsets.push_back(targets.size());
+				}
+			}
+
+			inline size_t vertexCount() const {
+				return offsets.size() - 1;
+			}
+		};
+
+		template<class G, class IndexMap>
+		inline void writeLigraSidecars(const G &g, const std::string &filename, IndexMap index, const LigraAdjacency<G> &adj, SidecarOutput &output) {
+			std::vector<const std::string*> labels(adj.vertexCount());
+			auto number = numberVertices(g, index);
+			for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+				labels[number(*vp.first)] = &g[*vp.first].label;
+			}
+			output.write(vertexLabelSidecar(filename), [&labels](std::ostream &out) {
+				writeLabelSidecar(out, labels.size(), [&labels](size_t i) -> const std::string& {
+					return *labels[i];
+				});
+			});
+
+			std::string elabels = edgeLabelSidecar(filename);
+			if(adj.labeled) {
+				output.write(elabels, [&adj](std::ostream &out) {
+					writeLabelSidecar(out, adj.edge_labels.size(), [&adj](size_t i) -> const std::string& {
+						return *adj.edge_labels[i];
+					});
+				});
+			} else {
+				output.remove(elabels);
+			}
+
+			std::string marker = directedSidecar(filename);
+			if(adj.directed) {
+				output.write(marker, [](std::ostream&) { });
+			} else {
+				output.remove(marker);
+			}
+		}
+
+		// Sets vertex labels from the sidecar of filename, or to the vertex numbers
+		template<class G>
+		inline void readLigraVertexLabels(const std::string &filename, G &g, size_t n) {
+			std::vector<std::string> labels;
+			if(readLabelSidecar(vertexLabelSidecar(filename), labels)) {
+				if(labels.size() != n) {
+					throw GraphIOException("Label sidecar does not match the vertex count of " + filename);
+				}
+				for(size_t i = 0; i < n; ++i) {
+					g[i].label.swap(labels[i]);
+				}
+			} else {
+				for(size_t i = 0; i < n; ++i) {
+					g[i].label = std::to_string(i);
+				}
+			}
+		}
+
+		inline void checkLigraAdjacency(const std::string &filename, size_t n, size_t m, const uint64_t *offsets, const uint32_t *targets, Executor &executor) {
+			if(offsets[0] != 0 || offsets[n] != m) {
+				throw GraphIOException("Invalid offsets in " + filename);
+			}
+			parallel_for(n, executor, [&](size_t begin, size_t end) {
+				for(size_t v = begin; v < end; ++v) {
+					if(offsets[v+1] < offsets[v] || offsets[v+1] > m) {
+						throw GraphIOException("Invalid offsets in " + filename);
+					}
+					for(size_t k = offsets[v]; k < offsets[v+1]; ++k) {
+						if(targets[k] >= n) {
+							throw GraphIOException("Target out of range in " + filename);
+						}
+					}
+				}
+			});
+		}
+
+		// Fills g from a checked adjacency. Each edge is added from its
+		// lower endpoint; entries only found at the higher endpoint, as
+		// in directed files, are added from there. Directed graphs get
+		// every entry as an edge from the vertex listing it.
+		template<class G>
+		void buildFromLigraAdjacency(const std::string &filename, G &g, size_t n, const uint64_t *offsets, const uint32_t *targets, Executor &executor) {
+			std::vector<char> sorted(n);
+			parallel_for(n, executor, [&](size_t begin, size_t end) {
+				for(size_t v = begin; v < end; ++v) {
+					sorted[v] = std::is_sorted(targets + offsets[v], targets + offsets[v+1]);
+				}
+			});
+
+			g = G(n);
+			g[boost::graph_bundle].label = basename(filename);
+			readLigraVertexLabels(filename, g, n);
+
+			std::vector<std::string> elabels;
+			readLabelSidecar(edgeLabelSidecar(filename), elabels);
+
+			size_t e = 0;
+			for(size_t u = 0; u < n; ++u) {
+				for(size_t k = offsets[u]; k < offsets[u+1]; ++k) {
+					uint32_t v = targets[k];
+					if(v < u && !boost::is_directed(g)) {
+						const uint32_t *first = targets + offsets[v], *last = targets + offsets[v+1];
+						bool listed = sorted[v] ? std::binary_search(first, last, uint32_t(u)) : std::find(first, last, uint32_t(u)) != last;
+						if(listed) continue;
+					}
+
+					auto edge = add_edge(u, v, g);
+					if(e < elabels.size()) {
+						g[edge.first].label.swap(elabels[e]);
+					}
+					e++;
+				}
+			}
+		}
+
+		inline bool isLigraSpace(char c) {
+			return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+		}
+
+		// Parses the whitespace separated unsigned numbers in [p, end),
+		// splitting the text between the executor's threads
+		inline void parseLigraNumbers(const std::string &filename, const char *p, const char *end, LigraOffsets &out, Executor &executor) {
+			size_t length = end - p;
+			size_t chunks = std::max<size_t>(1, std::min<size_t>(executor.concurrency() * 4, length >> 20));
+
+			// Chunks start at whitespace so no number is split
+			std::vector<const char*> bounds(chunks+1);
+			bounds[0] = p;
+			bounds[chunks] = end;
+			for(size_t c = 1; c < chunks; ++c) {
+				const char *q = std::max(p + length * c / chunks, bounds[c-1]);
+				while(q < end && !isLigraSpace(*q)) ++q;
+				bounds[c] = q;
+			}
+
+			std::vector<size_t> counts(chunks+1, 0);
+			parallel_for(chunks, executor, [&](size_t begin, size_t stop) {
+				for(size_t c = begin; c < stop; ++c) {
+					bool space = true;
+					for(const char *q = bounds[c]; q < bounds[c+1]; ++q) {
+						bool s = isLigraSpace(*q);
+						if(space && !s) counts[c+1]++;
+						space = s;
+					}
+				}
+			});
+			for(size_t c = 0; c < chunks; ++c) counts[c+1] += counts[c];
+
+			out.resize(counts[chunks]);
+			parallel_for(chunks, executor, [&](size_t begin, size_t stop) {
+				for(size_t c = begin; c < stop; ++c) {
+					uint64_t *value = out.data() + counts[c];
+					const char *q = bounds[c], *last = bounds[c+1];
+					while(true) {
+						while(q < last && isLigraSpace(*q)) ++q;
+						if(q == last) break;
+
+						uint64_t x = 0;
+						for(; q < last && !isLigraSpace(*q); ++q) {
+							if(*q < '0' || *q > '9') {
+								throw GraphIOException("AdjacencyGraph: Invalid number in " + filename);
+							}
+							x = x * 10 + (*q - '0');
+						}
+						*value++ = x;
+					}
+				}
+			});
+		}
+
+		// Appends the decimal digits of x
+		inline char *formatLigraNumber(char *p, uint64_t x) {
+			char digits[20];
+			size_t n = 0;
+			do {
+				digits[n++] = '0' + x % 10;
+				x /= 10;
+			} while(x > 0);
+			while(n > 0) *p++ = digits[--n];
+			return p;
+		}
+
+		template<class It>
+		inline void writeLigraNumbers(std::ostream &out, It first, It last) {
+			std::vector<char> buf(GRAPHIO_INPUT_BLOCK_SIZE + 32);
+			char *p = buf.data();
+			for(; first != last; ++first) {
+				p = formatLigraNumber(p, *first);
+				*p++ = '\n';
+				if(size_t(p - buf.data()) >= GRAPHIO_INPUT_BLOCK_SIZE) {
+					out.write(buf.data(), p - buf.data());
+					p = buf.data();
+				}
+			}
+			out.write(buf.data(), p - buf.data());
+		}
+	}
+
+	template<class G>
+	inline void readAdjacencyGraphFile(const std::string &filename, G &g, Executor &executor = defaultExecutor()) {
+		MappedFile file(filename);
+		const char *p = file.data(), *end = p + file.size();
+
+		const char *header = "AdjacencyGraph";
+		size_t len = std::strlen(header);
+		if(file.size() < len || std::memcmp(p, header, len) != 0 || (p + len < end && !detail::isLigraSpace(p[len]))) {
+			throw GraphIOException("Not an unweighted AdjacencyGraph file: " + filename);
+		}
+
+		detail::LigraOffsets numbers;
+		detail::parseLigraNumbers(filename, p + len, end, numbers, executor);
+		if(numbers.size() < 2 || numbers.size() != 2 + numbers[0] + numbers[1]) {
+			throw GraphIOException("AdjacencyGraph: Wrong number of entries in " + filename);
+		}
+
+		size_t n = numbers[0], m = numbers[1];
+		if(n > UINT32_MAX) {
+			throw GraphIOException("Too many vertices in " + filename);
+		}
+
+		// Offsets stay 64 bit in place, with m appended; targets are narrowed
+		detail::LigraTargets targets(m);
+		const uint64_t *t = numbers.data() + 2 + n;
+		parallel_for(m, executor, [&](size_t begin, size_t end) {
+			for(size_t k = begin; k < end; ++k) {
+				if(t[k] >= n) {
+					throw GraphIOException("Target out of range in " + filename);
+				}
+				targets[k] = t[k];
+			}
+		});
+		numbers.resize(2 + n);
+		numbers.push_back(m);
+
+		const uint64_t *offsets = numbers.data() + 2;
+		detail::checkLigraAdjacency(filename, n, m, offsets, targets.data(), executor);
+		detail::buildFromLigraAdjacency(filename, g, n, offsets, targets.data(), executor);
+	}
+
+	// Arrays of a .bcsr file, pointing into its mapping
+	struct BinaryCSRView {
+		uint64_t n, m;
+		const uint64_t *offsets;
+		const uint32_t *targets;
+	};
+
+	// Checks the header, offsets and targets of the .bcsr file mapped
+	// in file. The mapping is page aligned, so the arrays are used in place.
+	inline BinaryCSRView viewBinaryCSR(const std::string &filename, const MappedFile &file, Executor &executor = defaultExecutor()) {
+		uint64_t header[3];
+		if(file.size() < sizeof(header)) {
+			throw GraphIOException("Not a binary CSR file: " + filename);
+		}
+		std::memcpy(header, file.data(), sizeof(header));
+
+		// Sizes are compared by division, so large counts cannot wrap around
+		BinaryCSRView view;
+		view.n = header[0];
+		view.m = header[1];
+		uint64_t arrays = file.size() - sizeof(header);
+		if(view.n > UINT32_MAX || header[2] != file.size()
+		|| arrays / sizeof(uint64_t) < view.n + 1
+		|| (arrays - (view.n+1) * sizeof(uint64_t)) % sizeof(uint32_t) != 0
+		|| (arrays - (view.n+1) * sizeof(uint64_t)) / sizeof(uint32_t) != view.m) {
+			throw GraphIOException("Not a binary CSR file: " + filename);
+		}
+
+		view.offsets = reinterpret_cast<const uint64_t*>(file.data() + sizeof(header));
+		view.targets = reinterpret_cast<const uint32_t*>(view.offsets + view.n + 1);
+		detail::checkLigraAdjacency(filename, view.n, view.m, view.offsets, view.targets, executor);
+		return view;
+	}
+
+	template<class G>
+	inline void readBinaryCSRFile(const std::string &filename, G &g, Executor &executor = defaultExecutor()) {
+		MappedFile file(filename);
+		BinaryCSRView view = viewBinaryCSR(filename, file, executor);
+		detail::buildFromLigraAdjacency(filename, g, view.n, view.offsets, view.targets, executor);
+	}
+
+	template<class G>
+	inline void readBinaryEdgeListFile(const std::string &filename, G &g) {
+		MappedFile file(filename);
+		if(file.size() % (2 * sizeof(uint32_t)) != 0) {
+			throw GraphIOException("Not a binary edge list: " + filename);
+		}
+
+		const uint32_t *edges = reinterpret_cast<const uint32_t*>(file.data());
+		size_t m = file.size() / (2 * sizeof(uint32_t));
+
+		std::vector<std::string> labels;
+		size_t n = 0;
+		if(readLabelSidecar(vertexLabelSidecar(filename), labels)) {
+			n = labels.size();
+		}
+		for(size_t k = 0; k < 2*m; ++k) {
+			if(edges[k] >= n) {
+				if(!labels.empty()) {
+					throw GraphIOException("Label sidecar does not match the vertex count of " + filename);
+				}
+				n = size_t(edges[k]) + 1;
+			}
+		}
+
+		g = G(n);
+		g[boost::graph_bundle].label = basename(filename);
+		detail::readLigraVertexLabels(filename, g, n);
+
+		std::vector<std::string> elabels;
+		readLabelSidecar(edgeLabelSidecar(filename), elabels);
+		for(size_t k = 0; k < m; ++k) {
+			auto e = add_edge(edges[2*k], edges[2*k+1], g);
+			if(k < elabels.size()) {
+				g[e.first].label.swap(elabels[k]);
+			}
+		}
+	}
+
+	namespace detail {
+		template<class G>
+		inline void writeAdjacencyGraph(std::ostream &out, const LigraAdjacency<G> &adj) {
+			out << "AdjacencyGraph\n" << adj.vertexCount() << "\n" << adj.targets.size() << "\n";
+			writeLigraNumbers(out, adj.offsets.begin(), adj.offsets.end() - 1);
+			writeLigraNumbers(out, adj.targets.begin(), adj.targets.end());
+		}
+
+		template<class G>
+		inline void writeBinaryCSR(std::ostream &out, const LigraAdjacency<G> &adj) {
+			uint64_t header[3];
+			header[0] = adj.vertexCount();
+			header[1] = adj.targets.size();
+			header[2] = sizeof(header) + adj.offsets.size() * sizeof(uint64_t) + adj.targets.size() * sizeof(uint32_t);
+			out.write(reinterpret_cast<const char*>(header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(adj.offsets.data()), adj.offsets.size() * sizeof(uint64_t));
+			out.write(reinterpret_cast<const char*>(adj.targets.data()), adj.targets.size() * sizeof(uint32_t));
+		}
+
+		template<class G>
+		inline void writeBinaryEdgeList(std::ostream &out, const LigraAdjacency<G> &adj) {
+			std::vector<uint32_t> buf;
+			buf.reserve(GRAPHIO_INPUT_BLOCK_SIZE / sizeof(uint32_t));
+			for(size_t u = 0; u < adj.vertexCount(); ++u) {
+				for(size_t k = adj.offsets[u]; k < adj.offsets[u+1]; ++k) {
+					if(adj.targets[k] < u && !adj.directed) continue;
+					buf.push_back(u);
+					buf.push_back(adj.targets[k]);
+					if(buf.size() == buf.capacity()) {
+						out.write(reinterpret_cast<const char*>(buf.data()), buf.size() * sizeof(uint32_t));
+						buf.clear();
+					}
+				}
+			}
+			out.write(reinterpret_cast<const char*>(buf.data()), buf.size() * sizeof(uint32_t));
+		}
+
+		// Writes filename with write(out, adj), then the label sidecars
+		template<class G, class IndexMap, typename F>
+		inline void writeLigraFile(const G &g, const std::string &filename, IndexMap index, F write) {
+			std::ofstream file(filename, std::ios::binary);
+			if(!file.good()) {
+				throw GraphIOException(std::string("Could not open file: ") + filename);
+			}
+
+			LigraAdjacency<G> adj(g, index);
+			write(file, adj);
+			file.close();
+			if(file.fail()) {
+				throw GraphIOException(std::string("Could not write file: ") + filename);
+			}
+			SidecarFiles output;
+			writeLigraSidecars(g, filename, index, adj, output);
+		}
+	}
+
+	// The stream writers write the structure of g only,
+	// the file writers also write its label sidecars.
+	template<class G, class IndexMap>
+	inline void writeAdjacencyGraph(const G &g, std::ostream &out, IndexMap index) {
+		detail::writeAdjacencyGraph(out, detail::LigraAdjacency<G>(g, index));
+	}
+
+	template<class G, class IndexMap>
+	inline void writeBinaryCSR(const G &g, std::ostream &out, IndexMap index) {
+		detail::writeBinaryCSR(out, detail::LigraAdjacency<G>(g, index));
+	}
+
+	template<class G, class IndexMap>
+	inline void writeBinaryEdgeList(const G &g, std::ostream &out, IndexMap index) {
+		detail::writeBinaryEdgeList(out, detail::LigraAdjacency<G>(g, index));
+	}
+
+	// Writes the label sidecars of filename for g
+	template<class G, class IndexMap>
+	inline void writeLigraSidecars(const G &g, const std::string &filename, IndexMap index, SidecarOutput &output) {
+		detail::writeLigraSidecars(g, filename, index, detail::LigraAdjacency<G>(g, index), output);
+	}
+
+	template<class G, class IndexMap>
+	inline void writeLigraSidecars(const G &g, const std::string &filename, IndexMap index) {
+		SidecarFiles output;
+		writeLigraSidecars(g, filename, index, output);
+	}
+
+	template<class G, class IndexMap>
+	inline void writeAdjacencyGraphFile(const G &g, const std::string &filename, IndexMap index) {
+		detail::writeLigraFile(g, filename, index, [](std::ostream &out, const detail::LigraAdjacency<G> &adj) {
+			detail::writeAdjacencyGraph(out, adj);
+		});
+	}
+
+	template<class G, class IndexMap>
+	inline void writeBinaryCSRFile(const G &g, const std::string &filename, IndexMap index) {
+		detail::writeLigraFile(g, filename, index, [](std::ostream &out, const detail::LigraAdjacency<G> &adj) {
+			detail::writeBinaryCSR(out, adj);
+		});
+	}
+
+	template<class G, class IndexMap>
+	inline void writeBinaryEdgeListFile(const G &g, const std::string &filename, IndexMap index) {
+		detail::writeLigraFile(g, filename, index, [](std::ostream &out, const detail::LigraAdjacency<G> &adj) {
+			detail::writeBinaryEdgeList(out, adj);
+		});
+	}
+}
+
+#endif
@@ -8,12 +8,16 @@
 #include <boost/graph/graph_traits.hpp>
 #include <graphio/utility/basename.hpp>
 #include <graphio/utility/split.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/escape.hpp>
 #include <graphio/GraphIOException.hpp>
+#include <graphio/ParsePolicy.hpp>
+#include <graphio/utility/FileInput.hpp>
 
 namespace graphio {
-	template<class G>
+	template<class Policy = StrictPolicy, class G>
 	inline void readSIFFile(const std::string &filename, G &g) {
-		std::ifstream file;
 		std::string line;
 		std::vector<std::string> parts;
 		std::map<std::string, int> map;
@@ -21,15 +25,11 @@ namespace graphio {
 		// Map vertex labels to ids
 		int id = 0;
 		std::map<std::string, int>::iterator it1, it2;
-		file.open(filename);
-
-		if(!file.good()) {
-			throw GraphIOException(std::string("Could not open file: ") + filename);
-		}
+		FileInput file(filename);
 
-		while(std::getline(file, line)) {
+		while(getline(file, line)) {
 			if(line.length() == 0) continue;
-			escaped_split(line, " \t", parts);
+			Policy::split(line, " \t", parts);
 
 			for(size_t i = 0; i  < parts.size(); ++i) {
 				if(i == 1) continue;
@@ -51,11 +51,10 @@ namespace graphio {
 		}
 
 		// Add edges
-		file.close();
-		file.open(filename);
-		while(std::getline(file, line)) {
+		file.rewind();
+		while(getline(file, line)) {
 			if(line.length() == 0) continue;
-			escaped_split(line, " \t", parts);
+			Policy::split(line, " \t", parts);
 
 			if(parts.size() < 3) continue;
 
@@ -68,35 +67,82 @@ namespace graphio {
 		}
 	}
 
-	template<class G>
-	inline void writeSIFFile(const G &g, const std::string &filename) {
-		std::ofstream file(filename);
-		if(!file.good()) {
-			throw GraphIOException(std::string("Could not open file: ") + filename);
-		}
+	// Streams the vertices and edges of a SIF file into a GraphBuilder
+	// handle instead of building a graph
+	template<class Policy = StrictPolicy, class Handle>
+	inline void readSIFEdges(const std::string &filename, Handle &h) {
+		std::string line;
+		std::vector<std::string> parts;
+		FileInput file(filename);
+
+		while(getline(file, line)) {
+			if(line.length() == 0) continue;
+			Policy::split(line, " \t", parts);
+
+			if(parts.empty()) continue;
+			if(parts.size() < 3) {
+				h.addVertex(parts[0]);
+				continue;
+			}
 
-		for(size_t i = 0; i < num_vertices(g); ++i) {
-			for(auto it = out_edges(i, g); it.first != it.second; ++it.first) {
-				size_t j = target(*it.first, g);
+			for(size_t i = 2; i < parts.size(); ++i) {
+				h.addEdge(parts[0], parts[i], parts[1]);
+			}
+		}
+	}
 
-				if(i <= j) {
-					file << g[i].label << " ";
+	template<class G, class IndexMap>
+	inline void writeSIF(const G &g, std::ostream &out, IndexMap index) {
+		const EscapeScanner &scanner = sifEscapes();
+		auto number = numberVertices(g, index);
+		// Vertices named on an edge line, at either end
+		std::vector<bool> linked(number.size(), false);
+
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				auto v = target(*it.first, g);
+				size_t j = number(v);
+
+				if(writes(i, j, *it.first)) {
+					linked[i] = linked[j] = true;
+					writeField(out, g[*vp.first].label, scanner);
+					out << " ";
 					if(g[*it.first].label.length() > 0) {
-						file << g[*it.first].label;
+						writeField(out, g[*it.first].label, scanner);
 					} else {
-						file << "?";
+						out << "?";
 					}
-					file << " " << g[j].label << "\n";
+					out << " ";
+					writeField(out, g[v].label, scanner);
+					out << "\n";
 				}
 			}
 		}
 
-		for(size_t i = 0; i < num_vertices(g); ++i) {
-			if(out_degree(i, g) == 0) {
-				file << g[i].label << "\n";
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			if(!linked[number(*vp.first)]) {
+				writeField(out, g[*vp.first].label, scanner);
+				out << "\n";
 			}
 		}
 	}
+
+	template<class G, class IndexMap>
+	inline void writeSIFFile(const G &g, const std::string &filename, IndexMap index) {
+		std::ofstream file(filename);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeSIF(g, file, index);
+	}
+
+	template<class G>
+	inline void writeSIFFile(const G &g, const std::string &filename) {
+		writeSIFFile(g, filename, get(boost::vertex_index, g));
+	}
 }
 
 #endif
@@ -8,42 +8,41 @@
 #include <boost/graph/graph_traits.hpp>
 #include <graphio/utility/basename.hpp>
 #include <graphio/utility/split.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/escape.hpp>
 #include <graphio/GraphIOException.hpp>
+#include <graphio/ParsePolicy.hpp>
+#include <graphio/utility/FileInput.hpp>
 
 namespace graphio {
-	template<class G>
+	template<class Policy = StrictPolicy, class G>
 	inline void readTabFile(const std::string &filename, G &g) {
-		std::ifstream file;
 		std::string line;
 		std::vector<std::string> parts;
 		std::map<std::string, int> map;
 
-		file.open(filename);
-		if(!file.good()) {
-			throw GraphIOException(std::string("Could not open file: ") + filename);
-		}
+		FileInput file(filename);
 
 		// Skip header line
-		std::getline(file, line);
+		getline(file, line);
 
 		// Map vertex labels to ids
 		int id = 0;
 		std::map<std::string, int>::iterator it1, it2;
-		while(std::getline(file, line)) {
+		while(getline(file, line)) {
 			if(line.length() == 0) continue;
-			escaped_split(line, "\t", parts);
+			Policy::split(line, "\t", parts);
 
-			if(parts.size() < 2) {
-				throw GraphIOException(std::string("Too few columns in line: ") + line);
-			}
+			Policy::checkColumns(line, parts, 2);
 
 			it1 = map.find(parts[0]);
-			it2 = map.find(parts[1]);
-
 			if(it1 == map.end()) {
 				map[parts[0]] = id;
 				id++;
 			}
+
+			it2 = map.find(parts[1]);
 			if(it2 == map.end()) {
 				map[parts[1]] = id;
 				id++;
@@ -59,12 +58,11 @@ namespace graphio {
 		}
 
 		// Add edges
-		file.close();
-		file.open(filename);
-		std::getline(file, line);
-		while(std::getline(file, line)) {
+		file.rewind();
+		getline(file, line);
+		while(getline(file, line)) {
 			if(line.length() == 0) continue;
-			escaped_split(line, "\t", parts);
+			Policy::split(line, "\t", parts);
 
 			int id1 = map[parts[0]];
 			int id2 = map[parts[1]];
@@ -75,46 +73,98 @@ namespace graphio {
 				g[e.first].label = parts[2];
 			}
 		}
-		file.close();
 	}
 
-	template<class G, typename VV, typename EV>
-	inline void writeTabFile(
+	// Streams the edges of a tab file into a GraphBuilder handle instead
+	// of building a graph
+	template<class Policy = StrictPolicy, class Handle>
+	inline void readTabEdges(const std::string &filename, Handle &h) {
+		std::string line;
+		std::vector<std::string> parts;
+		FileInput file(filename);
+
+		// Skip header line
+		getline(file, line);
+
+		while(getline(file, line)) {
+			if(line.length() == 0) continue;
+			Policy::split(line, "\t", parts);
+
+			Policy::checkColumns(line, parts, 2);
+
+			h.addEdge(parts[0], parts[1], parts.size() > 2 ? parts[2] : std::string());
+		}
+	}
+
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeTab(
 			const G &g,
-			const std::string &filename,
+			std::ostream &out,
 			const VV &vv,
-			const EV &ev
+			const EV &ev,
+			IndexMap index
 		) {
-		std::ofstream file(filename);
-		if(!file.good()) {
-			throw GraphIOException(std::string("Could not open file: ") + filename);
-		}
+		const EscapeScanner &scanner = tabEscapes();
 
-		file << "INTERACTOR_A\tINTERACTOR_B\tlabel";
+		out << "INTERACTOR_A\tINTERACTOR_B\tlabel";
 		for(size_t a = 0; a < ev.count(); ++a) {
-			file << "\t" << ev.name(a);
+			out << "\t";
+			writeField(out, ev.name(a), scanner);
 		}
-		file << "\n";
+		out << "\n";
+
+		auto number = numberVertices(g, index);
 
-		for(size_t i = 0; i < num_vertices(g); ++i) {
-			for(auto it = out_edges(i, g); it.first != it.second; ++it.first) {
-				size_t j = target(*it.first, g);
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				auto v = target(*it.first, g);
 
-				if(i <= j) {
-					file << g[i].label << "\t" << g[j].label;
+				if(writes(i, number(v), *it.first)) {
+					writeField(out, g[*vp.first].label, scanner);
+					out << "\t";
+					writeField(out, g[v].label, scanner);
 					if(g[*it.first].label.length() > 0) {
-						file << "\t" << g[*it.first].label;
+						out << "\t";
+						writeField(out, g[*it.first].label, scanner);
 					} else {
-						file << "\tNA";
+						out << "\tNA";
 					}
 					for(size_t a = 0; a < ev.count(); ++a) {
-						file << "\t" << ev.value_str(g[*it.first], a);
+						out << "\t";
+						writeField(out, ev.value_str(g[*it.first], a), scanner);
 					}
-					file << "\n";
+					out << "\n";
 				}
 			}
 		}
-		file.close();
+	}
+
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeTabFile(
+			const G &g,
+			const std::string &filename,
+			const VV &vv,
+			const EV &ev,
+			IndexMap index
+		) {
+		std::ofstream file(filename);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeTab(g, file, vv, ev, index);
+	}
+
+	template<class G, typename VV, typename EV>
+	inline void writeTabFile(
+			const G &g,
+			const std::string &filename,
+			const VV &vv,
+			const EV &ev
+		) {
+		writeTabFile(g, filename, vv, ev, get(boost::vertex_index, g));
 	}
 }
 
@@ -3,14 +3,32 @@
 
 #include <string>
 #include <map>
-#include <boost/format.hpp>
+#include <deque>
+#include <vector>
+#include <fstream>
+#include <exception>
+#include <unordered_map>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <graphio/utility/basename.hpp>
+#include <graphio/utility/VertexNumbering.hpp>
+#include <graphio/utility/direction.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/parallel.hpp>
+#include <graphio/utility/hash.hpp>
+#include <graphio/utility/xml.hpp>
+#include <graphio/utility/escape.hpp>
 #include <graphio/GraphIOException.hpp>
 
 namespace graphio {
+	namespace detail {
+		// XGMML graphs are undirected unless directed is 1 or true
+		inline bool xgmmlDirected(const boost::string_ref &value) {
+			return value == "1" || value == "true";
+		}
+	}
+
 	template<class G>
 	inline void readXGMMLFile(const std::string &filename, G &g) {
 		typedef typename G::vertex_descriptor V;
@@ -28,6 +46,7 @@ namespace graphio {
 
 		g = G(n);
 		g[boost::graph_bundle].label = pt.get<std::string>("graph.<xmlattr>.label");
+		bool directed = detail::xgmmlDirected(pt.get<std::string>("graph.<xmlattr>.directed", ""));
 
 		for(auto &c : pt.get_child("graph")) {
 			if(c.first == "node") {
@@ -42,64 +61,312 @@ namespace graphio {
 				V v = map[target];
 				auto e = add_edge(u, v, g);
 				g[e.first].label = c.second.get<std::string>("<xmlattr>.label");
+				mirrorUndirectedEdge(g, e.first, directed);
 			}
 		}
 	}
 
-	template<class G, typename VV, typename EV>
-	inline void writeXGMMLFile(
+	namespace detail {
+		// Nodes and edges of one stretch of top-level graph elements
+		struct XGMMLChunk {
+			const char *begin, *stop;
+			// Set when the chunk ended at </graph>
+			bool closed;
+			std::vector<boost::string_ref> ids;
+			std::vector<std::string> labels;
+			std::vector<std::pair<boost::string_ref, boost::string_ref> > edges;
+			std::vector<std::string> edge_labels;
+			// Decoded ids that contained character references
+			std::deque<std::string> decoded;
+			std::exception_ptr error;
+		};
+
+		inline boost::string_ref xgmmlId(const xml::Tag &tag, const char *name, XGMMLChunk &chunk) {
+			boost::string_ref raw;
+			if(!tag.attribute(name, raw)) {
+				throw GraphIOException(std::string("XGMML: ") + tag.name.to_string() + " without " + name);
+			}
+			if(raw.find('&') == boost::string_ref::npos) return raw;
+
+			chunk.decoded.push_back(xml::decode(raw));
+			return chunk.decoded.back();
+		}
+
+		inline std::string xgmmlLabel(const xml::Tag &tag) {
+			boost::string_ref raw;
+			return tag.attribute("label", raw) ? xml::decode(raw) : std::string();
+		}
+
+		// Parses top-level elements of the graph body from begin until the
+		// first element starting at or after limit, or until </graph>.
+		inline void parseXGMMLChunk(const char *begin, const char *limit, const char *end, XGMMLChunk &chunk) {
+			chunk.begin = begin;
+			chunk.closed = false;
+
+			xml::Tag tag;
+			const char *p = begin;
+			while(true) {
+				p = static_cast<const char*>(std::memchr(p, '<', end - p));
+				if(p == NULL) throw GraphIOException("XGMML: Missing </graph>");
+
+				const char *q = xml::skipMarkup(p, end);
+				if(q != NULL) {
+					p = q;
+					continue;
+				}
+
+				if(p >= limit && p + 1 < end && p[1] != '/') break;
+
+				q = xml::parseTag(p, end, tag);
+				if(tag.closing) {
+					if(tag.name != "graph") {
+						throw GraphIOException("XGMML: Unexpected </" + tag.name.to_string() + ">");
+					}
+					chunk.closed = true;
+					break;
+				}
+
+				if(tag.name == "node") {
+					chunk.ids.push_back(xgmmlId(tag, "id", chunk));
+					chunk.labels.push_back(xgmmlLabel(tag));
+				}
+				else if(tag.name == "edge") {
+					boost::string_ref source = xgmmlId(tag, "source", chunk);
+					boost::string_ref target = xgmmlId(tag, "target", chunk);
+					chunk.edges.push_back(std::make_pair(source, target));
+					chunk.edge_labels.push_back(xgmmlLabel(tag));
+				}
+
+				p = tag.empty ? q : xml::skipContent(q, end);
+			}
+			chunk.stop = p;
+		}
+
+		// First <node or <edge at or after p, which may turn out to lie
+		// inside a comment, CDATA section or nested element
+		inline const char *findXGMMLElement(const char *p, const char *end) {
+			while((p = static_cast<const char*>(std::memchr(p, '<', end - p))) != NULL) {
+				if((xml::startsWith(p, end, "<node") || xml::startsWith(p, end, "<edge"))
+				&& p + 5 < end && (xml::isSpace(p[5]) || p[5] == '>' || p[5] == '/')) {
+					return p;
+				}
+				p++;
+			}
+			return end;
+		}
+	}
+
+	// Reads an XGMML file on executor. The body of the graph element is
+	// cut into chunks at <node and <edge tags which are parsed in parallel.
+	// A cut that falls inside a comment, CDATA section or nested element
+	// is caught when the preceding chunk does not end exactly on it, and
+	// that chunk is parsed again from the right place. Vertices are
+	// numbered in document order, as by readXGMMLFile().
+	template<class G>
+	inline void readXGMMLFileParallel(const std::string &filename, G &g, Executor &executor = defaultExecutor()) {
+		typedef typename G::vertex_descriptor V;
+
+		MappedFile file(filename);
+		const char *p = file.data(), *end = p + file.size();
+
+		// Find the graph start tag
+		xml::Tag tag;
+		while(true) {
+			p = p ? static_cast<const char*>(std::memchr(p, '<', end - p)) : NULL;
+			if(p == NULL) throw GraphIOException("XGMML: Missing <graph> in " + filename);
+
+			const char *q = xml::skipMarkup(p, end);
+			if(q != NULL) {
+				p = q;
+				continue;
+			}
+
+			p = xml::parseTag(p, end, tag);
+			if(tag.name != "graph" || tag.closing) {
+				throw GraphIOException("XGMML: Root element is not <graph> in " + filename);
+			}
+			break;
+		}
+		std::string title = detail::xgmmlLabel(tag);
+		boost::string_ref orientation;
+		bool directed = tag.attribute("directed", orientation) && detail::xgmmlDirected(orientation);
+
+		size_t k = tag.empty ? 0 : std::max<size_t>(1, std::min<size_t>(executor.concurrency() * 4, (end - p) >> 16));
+		std::vector<detail::XGMMLChunk> chunks(k);
+		std::vector<const char*> starts(k+1, end);
+		for(size_t i = 0; i < k; ++i) {
+			starts[i] = i == 0 ? p : detail::findXGMMLElement(p + (end - p) * i / k, end);
+		}
+
+		parallel_for(k, executor, [&](size_t begin, size_t last) {
+			for(size_t i = begin; i < last; ++i) {
+				try {
+					detail::parseXGMMLChunk(starts[i], starts[i+1], end, chunks[i]);
+				} catch(...) {
+					chunks[i].error = std::current_exception();
+				}
+			}
+		});
+
+		// Accept chunks that start where the previous one stopped
+		// and parse the others again
+		size_t used = 0;
+		for(size_t i = 0; i < k; ++i) {
+			if(i > 0) {
+				if(chunks[i-1].closed) break;
+				if(chunks[i].begin != chunks[i-1].stop || chunks[i].error) {
+					chunks[i] = detail::XGMMLChunk();
+					detail::parseXGMMLChunk(chunks[i-1].stop, starts[i+1], end, chunks[i]);
+				}
+			}
+			if(chunks[i].error) std::rethrow_exception(chunks[i].error);
+			used = i+1;
+		}
+		chunks.resize(used);
+
+		// Number vertices in document order
+		std::vector<size_t> first(used+1, 0);
+		for(size_t i = 0; i < used; ++i) {
+			first[i+1] = first[i] + chunks[i].ids.size();
+		}
+
+		std::unordered_map<boost::string_ref, V, detail::StringRefHash> ids(first[used]);
+		for(size_t i = 0; i < used; ++i) {
+			for(size_t j = 0; j < chunks[i].ids.size(); ++j) {
+				if(!ids.insert(std::make_pair(chunks[i].ids[j], V(first[i] + j))).second) {
+					throw GraphIOException("XGMML: Duplicate node id " + chunks[i].ids[j].to_string());
+				}
+			}
+		}
+
+		g = G(first[used]);
+		g[boost::graph_bundle].label = title;
+
+		std::vector<std::vector<std::pair<V, V> > > endpoints(used);
+		parallel_for(used, executor, [&](size_t begin, size_t last) {
+			for(size_t i = begin; i < last; ++i) {
+				for(size_t j = 0; j < chunks[i].labels.size(); ++j) {
+					g[V(first[i] + j)].label.swap(chunks[i].labels[j]);
+				}
+
+				endpoints[i].resize(chunks[i].edges.size());
+				for(size_t j = 0; j < chunks[i].edges.size(); ++j) {
+					auto u = ids.find(chunks[i].edges[j].first);
+					auto v = ids.find(chunks[i].edges[j].second);
+					if(u == ids.end() || v == ids.end()) {
+						throw GraphIOException("XGMML: Edge refers to unknown node "
+							+ (u == ids.end() ? chunks[i].edges[j].first : chunks[i].edges[j].second).to_string());
+					}
+					endpoints[i][j] = std::make_pair(u->second, v->second);
+				}
+			}
+		});
+
+		for(size_t i = 0; i < used; ++i) {
+			for(size_t j = 0; j < endpoints[i].size(); ++j) {
+				auto e = add_edge(endpoints[i][j].first, endpoints[i][j].second, g);
+				g[e.first].label.swap(chunks[i].edge_labels[j]);
+				mirrorUndirectedEdge(g, e.first, directed);
+			}
+		}
+	}
+
+	namespace detail {
+		inline void writeXGMMLAttribute(std::ostream &out, const std::string &name, const std::string &type, const std::string &value, const char *close) {
+			out << "\t\t<att name=\"";
+			writeXMLEscaped(out, name);
+			out << "\" type=\"";
+			writeXMLEscaped(out, type);
+			out << "\" value=\"";
+			writeXMLEscaped(out, value);
+			out << "\"" << close;
+		}
+	}
+
+	// Writes g as XGMML to out. title is used as the graph label
+	// when g has none.
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeXGMML(
 		const G &g,
-		const std::string &filename,
+		std::ostream &out,
+		const std::string &title,
 		const VV &vv,
-		const EV &ev
+		const EV &ev,
+		IndexMap index
 	) {
-		using boost::format;
-
-		std::ofstream file(filename);
-		if(!file.good()) {
-			throw GraphIOException(std::string("Could not open file: ") + filename);
-		}
-		
-		file << "<?xml version=\"1.0\"?>\n";
+		out << "<?xml version=\"1.0\"?>\n";
 
+		out << "<graph label=\"";
 		if(g[boost::graph_bundle].label.size() > 0) {
-			file << "<graph label=\"" << g[boost::graph_bundle].label << "\" ";
+			writeXMLEscaped(out, g[boost::graph_bundle].label);
 		} else {
-			file << "<graph label=\"" << basename(filename) << "\" ";
+			writeXMLEscaped(out, title);
 		}
-		file << "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" ";
-		file << "xmlns:xlink=\"http://www.w3.org/1999/xlink\" ";
-		file << "xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\" ";
-		file << "xmlns=\"http://www.cs.rpi.edu/XGMML\" ";
-		file << "directed=\"0\">\n";
+		out << "\" ";
+		out << "xmlns:dc=\"http://purl.org/dc/elements/1.1/\" ";
+		out << "xmlns:xlink=\"http://www.w3.org/1999/xlink\" ";
+		out << "xmlns:rdf=\"http://www.w3.org/1999/02/22-rdf-syntax-ns#\" ";
+		out << "xmlns=\"http://www.cs.rpi.edu/XGMML\" ";
+		out << "directed=\"" << (boost::is_directed(g) ? 1 : 0) << "\">\n";
+
+		auto number = numberVertices(g, index);
 
-		for(size_t i = 0; i < num_vertices(g); ++i) {
-			file << format("\t<node id=\"%d\" label=\"%s\">\n") % (i+1) % g[i].label;
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			out << "\t<node id=\"" << (i+1) << "\" label=\"";
+			writeXMLEscaped(out, g[*vp.first].label);
+			out << "\">\n";
 			for(size_t a = 0; a < vv.count(); ++a) {
-				file << format("\t\t<att name=\"%s\" type=\"%s\" value=\"%s\"/>\n")
-					% vv.name(a) % vv.type(a) % vv.value_str(g[i], a);
+				detail::writeXGMMLAttribute(out, vv.name(a), vv.type(a), vv.value_str(g[*vp.first], a), "/>\n");
 			}
-			file << "\t</node>\n";
+			out << "\t</node>\n";
 		}
 
-		for(size_t i = 0; i < num_vertices(g); ++i) {
-			for(auto it = out_edges(i, g); it.first != it.second; ++it.first) {
-				size_t j = target(*it.first, g);
+		OutEdgeFilter<G> writes(g);
+		for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+			size_t i = number(*vp.first);
+			for(auto it = out_edges(*vp.first, g); it.first != it.second; ++it.first) {
+				size_t j = number(target(*it.first, g));
 
-				if(i <= j) {
-					file << format("\t<edge source=\"%d\" target=\"%d\" label=\"%s\">\n")
-						% (i+1) % (j+1) % g[*it.first].label;
+				if(writes(i, j, *it.first)) {
+					out << "\t<edge source=\"" << (i+1) << "\" target=\"" << (j+1) << "\" label=\"";
+					writeXMLEscaped(out, g[*it.first].label);
+					out << "\">\n";
 
 					for(size_t a = 0; a < ev.count(); ++a) {
-						file << format("\t\t<att name=\"%s\" type=\"%s\" value=\"%s\" />\n")
-							% ev.name(a) % ev.type(a) % ev.value_str(g[*it.first], a);
+						detail::writeXGMMLAttribute(out, ev.name(a), ev.type(a), ev.value_str(g[*it.first], a), " />\n");
 					}
-					file << "\t</edge>\n";
+					out << "\t</edge>\n";
 				}
 			}
 		}
-		file << "</graph>";
-		file.close();
+		out << "</graph>";
+	}
+
+	template<class G, typename VV, typename EV, class IndexMap>
+	inline void writeXGMMLFile(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev,
+		IndexMap index
+	) {
+		std::ofstream file(filename);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeXGMML(g, file, basename(filename), vv, ev, index);
+	}
+
+	template<class G, typename VV, typename EV>
+	inline void writeXGMMLFile(
+		const G &g,
+		const std::string &filename,
+		const VV &vv,
+		const EV &ev
+	) {
+		writeXGMMLFile(g, filename, vv, ev, get(boost::vertex_index, g));
 	}
 }
 
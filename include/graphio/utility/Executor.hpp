@@ -0,0 +1,267 @@
+#ifndef GRAPHIO_UTILITY_EXECUTOR_HPP
+#define GRAPHIO_UTILITY_EXECUTOR_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <future>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+namespace graphio {
+	inline unsigned defaultThreadCount() {
+		unsigned n = std::thread::hardware_concurrency();
+		return n > 0 ? n : 1;
+	}
+
+	// Runs the tasks of every parallel graphio operation. Implement it
+	// to run graphio on an application's own thread pool.
+	class Executor {
+		public:
+			virtual ~Executor() { }
+
+			// Runs task at some later point on any thread
+			virtual void submit(std::function<void()> task) = 0;
+
+			// Number of tasks that can usefully run at once
+			virtual unsigned concurrency() const = 0;
+
+			// Calls f(begin, end) on disjoint ranges covering [0, n) and
+			// returns when all have finished, rethrowing the first exception.
+			// The calling thread takes part, so nested calls from inside a
+			// task do not need extra threads.
+			virtual void parallel_for(size_t n, const std::function<void(size_t, size_t)> &f) {
+				unsigned threads = concurrency();
+				if(threads <= 1 || n <= 1) {
+					if(n > 0) f(size_t(0), n);
+					return;
+				}
+
+				std::shared_ptr<Bulk> bulk = std::make_shared<Bulk>(n, std::min<size_t>(n, size_t(threads) * 4), f);
+				size_t helpers = std::min<size_t>(threads - 1, bulk->chunks - 1);
+				for(size_t i = 0; i < helpers; ++i) {
+					submit([bulk]() { bulk->run(); });
+				}
+				bulk->run();
+
+				// Help with other queued work while chunks taken by others finish
+				std::unique_lock<std::mutex> lock(bulk->mutex);
+				while(bulk->done != bulk->chunks) {
+					lock.unlock();
+					bool ran = tryRunTask();
+					lock.lock();
+					if(!ran) {
+						bulk->finished.wait(lock, [&bulk]() { return bulk->done == bulk->chunks; });
+					}
+				}
+
+				if(bulk->error) std::rethrow_exception(bulk->error);
+			}
+
+		protected:
+			// Runs one queued task on the calling thread if there is one
+			virtual bool tryRunTask() {
+				return false;
+			}
+
+		private:
+			struct Bulk {
+				Bulk(size_t n, size_t chunks, const std::function<void(size_t, size_t)> &f)
+				: n(n), chunks(chunks), next(0), done(0), f(f) { }
+
+				void run() {
+					size_t c;
+					while((c = next++) < chunks) {
+						try {
+							f(n * c / chunks, n * (c+1) / chunks);
+						} catch(...) {
+							std::lock_guard<std::mutex> lock(mutex);
+							if(!error) error = std::current_exception();
+						}
+
+						std::lock_guard<std::mutex> lock(mutex);
+						if(++done == chunks) finished.notify_all();
+					}
+				}
+
+				size_t n, chunks;
+				std::atomic<size_t> next;
+				size_t done;
+				// Only called while the submitting thread waits
+				const std::function<void(size_t, size_t)> &f;
+				std::exception_ptr error;
+				std::mutex mutex;
+				std::condition_variable finished;
+			};
+	};
+
+	// Runs everything on the calling thread
+	class InlineExecutor : public Executor {
+		public:
+			void submit(std::function<void()> task) {
+				task();
+			}
+
+			unsigned concurrency() const {
+				return 1;
+			}
+	};
+
+	// Fixed-size work-stealing thread pool. Each worker has its own task
+	// queue; tasks submitted from a worker go to its own queue and are run
+	// newest first, idle workers steal the oldest task from other queues.
+	class ThreadPool : public Executor {
+		public:
+			explicit ThreadPool(unsigned threads = defaultThreadCount())
+			: pending(0), next_queue(0), stopping(false) {
+				threads = std::max(1u, threads);
+				for(unsigned i = 0; i < threads; ++i) {
+					queues.push_back(std::unique_ptr<Queue>(new Queue()));
+				}
+				for(unsigned i = 0; i < threads; ++i) {
+					workers.push_back(std::thread([this, i]() { work(i); }));
+				}
+			}
+
+			// Finishes all queued tasks, then stops the workers
+			~ThreadPool() {
+				{
+					std::lock_guard<std::mutex> lock(sleep_mutex);
+					stopping = true;
+				}
+				wake.notify_all();
+				for(size_t i = 0; i < workers.size(); ++i) {
+					workers[i].join();
+				}
+			}
+
+			void submit(std::function<void()> task) {
+				size_t q = currentPool() == this ? currentIndex() : next_queue++ % queues.size();
+				{
+					std::lock_guard<std::mutex> lock(sleep_mutex);
+					pending++;
+				}
+				{
+					std::lock_guard<std::mutex> lock(queues[q]->mutex);
+					queues[q]->tasks.push_back(std::move(task));
+				}
+				wake.notify_one();
+			}
+
+			unsigned concurrency() const {
+				return workers.size();
+			}
+
+		protected:
+			bool tryRunTask() {
+				std::function<void()> task;
+				size_t home = currentPool() == this ? currentIndex() : 0;
+				if(!take(home, task)) return false;
+				task();
+				return true;
+			}
+
+		private:
+			struct Queue {
+				std::mutex mutex;
+				std::deque<std::function<void()> > tasks;
+			};
+
+			static ThreadPool *&currentPool() {
+				static thread_local ThreadPool *pool = NULL;
+				return pool;
+			}
+
+			static size_t &currentIndex() {
+				static thread_local size_t index = 0;
+				return index;
+			}
+
+			// Pops the newest task of queue home or steals the oldest of another
+			bool take(size_t home, std::function<void()> &task) {
+				for(size_t k = 0; k < queues.size(); ++k) {
+					Queue &q = *queues[(home + k) % queues.size()];
+					std::lock_guard<std::mutex> lock(q.mutex);
+					if(q.tasks.empty()) continue;
+
+					if(k == 0) {
+						task = std::move(q.tasks.back());
+						q.tasks.pop_back();
+					} else {
+						task = std::move(q.tasks.front());
+						q.tasks.pop_front();
+					}
+					pending--;
+					return true;
+				}
+				return false;
+			}
+
+			void work(size_t index) {
+				currentPool() = this;
+				currentIndex() = index;
+
+				std::function<void()> task;
+				while(true) {
+					if(take(index, task)) {
+						task();
+						task = nullptr;
+						continue;
+					}
+
+					std::unique_lock<std::mutex> lock(sleep_mutex);
+					wake.wait(lock, [this]() { return pending > 0 || stopping; });
+					if(stopping && pending == 0) return;
+				}
+			}
+
+			std::vector<std::unique_ptr<Queue> > queues;
+			std::vector<std::thread> workers;
+			std::atomic<size_t> pending;
+			std::atomic<size_t> next_queue;
+			bool stopping;
+			std::mutex sleep_mutex;
+			std::condition_variable wake;
+	};
+
+	namespace detail {
+		inline std::atomic<Executor*> &defaultExecutorSlot() {
+			static std::atomic<Executor*> slot(NULL);
+			return slot;
+		}
+	}
+
+	// Executor used when none is passed, a shared ThreadPool
+	// unless replaced with setDefaultExecutor()
+	inline Executor &defaultExecutor() {
+		Executor *e = detail::defaultExecutorSlot().load(std::memory_order_acquire);
+		if(e) return *e;
+
+		static ThreadPool pool;
+		return pool;
+	}
+
+	// Makes executor the default for all graphio operations. It must
+	// outlive them; pass NULL to return to the built-in pool.
+	inline void setDefaultExecutor(Executor *executor) {
+		detail::defaultExecutorSlot().store(executor, std::memory_order_release);
+	}
+
+	// Runs f on executor and returns a future for its result
+	template<typename F>
+	inline std::future<typename std::result_of<F()>::type> runAsync(Executor &executor, F f) {
+		typedef typename std::result_of<F()>::type R;
+		std::shared_ptr<std::packaged_task<R()> > task = std::make_shared<std::packaged_task<R()> >(f);
+		std::future<R> result = task->get_future();
+		executor.submit([task]() { (*task)(); });
+		return result;
+	}
+}
+
+#endif
@@ -0,0 +1,598 @@
+#ifndef GRAPHIO_UTILITY_FILEINPUT_HPP
+#define GRAPHIO_UTILITY_FILEINPUT_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <graphio/GraphIOException.hpp>
+
+// pread and mmap need POSIX, elsewhere files are read with std::ifstream
+#ifdef __unix__
+#define GRAPHIO_HAS_POSIX_IO
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(GRAPHIO_HAS_POSIX_IO) && defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define GRAPHIO_HAS_IO_URING
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#define GRAPHIO_INPUT_BLOCK_SIZE (1 << 20)
+#define GRAPHIO_INPUT_QUEUE_DEPTH 8
+// Files smaller than this are read with pread under INPUT_AUTO
+#define GRAPHIO_INPUT_URING_THRESHOLD (4 << 20)
+
+namespace graphio {
+	enum InputBackend {
+		INPUT_AUTO,
+		INPUT_STREAM,
+		INPUT_PREAD,
+		INPUT_MMAP,
+		INPUT_IO_URING
+	};
+
+	// Backend used when none is given explicitly.
+	// Initialized from the GRAPHIO_INPUT environment variable
+	// ("stream", "pread", "mmap" or "io_uring").
+	inline InputBackend &defaultInputBackend() {
+		static InputBackend backend = []() {
+			const char *env = std::getenv("GRAPHIO_INPUT");
+			if(env == NULL) return INPUT_AUTO;
+			std::string name(env);
+			if(name == "stream") return INPUT_STREAM;
+			if(name == "pread") return INPUT_PREAD;
+			if(name == "mmap") return INPUT_MMAP;
+			if(name == "io_uring") return INPUT_IO_URING;
+			return INPUT_AUTO;
+		}();
+		return backend;
+	}
+
+	namespace detail {
+		class InputSource {
+			public:
+				virtual ~InputSource() { }
+
+				// Returns the next block of the file, or false at end of file
+				virtual bool next(const char *&data, size_t &length) = 0;
+
+				virtual void rewind() = 0;
+		};
+
+		// Portable fallback, and the only backend without POSIX
+		class StreamSource : public InputSource {
+			public:
+				StreamSource(const std::string &filename) :
+					file(filename.c_str(), std::ios::binary), buffer(GRAPHIO_INPUT_BLOCK_SIZE)
+				{
+					if(!file) {
+						throw GraphIOException(std::string("Could not open file: ") + filename);
+					}
+				}
+
+				bool next(const char *&data, size_t &length) {
+					file.read(&buffer[0], buffer.size());
+					if(file.bad()) {
+						throw GraphIOException("Read error");
+					}
+					if(file.gcount() == 0) return false;
+
+					data = &buffer[0];
+					length = file.gcount();
+					return true;
+				}
+
+				void rewind() {
+					file.clear();
+					file.seekg(0);
+				}
+
+			private:
+				std::ifstream file;
+				std::vector<char> buffer;
+		};
+
+#ifdef GRAPHIO_HAS_POSIX_IO
+		class PreadSource : public InputSource {
+			public:
+				PreadSource(int fd) : fd(fd), offset(0), buffer(GRAPHIO_INPUT_BLOCK_SIZE) {
+					posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+				}
+
+				bool next(const char *&data, size_t &length) {
+					ssize_t n;
+					do {
+						n = pread(fd, &buffer[0], buffer.size(), offset);
+					} while(n < 0 && errno == EINTR);
+
+					if(n < 0) {
+						throw GraphIOException(std::string("Read error: ") + std::strerror(errno));
+					}
+					if(n == 0) return false;
+
+					offset += n;
+					data = &buffer[0];
+					length = n;
+					return true;
+				}
+
+				void rewind() {
+					offset = 0;
+				}
+
+			private:
+				int fd;
+				off_t offset;
+				std::vector<char> buffer;
+		};
+
+		class MmapSource : public InputSource {
+			public:
+				MmapSource(int fd, size_t size) : addr(NULL), size(size), done(false) {
+					if(size == 0) return;
+
+					addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+					if(addr == MAP_FAILED) {
+						throw GraphIOException(std::string("Could not map file: ") + std::strerror(errno));
+					}
+					madvise(addr, size, MADV_SEQUENTIAL);
+				}
+
+				~MmapSource() {
+					if(addr != NULL) munmap(addr, size);
+				}
+
+				bool next(const char *&data, size_t &length) {
+					if(done || size == 0) return false;
+
+					data = static_cast<const char*>(addr);
+					length = size;
+					done = true;
+					return true;
+				}
+
+				void rewind() {
+					done = false;
+				}
+
+			private:
+				void *addr;
+				size_t size;
+				bool done;
+		};
+#endif
+
+#ifdef GRAPHIO_HAS_IO_URING
+		// Keeps GRAPHIO_INPUT_QUEUE_DEPTH fixed-buffer reads in flight and
+		// hands completed blocks out in file order.
+		class IOUringSource : public InputSource {
+			public:
+				IOUringSource(int fd, size_t size) :
+					fd(fd), size(size), ring_fd(-1), sq_ptr(MAP_FAILED), cq_ptr(MAP_FAILED),
+					sqes(static_cast<io_uring_sqe*>(MAP_FAILED)), buffers(MAP_FAILED),
+					slots(GRAPHIO_INPUT_QUEUE_DEPTH)
+				{ }
+
+				~IOUringSource() {
+					if(ring_fd >= 0) {
+						// A failed read is dropped here, closing the ring cancels the rest
+						try {
+							drain();
+						} catch(...) { }
+						close(ring_fd);
+					}
+					if(sqes != MAP_FAILED) munmap(sqes, sqes_size);
+					if(cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) munmap(cq_ptr, cq_size);
+					if(sq_ptr != MAP_FAILED) munmap(sq_ptr, sq_size);
+					if(buffers != MAP_FAILED) munmap(buffers, buffers_size);
+				}
+
+				// Sets up the ring. Returns false if io_uring is unavailable.
+				bool init() {
+					io_uring_params p;
+					std::memset(&p, 0, sizeof(p));
+					ring_fd = syscall(__NR_io_uring_setup, GRAPHIO_INPUT_QUEUE_DEPTH, &p);
+					if(ring_fd < 0) return false;
+
+					sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+					cq_size = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+					if(p.features & IORING_FEAT_SINGLE_MMAP) {
+						sq_size = cq_size = std::max(sq_size, cq_size);
+					}
+
+					sq_ptr = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+					if(sq_ptr == MAP_FAILED) return false;
+
+					if(p.features & IORING_FEAT_SINGLE_MMAP) {
+						cq_ptr = sq_ptr;
+					} else {
+						cq_ptr = mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+						if(cq_ptr == MAP_FAILED) return false;
+					}
+
+					sqes_size = p.sq_entries * sizeof(io_uring_sqe);
+					sqes = static_cast<io_uring_sqe*>(mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+					if(sqes == MAP_FAILED) return false;
+
+					char *sq = static_cast<char*>(sq_ptr);
+					char *cq = static_cast<char*>(cq_ptr);
+					sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+					sq_mask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+					sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+					cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+					cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+					cq_mask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+					cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+					// Register one fixed buffer per slot
+					buffers_size = GRAPHIO_INPUT_QUEUE_DEPTH * GRAPHIO_INPUT_BLOCK_SIZE;
+					buffers = mmap(NULL, buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+					if(buffers == MAP_FAILED) return false;
+
+					iovec iov[GRAPHIO_INPUT_QUEUE_DEPTH];
+					for(size_t i = 0; i < slots.size(); ++i) {
+						iov[i].iov_base = static_cast<char*>(buffers) + i * GRAPHIO_INPUT_BLOCK_SIZE;
+						iov[i].iov_len = GRAPHIO_INPUT_BLOCK_SIZE;
+					}
+					if(syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iov, slots.size()) < 0) {
+						return false;
+					}
+
+					rewind();
+					return true;
+				}
+
+				bool next(const char *&data, size_t &length) {
+					// Hand the previously returned buffer back to the ring
+					if(current >= 0) {
+						submit(current, next_offset);
+						current = -1;
+					}
+
+					Slot &slot = slots[head];
+					if(!slot.pending) return false;
+
+					while(!slot.done) {
+						wait();
+					}
+
+					slot.pending = false;
+					current = head;
+					head = (head + 1) % slots.size();
+
+					data = buffer(current);
+					length = slot.length;
+					return length > 0;
+				}
+
+				void rewind() {
+					drain();
+
+					next_offset = 0;
+					head = 0;
+					current = -1;
+					for(size_t i = 0; i < slots.size(); ++i) {
+						slots[i].pending = false;
+						slots[i].done = false;
+					}
+					for(size_t i = 0; i < slots.size(); ++i) {
+						submit(i, next_offset);
+					}
+				}
+
+			private:
+				struct Slot {
+					off_t offset;
+					size_t length;
+					bool pending;
+					bool done;
+				};
+
+				inline char *buffer(size_t i) {
+					return static_cast<char*>(buffers) + i * GRAPHIO_INPUT_BLOCK_SIZE;
+				}
+
+				void submit(size_t i, off_t &offset) {
+					if(offset >= static_cast<off_t>(size)) return;
+
+					Slot &slot = slots[i];
+					slot.offset = offset;
+					slot.length = 0;
+					slot.pending = true;
+					slot.done = false;
+					offset += std::min<size_t>(GRAPHIO_INPUT_BLOCK_SIZE, size - offset);
+
+					enqueue(i);
+				}
+
+				// Queues a read of the remainder of slot i
+				void enqueue(size_t i) {
+					Slot &slot = slots[i];
+					size_t length = std::min<size_t>(GRAPHIO_INPUT_BLOCK_SIZE, size - slot.offset);
+
+					unsigned tail = *sq_tail;
+					unsigned index = tail & sq_mask;
+					io_uring_sqe *sqe = &sqes[index];
+					std::memset(sqe, 0, sizeof(*sqe));
+					sqe->opcode = IORING_OP_READ_FIXED;
+					sqe->fd = fd;
+					sqe->off = slot.offset + slot.length;
+					sqe->addr = reinterpret_cast<unsigned long>(buffer(i) + slot.length);
+					sqe->len = length - slot.length;
+					sqe->buf_index = i;
+					sqe->user_data = i;
+					sq_array[index] = index;
+					__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+					int ret;
+					do {
+						ret = syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, NULL, 0);
+					} while(ret < 0 && errno == EINTR);
+
+					if(ret < 0) {
+						throw GraphIOException(std::string("io_uring submit failed: ") + std::strerror(errno));
+					}
+				}
+
+				// Blocks until at least one completion has been reaped
+				void wait() {
+					unsigned index = *cq_head;
+					while(index == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+						int ret = syscall(__NR_io_uring_enter, ring_fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+						if(ret < 0 && errno != EINTR) {
+							throw GraphIOException(std::string("io_uring wait failed: ") + std::strerror(errno));
+						}
+					}
+
+					while(index != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+						io_uring_cqe *cqe = &cqes[index & cq_mask];
+						Slot &slot = slots[cqe->user_data];
+						int res = cqe->res;
+						index++;
+						__atomic_store_n(cq_head, index, __ATOMIC_RELEASE);
+
+						if(res < 0) {
+							throw GraphIOException(std::string("Read error: ") + std::strerror(-res));
+						}
+
+						slot.length += res;
+						size_t expected = std::min<size_t>(GRAPHIO_INPUT_BLOCK_SIZE, size - slot.offset);
+						if(res > 0 && slot.length < expected) {
+							enqueue(cqe->user_data);
+						} else {
+							slot.done = true;
+						}
+					}
+				}
+
+				void drain() {
+					if(ring_fd < 0 || sqes == MAP_FAILED) return;
+
+					for(size_t i = 0; i < slots.size(); ++i) {
+						while(slots[i].pending && !slots[i].done) {
+							wait();
+						}
+					}
+				}
+
+				int fd;
+				size_t size;
+				int ring_fd;
+
+				void *sq_ptr, *cq_ptr;
+				size_t sq_size, cq_size, sqes_size;
+				unsigned *sq_tail, *sq_array, sq_mask;
+				unsigned *cq_head, *cq_tail, cq_mask;
+				io_uring_sqe *sqes;
+				io_uring_cqe *cqes;
+
+				void *buffers;
+				size_t buffers_size;
+				std::vector<Slot> slots;
+				off_t next_offset;
+				size_t head;
+				int current;
+		};
+#endif
+	}
+
+	// Line oriented file input on top of a selectable block backend.
+	class FileInput {
+		public:
+			FileInput(const std::string &filename, InputBackend backend = defaultInputBackend()) : fd(-1), pos(0), length(0), good(true) {
+#ifdef GRAPHIO_HAS_POSIX_IO
+				if(backend != INPUT_STREAM) open(filename, backend);
+#endif
+				if(!source) {
+					source.reset(new detail::StreamSource(filename));
+				}
+			}
+
+			~FileInput() {
+				source.reset();
+#ifdef GRAPHIO_HAS_POSIX_IO
+				if(fd >= 0) close(fd);
+#endif
+			}
+
+			inline bool getline(std::string &line) {
+				line.clear();
+				while(true) {
+					if(pos == length) {
+						if(!source->next(data, length)) {
+							pos = length = 0;
+							good = line.length() > 0;
+							return good;
+						}
+						pos = 0;
+					}
+
+					const char *begin = data + pos;
+					const char *end = static_cast<const char*>(std::memchr(begin, '\n', length - pos));
+					if(end != NULL) {
+						line.append(begin, end);
+						pos = end - data + 1;
+						return true;
+					}
+
+					line.append(begin, length - pos);
+					pos = length;
+				}
+			}
+
+			inline void rewind() {
+				source->rewind();
+				pos = length = 0;
+				good = true;
+			}
+
+			explicit operator bool() const {
+				return good;
+			}
+
+		private:
+			FileInput(const FileInput&);
+			FileInput &operator=(const FileInput&);
+
+#ifdef GRAPHIO_HAS_POSIX_IO
+			// Reads through pread, mmap or io_uring
+			void open(const std::string &filename, InputBackend backend) {
+				fd = ::open(filename.c_str(), O_RDONLY);
+				if(fd < 0) {
+					throw GraphIOException(std::string("Could not open file: ") + filename);
+				}
+
+				struct stat st;
+				if(fstat(fd, &st) < 0) {
+					int error = errno;
+					close(fd);
+					fd = -1;
+					throw GraphIOException(std::string("Could not stat file: ") + filename + ": " + std::strerror(error));
+				}
+				size_t size = st.st_size;
+
+				try {
+#ifdef GRAPHIO_HAS_IO_URING
+					// Ring setup and buffer registration only pay off on larger files
+					if((backend == INPUT_AUTO && size >= GRAPHIO_INPUT_URING_THRESHOLD) || backend == INPUT_IO_URING) {
+						detail::IOUringSource *ring = new detail::IOUringSource(fd, size);
+						source.reset(ring);
+						if(!ring->init()) source.reset();
+					}
+#endif
+					if(!source && backend == INPUT_MMAP) {
+						source.reset(new detail::MmapSource(fd, size));
+					}
+					if(!source) {
+						source.reset(new detail::PreadSource(fd));
+					}
+				} catch(...) {
+					source.reset();
+					close(fd);
+					fd = -1;
+					throw;
+				}
+			}
+#endif
+
+			int fd;
+			std::unique_ptr<detail::InputSource> source;
+			const char *data;
+			size_t pos, length;
+			bool good;
+	};
+
+	// Read-only view of a whole file, for readers that split their
+	// input between threads.
+	class MappedFile {
+		public:
+			MappedFile(const std::string &filename) : addr(NULL), length(0) {
+#ifdef GRAPHIO_HAS_POSIX_IO
+				int fd = open(filename.c_str(), O_RDONLY);
+				if(fd < 0) {
+					throw GraphIOException(std::string("Could not open file: ") + filename);
+				}
+
+				struct stat st;
+				if(fstat(fd, &st) < 0) {
+					int error = errno;
+					close(fd);
+					throw GraphIOException(std::string("Could not stat file: ") + filename + ": " + std::strerror(error));
+				}
+				length = st.st_size;
+
+				if(length > 0) {
+					addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+					if(addr == MAP_FAILED) {
+						close(fd);
+						throw GraphIOException(std::string("Could not map file: ") + std::strerror(errno));
+					}
+					madvise(addr, length, MADV_WILLNEED);
+				}
+				close(fd);
+#else
+				std::ifstream file(filename.c_str(), std::ios::binary);
+				if(!file) {
+					throw GraphIOException(std::string("Could not open file: ") + filename);
+				}
+				contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+				if(file.bad()) {
+					throw GraphIOException(std::string("Read error: ") + filename);
+				}
+				length = contents.size();
+				if(length > 0) addr = &contents[0];
+#endif
+			}
+
+			~MappedFile() {
+#ifdef GRAPHIO_HAS_POSIX_IO
+				if(addr != NULL) munmap(addr, length);
+#endif
+			}
+
+			inline const char *data() const {
+				return static_cast<const char*>(addr);
+			}
+
+			inline size_t size() const {
+				return length;
+			}
+
+		private:
+			MappedFile(const MappedFile&);
+			MappedFile &operator=(const MappedFile&);
+
+			void *addr;
+			size_t length;
+#ifndef GRAPHIO_HAS_POSIX_IO
+			// Without mmap the file is read into memory
+			std::vector<char> contents;
+#endif
+	};
+
+	// True if filename can be opened for reading
+	inline bool fileExists(const std::string &filename) {
+		std::ifstream file(filename.c_str());
+		return file.is_open();
+	}
+
+	inline FileInput &getline(FileInput &input, std::string &line) {
+		input.getline(line);
+		return input;
+	}
+}
+
+#endif
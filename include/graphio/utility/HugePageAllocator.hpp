@@ -0,0 +1,161 @@
+#ifndef GRAPHIO_UTILITY_HUGEPAGEALLOCATOR_HPP
+#define GRAPHIO_UTILITY_HUGEPAGEALLOCATOR_HPP
+
+#include <new>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <cstddef>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#define GRAPHIO_HUGE_PAGE_SIZE (2 << 20)
+
+namespace graphio {
+	struct HugePageStats {
+		// Bytes currently mapped through the huge page allocator
+		size_t mapped;
+		// Bytes of those backed by explicitly reserved huge pages (MAP_HUGETLB)
+		size_t hugetlb;
+		// Process-wide bytes backed by transparent huge pages
+		size_t transparent;
+	};
+
+	namespace detail {
+		struct HugePageRegistry {
+			std::atomic<size_t> mapped;
+			std::atomic<size_t> hugetlb;
+			std::mutex mutex;
+			std::set<void*> hugetlb_regions;
+
+			HugePageRegistry() : mapped(0), hugetlb(0) { }
+
+			static HugePageRegistry &instance() {
+				static HugePageRegistry registry;
+				return registry;
+			}
+		};
+
+		inline size_t hugePageRound(size_t bytes) {
+			return (bytes + GRAPHIO_HUGE_PAGE_SIZE - 1) & ~size_t(GRAPHIO_HUGE_PAGE_SIZE - 1);
+		}
+
+		inline void *hugePageAllocate(size_t bytes) {
+#ifdef __linux__
+			HugePageRegistry &reg = HugePageRegistry::instance();
+			size_t len = hugePageRound(bytes);
+
+			// Try reserved huge pages first, then fall back to transparent huge pages
+			void *p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if(p != MAP_FAILED) {
+				std::lock_guard<std::mutex> lock(reg.mutex);
+				reg.hugetlb_regions.insert(p);
+				reg.hugetlb += len;
+				reg.mapped += len;
+				return p;
+			}
+
+			p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if(p == MAP_FAILED) {
+				throw std::bad_alloc();
+			}
+#ifdef MADV_HUGEPAGE
+			madvise(p, len, MADV_HUGEPAGE);
+#endif
+			reg.mapped += len;
+			return p;
+#else
+			return ::operator new(bytes);
+#endif
+		}
+
+		inline void hugePageDeallocate(void *p, size_t bytes) {
+#ifdef __linux__
+			HugePageRegistry &reg = HugePageRegistry::instance();
+			size_t len = hugePageRound(bytes);
+			{
+				std::lock_guard<std::mutex> lock(reg.mutex);
+				if(reg.hugetlb_regions.erase(p) > 0) {
+					reg.hugetlb -= len;
+				}
+			}
+			reg.mapped -= len;
+			munmap(p, len);
+#else
+			::operator delete(p);
+#endif
+		}
+	}
+
+	inline HugePageStats hugePageStats() {
+		detail::HugePageRegistry &reg = detail::HugePageRegistry::instance();
+		HugePageStats stats;
+		stats.mapped = reg.mapped;
+		stats.hugetlb = reg.hugetlb;
+		stats.transparent = 0;
+
+		std::ifstream file("/proc/self/smaps_rollup");
+		std::string key;
+		size_t value;
+		while(file >> key >> value) {
+			if(key == "AnonHugePages:") {
+				stats.transparent = value * 1024;
+				break;
+			}
+			file.ignore(256, '\n');
+		}
+
+		return stats;
+	}
+
+	// Allocator placing large arrays in huge page backed memory.
+	// Allocations smaller than a huge page use the regular heap.
+	template<typename T>
+	class HugePageAllocator {
+		public:
+			typedef T value_type;
+
+			HugePageAllocator() { }
+
+			template<typename U>
+			HugePageAllocator(const HugePageAllocator<U> &) { }
+
+			inline size_t max_size() const {
+				return size_t(-1) / sizeof(T);
+			}
+
+			inline T *allocate(size_t n) {
+				// Keep n * sizeof(T) from wrapping around
+				if(n > max_size()) throw std::bad_alloc();
+				size_t bytes = n * sizeof(T);
+				if(bytes < GRAPHIO_HUGE_PAGE_SIZE) {
+					return static_cast<T*>(::operator new(bytes));
+				}
+				return static_cast<T*>(detail::hugePageAllocate(bytes));
+			}
+
+			inline void deallocate(T *p, size_t n) {
+				size_t bytes = n * sizeof(T);
+				if(bytes < GRAPHIO_HUGE_PAGE_SIZE) {
+					::operator delete(p);
+				} else {
+					detail::hugePageDeallocate(p, bytes);
+				}
+			}
+	};
+
+	template<typename T, typename U>
+	inline bool operator==(const HugePageAllocator<T> &, const HugePageAllocator<U> &) {
+		return true;
+	}
+
+	template<typename T, typename U>
+	inline bool operator!=(const HugePageAllocator<T> &, const HugePageAllocator<U> &) {
+		return false;
+	}
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef GRAPHIO_UTILITY_LABELSIDECAR_HPP
+#define GRAPHIO_UTILITY_LABELSIDECAR_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <ostream>
+#include <cstdio>
+#include <functional>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/utility/FileInput.hpp>
+
+// Labels of formats that only store vertex numbers are kept next to the
+// graph file in FILE.labels, one vertex label per line in vertex order,
+// and FILE.elabels, one edge label per line in the order the format
+// lists its edges. Backslashes, newlines and carriage returns are
+// escaped as \\, \n and \r. An empty FILE.directed marks the graph
+// as directed, which the formats themselves do not record.
+namespace graphio {
+	inline std::string vertexLabelSidecar(const std::string &filename) {
+		return filename + ".labels";
+	}
+
+	inline std::string edgeLabelSidecar(const std::string &filename) {
+		return filename + ".elabels";
+	}
+
+	inline std::string directedSidecar(const std::string &filename) {
+		return filename + ".directed";
+	}
+
+	namespace detail {
+		inline void writeSidecarLine(std::string &buf, const std::string &s) {
+			for(size_t i = 0; i < s.size(); ++i) {
+				switch(s[i]) {
+					case '\\': buf += "\\\\"; break;
+					case '\n': buf += "\\n"; break;
+					case '\r': buf += "\\r"; break;
+					default: buf += s[i]; break;
+				}
+			}
+			buf += '\n';
+		}
+
+		inline void readSidecarLine(const char *p, const char *end, std::string &s) {
+			s.clear();
+			for(; p < end; ++p) {
+				if(*p == '\\' && p + 1 < end) {
+					++p;
+					s += *p == 'n' ? '\n' : *p == 'r' ? '\r' : *p;
+				} else {
+					s += *p;
+				}
+			}
+		}
+	}
+
+	// Writes labels, given through get(i) for i in [0, n), to out
+	template<typename F>
+	inline void writeLabelSidecar(std::ostream &out, size_t n, F get) {
+		std::string buf;
+		for(size_t i = 0; i < n; ++i) {
+			detail::writeSidecarLine(buf, get(i));
+			if(buf.size() >= GRAPHIO_INPUT_BLOCK_SIZE) {
+				out.write(buf.data(), buf.size());
+				buf.clear();
+			}
+		}
+		out.write(buf.data(), buf.size());
+	}
+
+	template<typename F>
+	inline void writeLabelSidecar(const std::string &filename, size_t n, F get) {
+		std::ofstream file(filename, std::ios::binary);
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not open file: ") + filename);
+		}
+
+		writeLabelSidecar(file, n, get);
+
+		if(!file.good()) {
+			throw GraphIOException(std::string("Could not write file: ") + filename);
+		}
+	}
+
+	// Destination of the sidecars a writer keeps next to a graph file
+	class SidecarOutput {
+		public:
+			virtual ~SidecarOutput() { }
+
+			// Writes the sidecar filename through write(out)
+			virtual void write(const std::string &filename, const std::function<void(std::ostream&)> &write) = 0;
+
+			// Removes a sidecar an earlier write may have left
+			virtual void remove(const std::string &filename) = 0;
+	};
+
+	// Writes sidecars straight to their files
+	class SidecarFiles : public SidecarOutput {
+		public:
+			void write(const std::string &filename, const std::function<void(std::ostream&)> &write) {
+				std::ofstream file(filename, std::ios::binary);
+				if(!file.good()) {
+					throw GraphIOException(std::string("Could not open file: ") + filename);
+				}
+
+				write(file);
+				file.close();
+				if(file.fail()) {
+					throw GraphIOException(std::string("Could not write file: ") + filename);
+				}
+			}
+
+			void remove(const std::string &filename) {
+				std::remove(filename.c_str());
+			}
+	};
+
+	// Reads a sidecar written by writeLabelSidecar(). Returns false,
+	// leaving labels empty, if the file does not exist.
+	inline bool readLabelSidecar(const std::string &filename, std::vector<std::string> &labels) {
+		labels.clear();
+		if(!fileExists(filename)) return false;
+
+		MappedFile file(filename);
+		const char *p = file.data(), *end = p + file.size();
+		while(p < end) {
+			const char *nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+			if(nl == NULL) nl = end;
+			labels.push_back(std::string());
+			detail::readSidecarLine(p, nl, labels.back());
+			p = nl + 1;
+		}
+		return true;
+	}
+}
+
+#endif
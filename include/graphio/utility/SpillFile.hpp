@@ -0,0 +1,157 @@
+#ifndef GRAPHIO_UTILITY_SPILLFILE_HPP
+#define GRAPHIO_UTILITY_SPILLFILE_HPP
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <boost/utility/string_ref.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/utility/FileInput.hpp>
+
+namespace graphio {
+	// Directory for temporary files: $TMPDIR, or /tmp if unset
+	inline std::string spillDirectory() {
+		const char *env = std::getenv("TMPDIR");
+		return env != NULL && *env != '\0' ? env : "/tmp";
+	}
+
+	// Temporary file written once and then read back sequentially, any
+	// number of times. It is unlinked as soon as it is created, so it goes
+	// away when closed, even if the process dies.
+	class SpillFile {
+		public:
+			SpillFile(const std::string &directory = spillDirectory(), size_t block = GRAPHIO_INPUT_BLOCK_SIZE)
+			: buffer(block), pos(0), fill(0), offset(0), written(0), reading(false) {
+				std::string path = directory + "/graphio-spill-XXXXXX";
+				fd = mkstemp(&path[0]);
+				if(fd < 0) {
+					throw GraphIOException("Could not create temporary file in " + directory + ": " + std::strerror(errno));
+				}
+				unlink(path.c_str());
+			}
+
+			~SpillFile() {
+				close(fd);
+			}
+
+			inline void write(const void *p, size_t length) {
+				const char *bytes = static_cast<const char*>(p);
+				while(length > 0) {
+					if(pos == buffer.size()) flush();
+					size_t n = std::min(length, buffer.size() - pos);
+					std::memcpy(&buffer[pos], bytes, n);
+					pos += n;
+					bytes += n;
+					length -= n;
+				}
+			}
+
+			template<typename T>
+			inline void write(const T &value) {
+				write(&value, sizeof(T));
+			}
+
+			// Writes s with a uint32 length prefix
+			inline void writeString(const boost::string_ref &s) {
+				write(uint32_t(s.size()));
+				write(s.data(), s.size());
+			}
+
+			// Finishes writing, or starts reading from the beginning again
+			void rewind() {
+				if(!reading) {
+					flush();
+					reading = true;
+				}
+				pos = fill = 0;
+				offset = 0;
+			}
+
+			// Reads length bytes. Returns false at the end of the file.
+			inline bool read(void *p, size_t length) {
+				char *bytes = static_cast<char*>(p);
+				size_t wanted = length;
+				while(length > 0) {
+					if(pos == fill && !refill()) {
+						if(length == wanted) return false;
+						throw GraphIOException("Truncated temporary file");
+					}
+					size_t n = std::min(length, fill - pos);
+					std::memcpy(bytes, &buffer[pos], n);
+					pos += n;
+					bytes += n;
+					length -= n;
+				}
+				return true;
+			}
+
+			template<typename T>
+			inline bool read(T &value) {
+				return read(&value, sizeof(T));
+			}
+
+			inline bool readString(std::string &s) {
+				uint32_t length;
+				if(!read(length)) return false;
+				s.resize(length);
+				if(length > 0 && !read(&s[0], length)) {
+					throw GraphIOException("Truncated temporary file");
+				}
+				return true;
+			}
+
+			// Bytes written
+			inline uint64_t size() const {
+				return written + (reading ? 0 : pos);
+			}
+
+		private:
+			SpillFile(const SpillFile&);
+			SpillFile &operator=(const SpillFile&);
+
+			void flush() {
+				const char *p = buffer.data();
+				size_t length = pos;
+				while(length > 0) {
+					ssize_t n = pwrite(fd, p, length, written);
+					if(n < 0 && errno == EINTR) continue;
+					if(n < 0) {
+						throw GraphIOException(std::string("Could not write temporary file: ") + std::strerror(errno));
+					}
+					p += n;
+					length -= n;
+					written += n;
+				}
+				pos = 0;
+			}
+
+			bool refill() {
+				ssize_t n;
+				do {
+					n = pread(fd, buffer.data(), buffer.size(), offset);
+				} while(n < 0 && errno == EINTR);
+
+				if(n < 0) {
+					throw GraphIOException(std::string("Could not read temporary file: ") + std::strerror(errno));
+				}
+				offset += n;
+				pos = 0;
+				fill = n;
+				return n > 0;
+			}
+
+			int fd;
+			std::vector<char> buffer;
+			size_t pos, fill;
+			off_t offset;
+			uint64_t written;
+			bool reading;
+	};
+}
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef GRAPHIO_UTILITY_THROTTLEDOUTPUT_HPP
+#define GRAPHIO_UTILITY_THROTTLEDOUTPUT_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <streambuf>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#endif
+#include <graphio/GraphIOException.hpp>
+
+namespace graphio {
+	// Moves the calling thread to the idle I/O scheduling class and
+	// lowers its CPU priority. Returns false where unsupported.
+	inline bool lowerThreadPriority() {
+#ifdef __linux__
+		const int IOPRIO_WHO_PROCESS = 1;
+		const int IOPRIO_CLASS_IDLE = 3;
+		const int IOPRIO_CLASS_SHIFT = 13;
+
+		pid_t tid = syscall(SYS_gettid);
+		setpriority(PRIO_PROCESS, tid, 19);
+		return syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) == 0;
+#else
+		return false;
+#endif
+	}
+
+	// Output file buffer that writes at most bandwidth bytes per second
+	// (0 for no limit), sleeping between chunks when ahead of schedule.
+	class ThrottledFileBuffer : public std::streambuf {
+		public:
+			ThrottledFileBuffer(const std::string &filename, size_t bandwidth, size_t chunk = 1 << 20)
+			: bandwidth(bandwidth), written(0), buffer(chunk) {
+				fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+				if(fd < 0) {
+					throw GraphIOException(std::string("Could not open file: ") + filename);
+				}
+				start = std::chrono::steady_clock::now();
+				setp(buffer.data(), buffer.data() + buffer.size());
+			}
+
+			~ThrottledFileBuffer() {
+				if(fd >= 0) {
+					flush();
+					::close(fd);
+				}
+			}
+
+			// Flushes, syncs to disk and closes the file. Returns false on error.
+			bool close() {
+				bool ok = flush() && fsync(fd) == 0;
+				ok = (::close(fd) == 0) && ok;
+				fd = -1;
+				return ok;
+			}
+
+			inline size_t bytesWritten() const {
+				return written;
+			}
+
+		protected:
+			int_type overflow(int_type c) {
+				if(!flush()) return traits_type::eof();
+				if(!traits_type::eq_int_type(c, traits_type::eof())) {
+					*pptr() = traits_type::to_char_type(c);
+					pbump(1);
+				}
+				return traits_type::not_eof(c);
+			}
+
+			int sync() {
+				return flush() ? 0 : -1;
+			}
+
+		private:
+			bool flush() {
+				const char *p = pbase();
+				size_t len = pptr() - pbase();
+				while(len > 0) {
+					ssize_t n = ::write(fd, p, len);
+					if(n < 0) {
+						if(errno == EINTR) continue;
+						return false;
+					}
+					p += n;
+					len -= n;
+					written += n;
+				}
+				setp(buffer.data(), buffer.data() + buffer.size());
+				throttle();
+				return true;
+			}
+
+			void throttle() {
+				if(bandwidth == 0) return;
+				auto due = start + std::chrono::microseconds(written * 1000000 / bandwidth);
+				if(due > std::chrono::steady_clock::now()) {
+					std::this_thread::sleep_until(due);
+				}
+			}
+
+			int fd;
+			size_t bandwidth;
+			size_t written;
+			std::vector<char> buffer;
+			std::chrono::steady_clock::time_point start;
+	};
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef GRAPHIO_UTILITY_VERTEXNUMBERING_HPP
+#define GRAPHIO_UTILITY_VERTEXNUMBERING_HPP
+
+#include <vector>
+#include <algorithm>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+
+namespace graphio {
+	// Numbers the vertices of g 0..n-1 in vertex iteration order.
+	// Works with any vertex index map, so filtered graphs, subgraphs and
+	// graphs with sparse indices are written with contiguous ids.
+	template<class G, class IndexMap>
+	class VertexNumbering {
+		public:
+			typedef typename boost::graph_traits<G>::vertex_descriptor Vertex;
+
+			VertexNumbering(const G &g, IndexMap index) : index(index), count(0) {
+				size_t bound = 0;
+				for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+					bound = std::max<size_t>(bound, get(index, *vp.first) + 1);
+				}
+
+				numbers.resize(bound);
+				for(auto vp = vertices(g); vp.first != vp.second; ++vp.first) {
+					numbers[get(index, *vp.first)] = count++;
+				}
+			}
+
+			inline size_t operator()(const Vertex &v) const {
+				return numbers[get(index, v)];
+			}
+
+			inline size_t size() const {
+				return count;
+			}
+
+		private:
+			IndexMap index;
+			std::vector<size_t> numbers;
+			size_t count;
+	};
+
+	template<class G, class IndexMap>
+	inline VertexNumbering<G, IndexMap> numberVertices(const G &g, IndexMap index) {
+		return VertexNumbering<G, IndexMap>(g, index);
+	}
+}
+
+#endif
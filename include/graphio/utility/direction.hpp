@@ -0,0 +1,65 @@
+#ifndef GRAPHIO_UTILITY_DIRECTION_HPP
+#define GRAPHIO_UTILITY_DIRECTION_HPP
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <boost/graph/graph_traits.hpp>
+
+namespace graphio {
+	// Whether writers emit the out-edge from vertex number i to j.
+	// Undirected graphs list each edge at both endpoints, so it is
+	// written from the lower one; directed graphs list it once.
+	template<class G>
+	inline bool writesOutEdge(const G &g, size_t i, size_t j) {
+		return boost::is_directed(g) || i <= j;
+	}
+
+	// Selects the out-edges writers emit, by writesOutEdge() and
+	// counting each undirected self-loop once. Adjacency lists with
+	// vector or list edges hold such a loop twice at its vertex, both
+	// copies with the same properties; the first is written, as freeze()
+	// keeps it. Out-edges are passed vertex by vertex, once per pass.
+	template<class G>
+	class OutEdgeFilter {
+		public:
+			OutEdgeFilter(const G &g) : g(g), vertex(~size_t(0)) { }
+
+			template<class Edge>
+			inline bool operator()(size_t i, size_t j, const Edge &e) {
+				if(!writesOutEdge(g, i, j)) return false;
+				if(i != j || boost::is_directed(g)) return true;
+
+				if(i != vertex) {
+					vertex = i;
+					loops.clear();
+				}
+				const void *p = &g[e];
+				if(std::find(loops.begin(), loops.end(), p) != loops.end()) return false;
+				loops.push_back(p);
+				return true;
+			}
+
+		private:
+			const G &g;
+			size_t vertex;
+			std::vector<const void*> loops;
+	};
+
+	// Completes an edge e read from a file with the given orientation.
+	// An undirected edge read into a directed graph is added in both
+	// directions, the reverse with a copy of e's properties.
+	template<class G, class Edge>
+	inline void mirrorUndirectedEdge(G &g, const Edge &e, bool directed) {
+		if(directed || !boost::is_directed(g)) return;
+
+		auto u = source(e, g), v = target(e, g);
+		if(u == v) return;
+
+		auto props = g[e];
+		auto r = add_edge(v, u, g);
+		g[r.first] = props;
+	}
+}
+
+#endif
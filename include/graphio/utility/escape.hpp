@@ -0,0 +1,217 @@
+#ifndef GRAPHIO_UTILITY_ESCAPE_HPP
+#define GRAPHIO_UTILITY_ESCAPE_HPP
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <ostream>
+#include <graphio/GraphIOException.hpp>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace graphio {
+	// Finds characters that need escaping: control characters and up to
+	// eight others. Scans 16 bytes at a time where SSE2 is available, so
+	// clean strings cost little more than copying them.
+	class EscapeScanner {
+		public:
+			EscapeScanner(const char *special) : count(std::strlen(special)) {
+				std::memset(table, 0, sizeof(table));
+				for(int c = 0; c < 0x20; ++c) table[c] = true;
+				table[0x7F] = true;
+				for(size_t i = 0; i < count; ++i) {
+					table[static_cast<unsigned char>(special[i])] = true;
+					chars[i] = special[i];
+				}
+			}
+
+			// Returns the first character in [p, end) that needs escaping, or end
+			inline const char *find(const char *p, const char *end) const {
+#ifdef __SSE2__
+				if(end - p >= 16) {
+					__m128i vec[8];
+					for(size_t i = 0; i < count; ++i) vec[i] = _mm_set1_epi8(chars[i]);
+					const __m128i control = _mm_set1_epi8(0x1F);
+					const __m128i del = _mm_set1_epi8(0x7F);
+
+					for(; end - p >= 16; p += 16) {
+						__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+						__m128i hit = _mm_or_si128(
+							_mm_cmpeq_epi8(_mm_min_epu8(x, control), x),
+							_mm_cmpeq_epi8(x, del)
+						);
+						for(size_t i = 0; i < count; ++i) {
+							hit = _mm_or_si128(hit, _mm_cmpeq_epi8(x, vec[i]));
+						}
+						int mask = _mm_movemask_epi8(hit);
+						if(mask != 0) return p + __builtin_ctz(mask);
+					}
+				}
+#endif
+				for(; p < end; ++p) {
+					if(table[static_cast<unsigned char>(*p)]) return p;
+				}
+				return end;
+			}
+
+			inline bool needed(const std::string &s) const {
+				return find(s.data(), s.data() + s.size()) != s.data() + s.size();
+			}
+
+		private:
+			size_t count;
+			char chars[8];
+			bool table[256];
+	};
+
+	inline const EscapeScanner &xmlEscapes() {
+		static const EscapeScanner scanner("&<>\"'");
+		return scanner;
+	}
+
+	inline const EscapeScanner &tabEscapes() {
+		static const EscapeScanner scanner("\t\"\\");
+		return scanner;
+	}
+
+	inline const EscapeScanner &sifEscapes() {
+		static const EscapeScanner scanner(" \t\"\\");
+		return scanner;
+	}
+
+	inline const EscapeScanner &jsonEscapes() {
+		static const EscapeScanner scanner("\"\\");
+		return scanner;
+	}
+
+	inline const EscapeScanner &csvEscapes() {
+		static const EscapeScanner scanner(",\"");
+		return scanner;
+	}
+
+	// Appends the code point c to s in UTF-8, for readers
+	// decoding character references and \u escapes
+	inline void appendUTF8(std::string &s, unsigned long c) {
+		if(c < 0x80) {
+			s += char(c);
+		} else if(c < 0x800) {
+			s += char(0xC0 | (c >> 6));
+			s += char(0x80 | (c & 0x3F));
+		} else if(c < 0x10000) {
+			s += char(0xE0 | (c >> 12));
+			s += char(0x80 | ((c >> 6) & 0x3F));
+			s += char(0x80 | (c & 0x3F));
+		} else {
+			s += char(0xF0 | (c >> 18));
+			s += char(0x80 | ((c >> 12) & 0x3F));
+			s += char(0x80 | ((c >> 6) & 0x3F));
+			s += char(0x80 | (c & 0x3F));
+		}
+	}
+
+	// Writes s escaped for use in XML text or a quoted attribute value.
+	// Throws for control characters XML 1.0 does not allow.
+	inline void writeXMLEscaped(std::ostream &out, const std::string &s) {
+		const EscapeScanner &scanner = xmlEscapes();
+		const char *p = s.data(), *end = p + s.size();
+		while(true) {
+			const char *q = scanner.find(p, end);
+			out.write(p, q - p);
+			if(q == end) return;
+
+			switch(*q) {
+				case '&': out << "&amp;"; break;
+				case '<': out << "&lt;"; break;
+				case '>': out << "&gt;"; break;
+				case '"': out << "&quot;"; break;
+				case '\'': out << "&apos;"; break;
+				// Keep whitespace from being normalized away in attributes
+				case '\t': out << "&#9;"; break;
+				case '\n': out << "&#10;"; break;
+				case '\r': out << "&#13;"; break;
+				// DEL is allowed, only C0 controls are not
+				case '\x7f': out.put(*q); break;
+				default: {
+					static const char hex[] = "0123456789abcdef";
+					unsigned char c = *q;
+					throw GraphIOException(std::string("XML cannot hold control character 0x") + hex[c >> 4] + hex[c & 0xf]);
+				}
+			}
+			p = q + 1;
+		}
+	}
+
+	// Writes s escaped for use inside a JSON string
+	inline void writeJSONEscaped(std::ostream &out, const std::string &s) {
+		static const char hex[] = "0123456789abcdef";
+		const EscapeScanner &scanner = jsonEscapes();
+		const char *p = s.data(), *end = p + s.size();
+		while(true) {
+			const char *q = scanner.find(p, end);
+			out.write(p, q - p);
+			if(q == end) return;
+
+			switch(*q) {
+				case '"': out << "\\\""; break;
+				case '\\': out << "\\\\"; break;
+				case '\n': out << "\\n"; break;
+				case '\r': out << "\\r"; break;
+				case '\t': out << "\\t"; break;
+				default: out << "\\u00" << hex[(*q >> 4) & 0xF] << hex[*q & 0xF]; break;
+			}
+			p = q + 1;
+		}
+	}
+
+	// Writes s as a field of a delimited line. Fields holding a character
+	// found by scanner are quoted the way escaped_split() reads them back.
+	inline void writeField(std::ostream &out, const std::string &s, const EscapeScanner &scanner) {
+		const char *p = s.data(), *end = p + s.size();
+		const char *q = scanner.find(p, end);
+		if(q == end) {
+			out.write(p, s.size());
+			return;
+		}
+
+		out << '"';
+		while(true) {
+			out.write(p, q - p);
+			if(q == end) break;
+
+			switch(*q) {
+				case '"': out << "\\\""; break;
+				case '\\': out << "\\\\"; break;
+				case '\n': out << "\\n"; break;
+				default: out << *q; break;
+			}
+			p = q + 1;
+			q = scanner.find(p, end);
+		}
+		out << '"';
+	}
+
+	// Writes s as a CSV field, quoted with doubled quotes as in RFC 4180
+	// when it holds a comma, a quote or a control character
+	inline void writeCSVField(std::ostream &out, const std::string &s) {
+		const EscapeScanner &scanner = csvEscapes();
+		const char *p = s.data(), *end = p + s.size();
+		const char *q = scanner.find(p, end);
+		if(q == end) {
+			out.write(p, s.size());
+			return;
+		}
+
+		out << '"';
+		while(true) {
+			q = std::find(p, end, '"');
+			out.write(p, q - p);
+			if(q == end) break;
+			out << "\"\"";
+			p = q + 1;
+		}
+		out << '"';
+	}
+}
+
+#endif
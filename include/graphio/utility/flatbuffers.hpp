@@ -0,0 +1,239 @@
+#ifndef GRAPHIO_UTILITY_FLATBUFFERS_HPP
+#define GRAPHIO_UTILITY_FLATBUFFERS_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <graphio/GraphIOException.hpp>
+
+// Minimal FlatBuffers encoding and decoding, enough for the small
+// metadata tables of binary formats. Little endian hosts only.
+namespace graphio {
+	namespace fb {
+		// Builds a buffer back to front like the reference implementation,
+		// so children are created before the tables referring to them.
+		// Refs are positions measured from the end of the buffer.
+		class Builder {
+			public:
+				typedef uint32_t Ref;
+
+				Builder() : table_start(0) { }
+
+				inline size_t size() const {
+					return data.size();
+				}
+
+				// Pads so that extra more bytes end on an alignment boundary
+				inline void align(size_t alignment, size_t extra = 0) {
+					size_t pad = (alignment - (data.size() + extra) % alignment) % alignment;
+					data.insert(data.begin(), pad, 0);
+				}
+
+				inline void prepend(const void *p, size_t length) {
+					const uint8_t *bytes = static_cast<const uint8_t*>(p);
+					data.insert(data.begin(), bytes, bytes + length);
+				}
+
+				template<typename T>
+				inline void prependScalar(T value) {
+					align(sizeof(T));
+					prepend(&value, sizeof(T));
+				}
+
+				Ref createString(const std::string &s) {
+					align(4, s.size() + 1);
+					data.insert(data.begin(), 0);
+					prepend(s.data(), s.size());
+					prependScalar<uint32_t>(s.size());
+					return size();
+				}
+
+				// Vector of structs of elem bytes each, aligned to alignment
+				Ref createStructVector(const void *p, size_t count, size_t elem, size_t alignment) {
+					align(alignment < 4 ? 4 : alignment, count * elem);
+					prepend(p, count * elem);
+					prependScalar<uint32_t>(count);
+					return size();
+				}
+
+				Ref createOffsetVector(const std::vector<Ref> &refs) {
+					align(4, refs.size() * 4);
+					for(size_t i = refs.size(); i > 0; --i) {
+						uint32_t offset = size() + 4 - refs[i-1];
+						prepend(&offset, 4);
+					}
+					prependScalar<uint32_t>(refs.size());
+					return size();
+				}
+
+				inline void startTable() {
+					fields.clear();
+					table_start = size();
+				}
+
+				template<typename T>
+				inline void addScalar(uint16_t field, T value) {
+					prependScalar(value);
+					fields.push_back(std::make_pair(field, size()));
+				}
+
+				inline void addOffset(uint16_t field, Ref ref) {
+					align(4);
+					uint32_t offset = size() + 4 - ref;
+					prepend(&offset, 4);
+					fields.push_back(std::make_pair(field, size()));
+				}
+
+				Ref endTable() {
+					prependScalar<int32_t>(0);
+					Ref table = size();
+
+					uint16_t count = 0;
+					for(size_t i = 0; i < fields.size(); ++i) {
+						count = std::max<uint16_t>(count, fields[i].first + 1);
+					}
+					std::vector<uint16_t> vtable(2 + count, 0);
+					vtable[0] = vtable.size() * 2;
+					vtable[1] = table - table_start;
+					for(size_t i = 0; i < fields.size(); ++i) {
+						vtable[2 + fields[i].first] = table - fields[i].second;
+					}
+					prepend(vtable.data(), vtable.size() * 2);
+
+					// The vtable directly precedes the table
+					int32_t soffset = size() - table;
+					std::memcpy(&data[size() - table], &soffset, 4);
+					return table;
+				}
+
+				// Finishes the buffer with root as its root table. The
+				// result is a multiple of 8 bytes long.
+				const std::vector<uint8_t> &finish(Ref root) {
+					align(8, 4);
+					uint32_t offset = size() + 4 - root;
+					prepend(&offset, 4);
+					return data;
+				}
+
+			private:
+				std::vector<uint8_t> data;
+				std::vector<std::pair<uint16_t, Ref> > fields;
+				size_t table_start;
+		};
+
+		// Read-only view of a table in a buffer. Offsets are checked
+		// against the buffer bounds, so corrupt input throws.
+		class Table {
+			public:
+				Table() : base(NULL), end(NULL), table(NULL) { }
+
+				Table(const uint8_t *base, const uint8_t *end, const uint8_t *table)
+				: base(base), end(end), table(table) {
+					check(table, 4);
+					int32_t soffset = read<int32_t>(table);
+					vtable = table - soffset;
+					check(vtable, 4);
+					vtable_size = read<uint16_t>(vtable);
+					check(vtable, vtable_size);
+				}
+
+				// Root table of the buffer [p, p + length)
+				static Table root(const uint8_t *p, size_t length) {
+					if(length < 4) throw GraphIOException("FlatBuffers: Truncated buffer");
+					return Table(p, p + length, p + read<uint32_t>(p));
+				}
+
+				inline bool valid() const {
+					return table != NULL;
+				}
+
+				inline bool has(uint16_t field) const {
+					return fieldOffset(field) != 0;
+				}
+
+				template<typename T>
+				inline T scalar(uint16_t field, T def = T()) const {
+					uint16_t offset = fieldOffset(field);
+					if(offset == 0) return def;
+					check(table + offset, sizeof(T));
+					return read<T>(table + offset);
+				}
+
+				inline Table child(uint16_t field) const {
+					const uint8_t *p = target(field);
+					return p == NULL ? Table() : Table(base, end, p);
+				}
+
+				inline std::string string(uint16_t field) const {
+					const uint8_t *p = target(field);
+					if(p == NULL) return std::string();
+					uint32_t length = vectorLength(p, 1);
+					return std::string(reinterpret_cast<const char*>(p + 4), length);
+				}
+
+				// Number of elements of a vector field, 0 if absent
+				inline size_t vectorSize(uint16_t field, size_t elem) const {
+					const uint8_t *p = target(field);
+					return p == NULL ? 0 : vectorLength(p, elem);
+				}
+
+				// Pointer to element i of a vector of structs
+				inline const uint8_t *structAt(uint16_t field, size_t elem, size_t i) const {
+					const uint8_t *p = target(field);
+					if(p == NULL || i >= vectorLength(p, elem)) throw GraphIOException("FlatBuffers: Index out of range");
+					return p + 4 + i * elem;
+				}
+
+				// Element i of a vector of tables
+				inline Table tableAt(uint16_t field, size_t i) const {
+					const uint8_t *p = target(field);
+					if(p == NULL || i >= vectorLength(p, 4)) throw GraphIOException("FlatBuffers: Index out of range");
+					const uint8_t *q = p + 4 + i * 4;
+					return Table(base, end, q + read<uint32_t>(q));
+				}
+
+				template<typename T>
+				static inline T read(const uint8_t *p) {
+					T value;
+					std::memcpy(&value, p, sizeof(T));
+					return value;
+				}
+
+			private:
+				inline void check(const uint8_t *p, size_t length) const {
+					if(p < base || p > end || size_t(end - p) < length) {
+						throw GraphIOException("FlatBuffers: Offset out of bounds");
+					}
+				}
+
+				inline uint16_t fieldOffset(uint16_t field) const {
+					if(table == NULL || 4u + 2u * field >= vtable_size) return 0;
+					return read<uint16_t>(vtable + 4 + 2 * field);
+				}
+
+				inline const uint8_t *target(uint16_t field) const {
+					uint16_t offset = fieldOffset(field);
+					if(offset == 0) return NULL;
+					const uint8_t *p = table + offset;
+					check(p, 4);
+					p += read<uint32_t>(p);
+					check(p, 4);
+					return p;
+				}
+
+				inline uint32_t vectorLength(const uint8_t *p, size_t elem) const {
+					uint32_t length = read<uint32_t>(p);
+					check(p + 4, size_t(length) * elem);
+					return length;
+				}
+
+				const uint8_t *base, *end, *table, *vtable;
+				uint16_t vtable_size;
+		};
+	}
+}
+
+#endif
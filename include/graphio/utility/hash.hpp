@@ -0,0 +1,17 @@
+#ifndef GRAPHIO_UTILITY_HASH_HPP
+#define GRAPHIO_UTILITY_HASH_HPP
+
+#include <boost/functional/hash.hpp>
+#include <boost/utility/string_ref.hpp>
+
+namespace graphio {
+	namespace detail {
+		struct StringRefHash {
+			inline size_t operator()(const boost::string_ref &s) const {
+				return boost::hash_range(s.begin(), s.end());
+			}
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef GRAPHIO_UTILITY_JSON_HPP
+#define GRAPHIO_UTILITY_JSON_HPP
+
+#include <string>
+#include <deque>
+#include <cstring>
+#include <cstdlib>
+#include <boost/utility/string_ref.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/utility/escape.hpp>
+
+// Minimal JSON scanning over an in-memory buffer, enough to walk the
+// objects and arrays of graph formats without building a document.
+// Strings are found with EscapeScanner, so only strings holding escapes
+// are copied.
+namespace graphio {
+	namespace json {
+		inline bool isSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+		}
+
+		inline const char *skipSpace(const char *p, const char *end) {
+			while(p < end && isSpace(*p)) p++;
+			return p;
+		}
+
+		// Skips whitespace and the character c, which must follow
+		inline const char *expect(const char *p, const char *end, char c) {
+			p = skipSpace(p, end);
+			if(p >= end || *p != c) {
+				throw GraphIOException(std::string("JSON: Expected ") + c);
+			}
+			return p + 1;
+		}
+
+		inline const EscapeScanner &stringScanner() {
+			static const EscapeScanner scanner("\"\\");
+			return scanner;
+		}
+
+		// Whether s matches the JSON number grammar,
+		// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+		inline bool isNumber(const std::string &s) {
+			const char *p = s.c_str();
+			auto digits = [&p]() {
+				const char *start = p;
+				while(*p >= '0' && *p <= '9') p++;
+				return p > start;
+			};
+
+			if(*p == '-') p++;
+			if(*p == '0') p++;
+			else if(!digits()) return false;
+			if(*p == '.') {
+				p++;
+				if(!digits()) return false;
+			}
+			if(*p == 'e' || *p == 'E') {
+				p++;
+				if(*p == '+' || *p == '-') p++;
+				if(!digits()) return false;
+			}
+			return p == s.c_str() + s.size();
+		}
+
+		inline unsigned long hex4(const char *p, const char *end) {
+			if(end - p < 4) throw GraphIOException("JSON: Truncated \\u escape");
+			char buf[5] = { p[0], p[1], p[2], p[3], 0 };
+			char *stop;
+			unsigned long c = std::strtoul(buf, &stop, 16);
+			if(stop != buf + 4) throw GraphIOException("JSON: Malformed \\u escape");
+			return c;
+		}
+
+		// Parses the string starting at the quote at p and returns the
+		// position after it. Strings with escapes are decoded into decoded.
+		inline const char *parseString(const char *p, const char *end, boost::string_ref &value, std::deque<std::string> &decoded) {
+			const EscapeScanner &scanner = stringScanner();
+			const char *start = ++p;
+			std::string *buf = NULL;
+			while(true) {
+				const char *q = scanner.find(p, end);
+				if(q == end) throw GraphIOException("JSON: Unterminated string");
+
+				if(*q == '"') {
+					if(buf) {
+						buf->append(p, q);
+						value = *buf;
+					} else {
+						value = boost::string_ref(start, q - start);
+					}
+					return q + 1;
+				}
+
+				if(buf == NULL) {
+					decoded.push_back(std::string(start, p));
+					buf = &decoded.back();
+				}
+				buf->append(p, q);
+
+				if(*q != '\\') {
+					// Control characters are invalid in strings but kept
+					*buf += *q;
+					p = q + 1;
+					continue;
+				}
+
+				if(q + 1 >= end) throw GraphIOException("JSON: Unterminated string");
+				p = q + 2;
+				switch(q[1]) {
+					case 'n': *buf += '\n'; break;
+					case 't': *buf += '\t'; break;
+					case 'r': *buf += '\r'; break;
+					case 'b': *buf += '\b'; break;
+					case 'f': *buf += '\f'; break;
+					case 'u': {
+						unsigned long c = hex4(p, end);
+						p += 4;
+						if(c >= 0xD800 && c < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+							unsigned long low = hex4(p + 2, end);
+							if(low >= 0xDC00 && low < 0xE000) {
+								c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+								p += 6;
+							}
+						}
+						appendUTF8(*buf, c);
+						break;
+					}
+					default: *buf += q[1]; break;
+				}
+			}
+		}
+
+		// Returns the position after the value starting at p
+		inline const char *skipValue(const char *p, const char *end) {
+			p = skipSpace(p, end);
+			if(p >= end) throw GraphIOException("JSON: Missing value");
+
+			if(*p == '"') {
+				const EscapeScanner &scanner = stringScanner();
+				p++;
+				while(true) {
+					const char *q = scanner.find(p, end);
+					if(q == end) throw GraphIOException("JSON: Unterminated string");
+					if(*q == '"') return q + 1;
+					p = *q == '\\' ? q + 2 : q + 1;
+				}
+			}
+
+			if(*p == '{' || *p == '[') {
+				// Only strings and brackets matter inside containers
+				static const EscapeScanner scanner("\"{}[]");
+				int depth = 0;
+				while(true) {
+					const char *q = scanner.find(p, end);
+					if(q == end) throw GraphIOException("JSON: Unterminated object or array");
+					switch(*q) {
+						case '"':
+							p = skipValue(q, end);
+							continue;
+						case '{': case '[':
+							depth++;
+							break;
+						case '}': case ']':
+							if(--depth == 0) return q + 1;
+							break;
+					}
+					p = q + 1;
+				}
+			}
+
+			// Numbers, true, false and null
+			while(p < end && !isSpace(*p) && *p != ',' && *p != '}' && *p != ']') p++;
+			return p;
+		}
+
+		// Parses any value at p into text: strings are decoded, other
+		// values are kept as written. null gives an empty string.
+		inline const char *parseScalar(const char *p, const char *end, boost::string_ref &value, std::deque<std::string> &decoded) {
+			p = skipSpace(p, end);
+			if(p < end && *p == '"') {
+				return parseString(p, end, value, decoded);
+			}
+
+			const char *q = skipValue(p, end);
+			value = boost::string_ref(p, q - p);
+			if(value == "null") value.clear();
+			return q;
+		}
+
+		// Advances to the next member or element of the container opened
+		// with expect(). Returns false, with p after the closing bracket,
+		// when there is none.
+		inline bool next(const char *&p, const char *end, char close, bool &first) {
+			p = skipSpace(p, end);
+			if(p >= end) throw GraphIOException(std::string("JSON: Missing ") + close);
+			if(*p == close) {
+				p++;
+				return false;
+			}
+			if(!first) {
+				if(*p != ',') throw GraphIOException(std::string("JSON: Expected , or ") + close);
+				p = skipSpace(p + 1, end);
+			}
+			first = false;
+			return true;
+		}
+
+		// Parses the member name at p and the colon after it
+		inline const char *parseKey(const char *p, const char *end, boost::string_ref &key, std::deque<std::string> &decoded) {
+			p = skipSpace(p, end);
+			if(p >= end || *p != '"') throw GraphIOException("JSON: Expected member name");
+			p = parseString(p, end, key, decoded);
+			return expect(p, end, ':');
+		}
+
+		inline char peek(const char *p, const char *end) {
+			p = skipSpace(p, end);
+			return p < end ? *p : 0;
+		}
+	}
+}
+
+#endif
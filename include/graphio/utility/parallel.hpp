@@ -0,0 +1,75 @@
+#ifndef GRAPHIO_UTILITY_PARALLEL_HPP
+#define GRAPHIO_UTILITY_PARALLEL_HPP
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <graphio/utility/Executor.hpp>
+
+namespace graphio {
+	// Calls f(begin, end) on disjoint ranges covering [0, n) using executor
+	template<typename F>
+	inline void parallel_for(size_t n, Executor &executor, F f) {
+		executor.parallel_for(n, std::function<void(size_t, size_t)>(f));
+	}
+
+	// In-place inclusive prefix sum of v
+	template<typename V>
+	inline void parallel_prefix_sum(V &v, Executor &executor) {
+		size_t n = v.size();
+		size_t chunks = std::max<size_t>(1, std::min<size_t>(executor.concurrency(), n / 65536));
+		std::vector<typename V::value_type> sums(chunks, 0);
+
+		parallel_for(chunks, executor, [&](size_t begin, size_t end) {
+			for(size_t c = begin; c < end; ++c) {
+				size_t lo = n * c / chunks, hi = n * (c+1) / chunks;
+				for(size_t i = lo + 1; i < hi; ++i) v[i] += v[i-1];
+				if(hi > lo) sums[c] = v[hi-1];
+			}
+		});
+
+		for(size_t c = 1; c < chunks; ++c) sums[c] += sums[c-1];
+
+		parallel_for(chunks, executor, [&](size_t begin, size_t end) {
+			for(size_t c = std::max<size_t>(begin, 1); c < end; ++c) {
+				size_t lo = n * c / chunks, hi = n * (c+1) / chunks;
+				for(size_t i = lo; i < hi; ++i) v[i] += sums[c-1];
+			}
+		});
+	}
+
+	// Stable sort of [first, last) using executor
+	template<typename It, typename Compare>
+	inline void parallel_stable_sort(It first, It last, Compare comp, Executor &executor) {
+		size_t n = last - first;
+		size_t chunks = std::max<size_t>(1, std::min<size_t>(executor.concurrency(), n / 4096));
+
+		std::vector<size_t> bounds(chunks+1);
+		for(size_t i = 0; i <= chunks; ++i) {
+			bounds[i] = n * i / chunks;
+		}
+
+		parallel_for(chunks, executor, [&](size_t begin, size_t end) {
+			for(size_t i = begin; i < end; ++i) {
+				std::stable_sort(first + bounds[i], first + bounds[i+1], comp);
+			}
+		});
+
+		// Merge neighbouring runs pairwise
+		for(size_t width = 1; width < chunks; width *= 2) {
+			size_t pairs = (chunks + 2*width - 1) / (2*width);
+			parallel_for(pairs, executor, [&](size_t begin, size_t end) {
+				for(size_t p = begin; p < end; ++p) {
+					size_t lo = 2*width*p;
+					size_t mid = std::min(lo + width, chunks);
+					size_t hi = std::min(lo + 2*width, chunks);
+					if(mid < hi) {
+						std::inplace_merge(first + bounds[lo], first + bounds[mid], first + bounds[hi], comp);
+					}
+				}
+			});
+		}
+	}
+}
+
+#endif
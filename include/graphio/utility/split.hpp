@@ -7,7 +7,7 @@
 #include <boost/algorithm/string.hpp>
 
 namespace graphio {
-	void escaped_split(const std::string &str, const std::string &sep, std::vector<std::string> &parts) {
+	inline void escaped_split(const std::string &str, const std::string &sep, std::vector<std::string> &parts) {
 		boost::escaped_list_separator<char> els("\\", sep, "\"");
 		boost::tokenizer<boost::escaped_list_separator<char>> tokens(str, els);
 
@@ -18,6 +18,23 @@ namespace graphio {
 			}
 		}
 	}
+
+	inline void fast_split(const std::string &str, const std::string &sep, std::vector<std::string> &parts) {
+		size_t n = 0;
+		size_t begin = 0;
+		while(begin < str.length()) {
+			size_t end = str.find_first_of(sep, begin);
+			if(end == std::string::npos) end = str.length();
+
+			if(end > begin) {
+				if(n < parts.size()) parts[n].assign(str, begin, end-begin);
+				else parts.emplace_back(str, begin, end-begin);
+				n++;
+			}
+			begin = end+1;
+		}
+		parts.resize(n);
+	}
 }
 
 #endif
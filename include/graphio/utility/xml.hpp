@@ -0,0 +1,261 @@
+#ifndef GRAPHIO_UTILITY_XML_HPP
+#define GRAPHIO_UTILITY_XML_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstring>
+#include <cstdlib>
+#include <boost/utility/string_ref.hpp>
+#include <graphio/GraphIOException.hpp>
+#include <graphio/utility/escape.hpp>
+
+// Minimal non-validating XML scanning over an in-memory buffer, enough for
+// the element and attribute structure of graph formats. DTDs and external
+// entities are skipped, not interpreted.
+namespace graphio {
+	namespace xml {
+		struct Tag {
+			boost::string_ref name;
+			// Attribute names and raw, still escaped values
+			std::vector<std::pair<boost::string_ref, boost::string_ref> > attributes;
+			// </name>
+			bool closing;
+			// <name/>
+			bool empty;
+
+			inline bool attribute(const boost::string_ref &key, boost::string_ref &value) const {
+				for(size_t i = 0; i < attributes.size(); ++i) {
+					if(attributes[i].first == key) {
+						value = attributes[i].second;
+						return true;
+					}
+				}
+				return false;
+			}
+		};
+
+		inline bool isSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+		}
+
+		inline const char *find(const char *p, const char *end, const char *s) {
+			size_t len = std::strlen(s);
+			while(p + len <= end) {
+				p = static_cast<const char*>(std::memchr(p, s[0], end - p));
+				if(p == NULL || p + len > end) return NULL;
+				if(std::memcmp(p, s, len) == 0) return p;
+				p++;
+			}
+			return NULL;
+		}
+
+		inline bool startsWith(const char *p, const char *end, const char *s) {
+			size_t len = std::strlen(s);
+			return size_t(end - p) >= len && std::memcmp(p, s, len) == 0;
+		}
+
+		// Returns the end of the comment, CDATA section, processing
+		// instruction or declaration starting at p, or NULL if p starts
+		// a regular tag.
+		inline const char *skipMarkup(const char *p, const char *end) {
+			const char *close = NULL;
+			const char *q = NULL;
+			if(startsWith(p, end, "<!--")) {
+				close = "-->";
+				q = find(p + 4, end, close);
+			}
+			else if(startsWith(p, end, "<![CDATA[")) {
+				close = "]]>";
+				q = find(p + 9, end, close);
+			}
+			else if(startsWith(p, end, "<?")) {
+				close = "?>";
+				q = find(p + 2, end, close);
+			}
+			else if(startsWith(p, end, "<!")) {
+				// Declarations may hold an internal subset in brackets
+				int depth = 0;
+				for(q = p + 2; q < end; ++q) {
+					if(*q == '[') depth++;
+					else if(*q == ']') depth--;
+					else if(*q == '>' && depth <= 0) return q + 1;
+				}
+				throw GraphIOException("XML: Unterminated declaration");
+			}
+			else {
+				return NULL;
+			}
+
+			if(q == NULL) {
+				throw GraphIOException(std::string("XML: Missing ") + close);
+			}
+			return q + std::strlen(close);
+		}
+
+		// Parses the start or end tag at p and returns the position after it
+		inline const char *parseTag(const char *p, const char *end, Tag &tag) {
+			tag.attributes.clear();
+			tag.closing = tag.empty = false;
+
+			p++;
+			if(p < end && *p == '/') {
+				tag.closing = true;
+				p++;
+			}
+
+			const char *name = p;
+			while(p < end && !isSpace(*p) && *p != '>' && *p != '/') p++;
+			tag.name = boost::string_ref(name, p - name);
+
+			while(true) {
+				while(p < end && isSpace(*p)) p++;
+				if(p >= end) throw GraphIOException("XML: Unterminated tag");
+
+				if(*p == '>') return p + 1;
+				if(*p == '/') {
+					if(p + 1 < end && p[1] == '>') {
+						tag.empty = true;
+						return p + 2;
+					}
+					throw GraphIOException("XML: Malformed tag");
+				}
+
+				const char *key = p;
+				while(p < end && !isSpace(*p) && *p != '=' && *p != '>') p++;
+				boost::string_ref k(key, p - key);
+
+				while(p < end && isSpace(*p)) p++;
+				if(p >= end || *p != '=') throw GraphIOException("XML: Attribute without value");
+				p++;
+				while(p < end && isSpace(*p)) p++;
+				if(p >= end || (*p != '"' && *p != '\'')) throw GraphIOException("XML: Unquoted attribute value");
+
+				char quote = *p++;
+				const char *q = static_cast<const char*>(std::memchr(p, quote, end - p));
+				if(q == NULL) throw GraphIOException("XML: Unterminated attribute value");
+
+				tag.attributes.push_back(std::make_pair(k, boost::string_ref(p, q - p)));
+				p = q + 1;
+			}
+		}
+
+		// Skips to the end of the tag at p, tracking quotes,
+		// and reports whether it is an end or empty-element tag
+		inline const char *scanTag(const char *p, const char *end, bool &closing, bool &empty) {
+			closing = p + 1 < end && p[1] == '/';
+			for(const char *q = p + 1; q < end; ++q) {
+				if(*q == '"' || *q == '\'') {
+					q = static_cast<const char*>(std::memchr(q + 1, *q, end - q - 1));
+					if(q == NULL) break;
+				}
+				else if(*q == '>') {
+					empty = q[-1] == '/';
+					return q + 1;
+				}
+			}
+			throw GraphIOException("XML: Unterminated tag");
+		}
+
+		// Skips the content and end tag of an element whose start tag ends at p
+		inline const char *skipContent(const char *p, const char *end) {
+			size_t depth = 1;
+			while(true) {
+				p = static_cast<const char*>(std::memchr(p, '<', end - p));
+				if(p == NULL) throw GraphIOException("XML: Unexpected end of document");
+
+				const char *q = skipMarkup(p, end);
+				if(q != NULL) {
+					p = q;
+					continue;
+				}
+
+				bool closing, empty;
+				p = scanTag(p, end, closing, empty);
+				if(closing) {
+					if(--depth == 0) return p;
+				}
+				else if(!empty) {
+					depth++;
+				}
+			}
+		}
+
+		// Replaces the predefined and numeric character references in raw
+		inline void decode(const boost::string_ref &raw, std::string &out) {
+			out.clear();
+			const char *p = raw.data(), *end = p + raw.size();
+			while(p < end) {
+				const char *amp = static_cast<const char*>(std::memchr(p, '&', end - p));
+				if(amp == NULL) {
+					out.append(p, end);
+					return;
+				}
+				out.append(p, amp);
+
+				const char *semi = static_cast<const char*>(std::memchr(amp, ';', end - amp));
+				if(semi == NULL) throw GraphIOException("XML: Unterminated character reference");
+
+				boost::string_ref ref(amp + 1, semi - amp - 1);
+				if(ref == "lt") out += '<';
+				else if(ref == "gt") out += '>';
+				else if(ref == "amp") out += '&';
+				else if(ref == "quot") out += '"';
+				else if(ref == "apos") out += '\'';
+				else if(ref.size() > 1 && ref[0] == '#') {
+					std::string digits = ref[1] == 'x' ? ref.substr(2).to_string() : ref.substr(1).to_string();
+					appendUTF8(out, std::strtoul(digits.c_str(), NULL, ref[1] == 'x' ? 16 : 10));
+				}
+				else throw GraphIOException("XML: Unknown entity &" + ref.to_string() + ";");
+
+				p = semi + 1;
+			}
+		}
+
+		inline std::string decode(const boost::string_ref &raw) {
+			std::string out;
+			decode(raw, out);
+			return out;
+		}
+
+		// Collects the character data in [p, end), the content of an element,
+		// decoding references and CDATA sections and skipping nested tags.
+		// Surrounding whitespace is trimmed when nested elements were found.
+		inline void text(const char *p, const char *end, std::string &out) {
+			out.clear();
+			std::string part;
+			bool nested = false;
+			while(p < end) {
+				const char *lt = static_cast<const char*>(std::memchr(p, '<', end - p));
+				if(lt == NULL) lt = end;
+				decode(boost::string_ref(p, lt - p), part);
+				out += part;
+				if(lt == end) break;
+
+				if(startsWith(lt, end, "<![CDATA[")) {
+					const char *q = find(lt + 9, end, "]]>");
+					if(q == NULL) throw GraphIOException("XML: Missing ]]>");
+					out.append(lt + 9, q);
+					p = q + 3;
+					continue;
+				}
+
+				const char *q = skipMarkup(lt, end);
+				if(q == NULL) {
+					bool closing, empty;
+					q = scanTag(lt, end, closing, empty);
+					nested = true;
+				}
+				p = q;
+			}
+
+			if(nested) {
+				size_t first = out.find_first_not_of(" \t\r\n");
+				size_t last = out.find_last_not_of(" \t\r\n");
+				out = first == std::string::npos ? std::string() : out.substr(first, last - first + 1);
+			}
+		}
+	}
+}
+
+#endif
@@ -1,26 +1,177 @@
 #include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <graphio/Graph.hpp>
 #include <graphio/GraphReader.hpp>
 #include <graphio/GraphWriter.hpp>
+#include <graphio/Freeze.hpp>
+#include <graphio/BinaryCSRConvert.hpp>
+
+typedef boost::adjacency_list<
+	boost::setS,
+	boost::vecS,
+	boost::undirectedS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> SetGraph;
+
+typedef boost::adjacency_list<
+	boost::vecS,
+	boost::vecS,
+	boost::undirectedS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> VecGraph;
+
+typedef boost::adjacency_list<
+	boost::setS,
+	boost::vecS,
+	boost::bidirectionalS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> DirectedSetGraph;
+
+typedef boost::adjacency_list<
+	boost::vecS,
+	boost::vecS,
+	boost::bidirectionalS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> DirectedVecGraph;
+
+static void usage(const char *name) {
+	std::cerr << "Usage: " << name << " [--repr sets|vecs|csr|stream|auto] [--threads N] [--memory BYTES] [--directed] INPUTFILE OUTPUTFILE" << std::endl;
+	std::cerr << "  sets    adjacency list with set edges, duplicates removed on insert" << std::endl;
+	std::cerr << "  vecs    adjacency list with vector edges, duplicates skipped in bulk on output" << std::endl;
+	std::cerr << "  csr     vector edges frozen into CSR, duplicates removed in bulk" << std::endl;
+	std::cerr << "  stream  SIF or tab to .bcsr through sorted runs in temporary files," << std::endl;
+	std::cerr << "          using about --memory bytes besides the vertex labels" << std::endl;
+	std::cerr << "          (default a quarter of available memory)" << std::endl;
+	std::cerr << "  auto    pick one from the files, input size and available memory (default)" << std::endl;
+	std::cerr << "--directed keeps edge directions; undirected inputs get both directions" << std::endl;
+}
+
+static double availableMemory() {
+	return double(sysconf(_SC_AVPHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+}
+
+// Picks a representation from the files, input size and free memory.
+// SIF and tab files convert to .bcsr by streaming. Otherwise small inputs
+// use sets; larger ones use csr while the CSR copy fits next to the
+// adjacency list, else vecs.
+static std::string chooseRepresentation(const std::string &filename, const std::string &output, bool directed) {
+	if(!directed && graphio::canConvertToBinaryCSR(filename, output)) return "stream";
+
+	struct stat st;
+	if(stat(filename.c_str(), &st) != 0) return "sets";
+
+	double size = st.st_size;
+	double available = availableMemory();
+
+	if(size < (64 << 20)) return "sets";
+	// Rough memory use of a vecS adjacency list and its CSR copy per input byte
+	if(size * 16 < available) return "csr";
+	return "vecs";
+}
+
+// Converts through the in-memory representation repr, returning false
+// if there is no such representation
+template<class SetG, class VecG, class CSR>
+static bool convert(const std::string &repr, const std::string &input, const std::string &output) {
+	if(repr == "sets") {
+		SetG g(0);
+		graphio::readGraph(input, g);
+		graphio::writeGraph(g, output);
+	}
+	else if(repr == "vecs") {
+		VecG g(0);
+		graphio::readGraph(input, g);
+		graphio::writeGraph(graphio::withoutParallelEdges(g), output);
+	}
+	else if(repr == "csr") {
+		VecG g(0);
+		CSR csr;
+		graphio::readGraph(input, g);
+		graphio::freezeAndRelease(g, csr);
+		graphio::removeParallelEdges(csr);
+		graphio::writeGraph(csr, output);
+	}
+	else {
+		return false;
+	}
+	return true;
+}
 
 int main(int argc, const char *argv[]) {
-	boost::adjacency_list<
-		boost::setS,
-		boost::vecS,
-		boost::undirectedS,
-		graphio::LabeledVertex,
-		graphio::LabeledEdge,
-		graphio::LabeledGraph
-	> g(0);
-
-	if(argc != 3) {
+	std::string repr = "auto";
+	unsigned threads = graphio::defaultThreadCount();
+	size_t memory = 0;
+	bool directed = false;
+	std::vector<std::string> files;
+
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "--repr" && i+1 < argc) {
+			repr = argv[++i];
+		}
+		else if(arg == "--threads" && i+1 < argc) {
+			threads = std::max(1, std::atoi(argv[++i]));
+		}
+		else if(arg == "--memory" && i+1 < argc) {
+			memory = std::strtoull(argv[++i], NULL, 10);
+		}
+		else if(arg == "--directed") {
+			directed = true;
+		}
+		else if(arg.length() > 2 && arg.compare(0, 2, "--") == 0) {
+			std::cerr << "error: Unknown option: " << arg << std::endl;
+			usage(argv[0]);
+			return 1;
+		}
+		else {
+			files.push_back(arg);
+		}
+	}
+
+	if(files.size() != 2) {
 		std::cerr << "error: Invalid number of arguments." << std::endl;
-		std::cerr << "Usage: " << argv[0] << " INPUTFILE OUTPUTFILE" << std::endl;
+		usage(argv[0]);
 		return 1;
 	}
 
-	graphio::readGraph(argv[1], g);
-	graphio::writeGraph(g, argv[2]);
+	// Readers, writers and the conversion steps all run on this pool
+	graphio::ThreadPool pool(threads);
+	graphio::setDefaultExecutor(&pool);
+
+	if(repr == "auto") {
+		repr = chooseRepresentation(files[0], files[1], directed);
+	}
+
+	if(repr == "stream") {
+		if(directed || !graphio::canConvertToBinaryCSR(files[0], files[1])) {
+			std::cerr << "error: stream only converts SIF and tab files to undirected .bcsr" << std::endl;
+			return 1;
+		}
+		if(memory == 0) {
+			memory = std::max(availableMemory() / 4, double(64 << 20));
+		}
+		graphio::convertToBinaryCSR(files[0], files[1], memory);
+	}
+	else if(directed
+		? !convert<DirectedSetGraph, DirectedVecGraph, graphio::DirectedCSRGraph<> >(repr, files[0], files[1])
+		: !convert<SetGraph, VecGraph, graphio::CSRGraph<> >(repr, files[0], files[1])) {
+		std::cerr << "error: Unknown representation: " << repr << std::endl;
+		usage(argv[0]);
+		return 1;
+	}
 
 	return 0;
 }
@@ -0,0 +1,374 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <graphio/Graph.hpp>
+#include <graphio/GraphReader.hpp>
+#include <graphio/GraphTypes.hpp>
+#include <graphio/LabelDictionary.hpp>
+#include <graphio/formats/Ligra.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/LabelSidecar.hpp>
+#include <graphio/daemon/Protocol.hpp>
+
+using namespace graphio::daemon;
+
+typedef boost::adjacency_list<
+	boost::setS,
+	boost::vecS,
+	boost::undirectedS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> Graph;
+
+// Adjacency of a served graph in CSR form, each undirected edge listed
+// at both endpoints and each directed edge at its source. .bcsr files
+// are mapped and their arrays used in place; other formats are read
+// and copied into owned arrays.
+struct LoadedGraph {
+	uint32_t n;
+	bool directed;
+	// Edge count, counted on first use for undirected mapped files
+	mutable uint64_t m;
+	const uint64_t *offsets;
+	const uint32_t *targets;
+	graphio::LabelDictionary labels;
+
+	std::unique_ptr<graphio::MappedFile> file;
+	std::vector<uint64_t> offset_data;
+	std::vector<uint32_t> target_data;
+
+	inline uint32_t degree(uint32_t v) const {
+		return offsets[v+1] - offsets[v];
+	}
+
+	// Undirected edges are counted at their lower endpoint, as self-loops are listed once
+	uint64_t edges() const {
+		if(directed) return offsets[n];
+		if(m == NO_COUNT) {
+			m = 0;
+			for(uint32_t v = 0; v < n; ++v) {
+				for(uint64_t k = offsets[v]; k < offsets[v+1]; ++k) {
+					if(targets[k] >= v) m++;
+				}
+			}
+		}
+		return m;
+	}
+
+	static const uint64_t NO_COUNT = ~uint64_t(0);
+};
+
+static void mapBinaryCSR(const std::string &filename, LoadedGraph &lg) {
+	lg.file.reset(new graphio::MappedFile(filename));
+	graphio::BinaryCSRView view = graphio::viewBinaryCSR(filename, *lg.file);
+
+	uint64_t n = view.n;
+	lg.n = n;
+	lg.offsets = view.offsets;
+	lg.targets = view.targets;
+	lg.directed = graphio::fileExists(graphio::directedSidecar(filename));
+	lg.m = LoadedGraph::NO_COUNT;
+
+	std::vector<std::string> labels;
+	if(graphio::readLabelSidecar(graphio::vertexLabelSidecar(filename), labels)) {
+		if(labels.size() != n) {
+			throw graphio::GraphIOException("Label sidecar does not match the vertex count of " + filename);
+		}
+	} else {
+		labels.resize(n);
+		for(uint64_t v = 0; v < n; ++v) {
+			labels[v] = std::to_string(v);
+		}
+	}
+	lg.labels = graphio::LabelDictionary(labels);
+}
+
+static void readGraphFile(const std::string &filename, LoadedGraph &lg) {
+	Graph g;
+	graphio::readGraph(filename, g);
+
+	lg.n = num_vertices(g);
+	lg.directed = false;
+	lg.m = num_edges(g);
+	lg.offset_data.resize(lg.n + 1);
+	lg.target_data.reserve(2 * lg.m);
+	for(uint32_t v = 0; v < lg.n; ++v) {
+		lg.offset_data[v] = lg.target_data.size();
+		for(auto it = adjacent_vertices(v, g); it.first != it.second; ++it.first) {
+			lg.target_data.push_back(*it.first);
+		}
+	}
+	lg.offset_data[lg.n] = lg.target_data.size();
+
+	lg.offsets = lg.offset_data.data();
+	lg.targets = lg.target_data.data();
+	lg.labels = graphio::LabelDictionary::fromGraph(g);
+}
+
+struct Connection {
+	int fd;
+	std::string in, out;
+	// The client has shut down its side; close once out is sent
+	bool eof;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) {
+	running = 0;
+}
+
+static void respond(std::string &out, uint32_t id, uint16_t status, const std::string &payload) {
+	appendHeader(out, payload.length(), id, status, 0);
+	out.append(payload);
+}
+
+static void handle(const std::vector<LoadedGraph> &graphs, const Header &h, const char *data, std::string &out) {
+	std::string payload;
+
+	if(h.graph >= graphs.size()) {
+		respond(out, h.id, STATUS_NO_GRAPH, payload);
+		return;
+	}
+	const LoadedGraph &lg = graphs[h.graph];
+	uint32_t n = lg.n;
+
+	switch(h.code) {
+		case OP_INFO:
+			appendU32(payload, n);
+			appendU32(payload, lg.edges());
+			break;
+
+		case OP_DEGREE:
+		case OP_NEIGHBORS:
+		case OP_LABEL: {
+			if(h.length != 4) {
+				respond(out, h.id, STATUS_BAD_REQUEST, payload);
+				return;
+			}
+			uint32_t v = readU32(data);
+			if(v >= n) {
+				respond(out, h.id, STATUS_NO_VERTEX, payload);
+				return;
+			}
+
+			if(h.code == OP_DEGREE) {
+				appendU32(payload, lg.degree(v));
+			}
+			else if(h.code == OP_NEIGHBORS) {
+				appendU32(payload, lg.degree(v));
+				for(uint64_t k = lg.offsets[v]; k < lg.offsets[v+1]; ++k) {
+					appendU32(payload, lg.targets[k]);
+				}
+			}
+			else {
+				payload = lg.labels.label(v);
+			}
+			break;
+		}
+
+		case OP_LOOKUP: {
+			size_t v = lg.labels.find(boost::string_ref(data, h.length));
+			if(v == graphio::LabelDictionary::npos) {
+				respond(out, h.id, STATUS_NOT_FOUND, payload);
+				return;
+			}
+			appendU32(payload, v);
+			break;
+		}
+
+		case OP_SUBGRAPH: {
+			uint32_t count = h.length >= 4 ? readU32(data) : 0;
+			if(h.length < 4 || h.length != 4 + 4*size_t(count)) {
+				respond(out, h.id, STATUS_BAD_REQUEST, payload);
+				return;
+			}
+
+			std::vector<uint32_t> vs(count);
+			for(uint32_t i = 0; i < count; ++i) {
+				vs[i] = readU32(data + 4 + 4*i);
+				if(vs[i] >= n) {
+					respond(out, h.id, STATUS_NO_VERTEX, payload);
+					return;
+				}
+			}
+			std::sort(vs.begin(), vs.end());
+			vs.erase(std::unique(vs.begin(), vs.end()), vs.end());
+
+			std::string edges;
+			uint32_t m = 0;
+			for(size_t i = 0; i < vs.size(); ++i) {
+				for(uint64_t k = lg.offsets[vs[i]]; k < lg.offsets[vs[i]+1]; ++k) {
+					uint32_t u = lg.targets[k];
+					if(vs[i] <= u && std::binary_search(vs.begin(), vs.end(), u)) {
+						appendU32(edges, vs[i]);
+						appendU32(edges, u);
+						m++;
+					}
+				}
+			}
+			appendU32(payload, m);
+			payload.append(edges);
+			break;
+		}
+
+		default:
+			respond(out, h.id, STATUS_BAD_REQUEST, payload);
+			return;
+	}
+
+	respond(out, h.id, STATUS_OK, payload);
+}
+
+// Answers every complete request buffered for the connection.
+// Returns false if the client sent a malformed frame.
+static bool process(const std::vector<LoadedGraph> &graphs, Connection &c) {
+	size_t pos = 0;
+	while(c.in.length() - pos >= sizeof(Header)) {
+		Header h;
+		std::memcpy(&h, c.in.data() + pos, sizeof(h));
+		if(h.length > MAX_MESSAGE_LENGTH) return false;
+		if(c.in.length() - pos - sizeof(h) < h.length) break;
+
+		handle(graphs, h, c.in.data() + pos + sizeof(h), c.out);
+		pos += sizeof(h) + h.length;
+	}
+	c.in.erase(0, pos);
+	return true;
+}
+
+int main(int argc, const char *argv[]) {
+	if(argc < 3) {
+		std::cerr << "error: Invalid number of arguments." << std::endl;
+		std::cerr << "Usage: " << argv[0] << " SOCKET GRAPHFILE..." << std::endl;
+		return 1;
+	}
+
+	std::string path = argv[1];
+	std::vector<LoadedGraph> graphs(argc - 2);
+	for(int i = 2; i < argc; ++i) {
+		LoadedGraph &lg = graphs[i-2];
+		try {
+			if(graphio::graphFileType(argv[i]) == graphio::Type::BinaryCSR) {
+				mapBinaryCSR(argv[i], lg);
+			} else {
+				readGraphFile(argv[i], lg);
+			}
+		} catch(const graphio::GraphIOException &e) {
+			std::cerr << "error: " << e.what() << std::endl;
+			return 1;
+		}
+		std::cerr << "graph " << i-2 << ": " << argv[i] << " (" << lg.n << " vertices)" << std::endl;
+	}
+
+	sockaddr_un addr;
+	if(path.length() >= sizeof(addr.sun_path)) {
+		std::cerr << "error: Socket path too long: " << path << std::endl;
+		return 1;
+	}
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	std::strcpy(addr.sun_path, path.c_str());
+
+	int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	unlink(path.c_str());
+	if(listener < 0
+	|| bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+	|| listen(listener, SOMAXCONN) < 0) {
+		std::cerr << "error: Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+		return 1;
+	}
+
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+	signal(SIGPIPE, SIG_IGN);
+
+	std::vector<Connection> connections;
+	std::vector<pollfd> fds;
+	std::vector<char> buffer(1 << 16);
+
+	while(running) {
+		fds.resize(connections.size() + 1);
+		fds[0].fd = listener;
+		fds[0].events = POLLIN;
+		for(size_t i = 0; i < connections.size(); ++i) {
+			fds[i+1].fd = connections[i].fd;
+			fds[i+1].events = (connections[i].eof ? 0 : POLLIN) | (connections[i].out.empty() ? 0 : POLLOUT);
+		}
+
+		if(poll(&fds[0], fds.size(), -1) < 0) {
+			if(errno == EINTR) continue;
+			std::cerr << "error: poll failed: " << std::strerror(errno) << std::endl;
+			break;
+		}
+
+		// Serve existing connections, batching all buffered requests per wakeup
+		for(size_t i = connections.size(); i-- > 0;) {
+			Connection &c = connections[i];
+			short revents = fds[i+1].revents;
+			bool alive = true;
+
+			if(!c.eof && (revents & (POLLIN | POLLHUP | POLLERR))) {
+				while(true) {
+					ssize_t n = read(c.fd, &buffer[0], buffer.size());
+					if(n > 0) {
+						c.in.append(&buffer[0], n);
+						continue;
+					}
+					if(n == 0) c.eof = true;
+					else if(errno == EINTR) continue;
+					else if(errno != EAGAIN) alive = false;
+					break;
+				}
+				if(!process(graphs, c)) alive = false;
+			}
+			else if(revents & POLLERR) {
+				alive = false;
+			}
+
+			while(alive && !c.out.empty()) {
+				ssize_t n = send(c.fd, c.out.data(), c.out.length(), MSG_NOSIGNAL);
+				if(n > 0) c.out.erase(0, n);
+				else if(n < 0 && errno == EINTR) continue;
+				else {
+					if(n < 0 && errno != EAGAIN) alive = false;
+					break;
+				}
+			}
+
+			if(!alive || (c.eof && c.out.empty())) {
+				close(c.fd);
+				connections.erase(connections.begin() + i);
+			}
+		}
+
+		if(fds[0].revents & POLLIN) {
+			int fd;
+			while((fd = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+				Connection c;
+				c.fd = fd;
+				c.eof = false;
+				connections.push_back(c);
+			}
+		}
+	}
+
+	for(size_t i = 0; i < connections.size(); ++i) {
+		close(connections[i].fd);
+	}
+	close(listener);
+	unlink(path.c_str());
+
+	return 0;
+}
@@ -0,0 +1,417 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <algorithm>
+#include <initializer_list>
+#include <unistd.h>
+#include <graphio/Graph.hpp>
+#include <graphio/GraphTypes.hpp>
+#include <graphio/GraphBuilder.hpp>
+#include <graphio/LabelDictionary.hpp>
+#include <graphio/ParsePolicy.hpp>
+#include <graphio/utility/FileInput.hpp>
+#include <graphio/utility/SpillFile.hpp>
+#include <graphio/utility/split.hpp>
+
+// Micro-benchmarks for the inner loops of the readers. Each benchmark
+// runs over a generated corpus and reports the best of several runs in
+// nanoseconds per input byte and per record.
+
+struct Options {
+	size_t records;
+	size_t label_length;
+	double quote_rate;
+	size_t fields;
+	size_t repeat;
+	unsigned seed;
+	std::string filter;
+
+	Options() : records(1000000), label_length(12), quote_rate(0.1), fields(3), repeat(5), seed(1) { }
+};
+
+static void usage(const char *name) {
+	std::cerr << "Usage: " << name << " [--records N] [--label-length N] [--quote-rate P] [--fields N] [--repeat N] [--seed N] [FILTER]" << std::endl;
+	std::cerr << "  runs the benchmarks whose name contains FILTER, or all" << std::endl;
+}
+
+// Keeps results alive so the compiler cannot drop the measured work
+static volatile size_t sink;
+
+class Stopwatch {
+	public:
+		Stopwatch() : start(std::chrono::steady_clock::now()) { }
+
+		inline double ns() const {
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point start;
+};
+
+// Runs f, which returns the nanoseconds it measured, and keeps the best
+template<typename F>
+static double best(const Options &options, F f) {
+	double ns = std::numeric_limits<double>::infinity();
+	for(size_t r = 0; r < options.repeat; ++r) {
+		ns = std::min(ns, f());
+	}
+	return ns;
+}
+
+static bool selected(const Options &options, const std::string &name) {
+	return name.find(options.filter) != std::string::npos;
+}
+
+static bool selected(const Options &options, std::initializer_list<const char*> names) {
+	for(auto it = names.begin(); it != names.end(); ++it) {
+		if(selected(options, *it)) return true;
+	}
+	return false;
+}
+
+static void report(const std::string &name, double ns, size_t bytes, size_t records) {
+	std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(3)
+		<< std::setw(12) << (bytes ? ns / bytes : 0.0) << " ns/byte"
+		<< std::setw(12) << ns / records << " ns/record" << std::endl;
+}
+
+class Corpus {
+	public:
+		Corpus(const Options &options) : options(options), rng(options.seed) { }
+
+		std::string label() {
+			static const char chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-.";
+			std::uniform_int_distribution<size_t> pick(0, sizeof(chars) - 2);
+			std::string s(options.label_length, ' ');
+			for(size_t i = 0; i < s.size(); ++i) {
+				s[i] = chars[pick(rng)];
+			}
+			return s;
+		}
+
+		// A field that is quoted at the quote rate, the quoted ones
+		// holding a separator and an escaped quote
+		std::string field(char sep) {
+			std::string s = label();
+			if(!chance(options.quote_rate)) return s;
+
+			s[s.size() / 2] = sep;
+			return "\"" + s.substr(0, s.size() / 3) + "\\\"" + s.substr(s.size() / 3) + "\"";
+		}
+
+		bool chance(double p) {
+			return std::uniform_real_distribution<double>(0, 1)(rng) < p;
+		}
+
+		size_t below(size_t n) {
+			return std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+		}
+
+		// Lines of tab separated fields
+		std::vector<std::string> lines() {
+			std::vector<std::string> out(options.records);
+			for(size_t i = 0; i < out.size(); ++i) {
+				for(size_t f = 0; f < options.fields; ++f) {
+					if(f > 0) out[i] += '\t';
+					out[i] += field('\t');
+				}
+			}
+			return out;
+		}
+
+		// Distinct labels
+		std::vector<std::string> labels() {
+			std::vector<std::string> out;
+			std::unordered_map<std::string, size_t> seen;
+			while(out.size() < options.records) {
+				std::string s = label();
+				if(seen.insert(std::make_pair(s, 0)).second) out.push_back(s);
+			}
+			return out;
+		}
+
+	private:
+		const Options &options;
+		std::mt19937_64 rng;
+};
+
+static size_t totalSize(const std::vector<std::string> &v) {
+	size_t n = 0;
+	for(size_t i = 0; i < v.size(); ++i) n += v[i].size();
+	return n;
+}
+
+static void benchSplit(const Options &options) {
+	if(!selected(options, {"escaped_split", "fast_split"})) return;
+
+	Corpus corpus(options);
+	std::vector<std::string> lines = corpus.lines();
+	size_t bytes = totalSize(lines);
+	std::vector<std::string> parts;
+
+	if(selected(options, "escaped_split")) {
+		report("escaped_split", best(options, [&]() {
+			Stopwatch w;
+			for(size_t i = 0; i < lines.size(); ++i) {
+				graphio::escaped_split(lines[i], "\t", parts);
+				sink += parts.size();
+			}
+			return w.ns();
+		}), bytes, lines.size());
+	}
+
+	if(selected(options, "fast_split")) {
+		report("fast_split", best(options, [&]() {
+			Stopwatch w;
+			for(size_t i = 0; i < lines.size(); ++i) {
+				graphio::fast_split(lines[i], "\t", parts);
+				sink += parts.size();
+			}
+			return w.ns();
+		}), bytes, lines.size());
+	}
+}
+
+template<class Policy>
+static void benchLEDALines(const Options &options, const std::string &name, const std::string &filename, size_t records, size_t bytes) {
+	if(selected(options, name + " readLEDALine")) {
+		report(name + " readLEDALine", best(options, [&]() {
+			graphio::FileInput file(filename);
+			std::string line;
+			Stopwatch w;
+			for(size_t i = 0; i < records; ++i) {
+				Policy::readLEDALine(file, line);
+				sink += line.size();
+			}
+			return w.ns();
+		}), bytes, records);
+	}
+
+	if(selected(options, name + " parseLEDAEdge")) {
+		report(name + " parseLEDAEdge", best(options, [&]() {
+			graphio::FileInput file(filename);
+			std::string line, label;
+			size_t u, v;
+			Stopwatch w;
+			for(size_t i = 0; i < records; ++i) {
+				Policy::readLEDALine(file, line);
+				Policy::parseLEDAEdge(line, u, v, label);
+				sink += u + v + label.size();
+			}
+			return w.ns();
+		}), bytes, records);
+	}
+}
+
+static void benchLEDA(const Options &options) {
+	if(!selected(options, {"strict readLEDALine", "strict parseLEDAEdge", "trusted readLEDALine", "trusted parseLEDAEdge"})) return;
+
+	// Edge lines with the occasional comment and blank line in between
+	Corpus corpus(options);
+	std::string filename = graphio::spillDirectory() + "/graphio-microbench-" + std::to_string(getpid()) + ".gw";
+	size_t bytes = 0;
+	{
+		std::ofstream out(filename);
+		for(size_t i = 0; i < options.records; ++i) {
+			if(corpus.chance(0.01)) out << "# comment\n\n";
+			std::string line = std::to_string(corpus.below(options.records) + 1) + " "
+				+ std::to_string(corpus.below(options.records) + 1) + " 0 |{" + corpus.label() + "}|\n";
+			bytes += line.size();
+			out << line;
+		}
+	}
+
+	benchLEDALines<graphio::StrictPolicy>(options, "strict", filename, options.records, bytes);
+	benchLEDALines<graphio::TrustedPolicy>(options, "trusted", filename, options.records, bytes);
+	std::remove(filename.c_str());
+}
+
+static void benchGraphFileType(const Options &options) {
+	if(!selected(options, "graphFileType")) return;
+
+	static const char *extensions[] = {
+		".gw", ".LEDA", ".sif", ".xgmml", ".tab", ".GraphML", ".adj", ".bcsr",
+		".bel", ".arrow", ".csv", ".cyjs", ".json", ".txt"
+	};
+	size_t count = sizeof(extensions) / sizeof(extensions[0]);
+
+	Corpus corpus(options);
+	std::vector<std::string> names(options.records);
+	for(size_t i = 0; i < names.size(); ++i) {
+		names[i] = "/data/" + corpus.label() + extensions[corpus.below(count)];
+	}
+
+	report("graphFileType", best(options, [&]() {
+		Stopwatch w;
+		for(size_t i = 0; i < names.size(); ++i) {
+			sink += graphio::graphFileType(names[i]);
+		}
+		return w.ns();
+	}), totalSize(names), names.size());
+}
+
+// Inserts every label, numbering it as the readers do, then looks up
+// all of them in a different order
+template<class Map, typename Key>
+static void benchMap(const Options &options, const std::string &name, const std::vector<std::string> &labels, const std::vector<size_t> &order) {
+	size_t bytes = totalSize(labels);
+
+	if(selected(options, name + " insert")) {
+		report(name + " insert", best(options, [&]() {
+			std::unique_ptr<Map> map(new Map());
+			Stopwatch w;
+			for(size_t i = 0; i < labels.size(); ++i) {
+				map->insert(std::make_pair(Key(labels[i]), map->size()));
+			}
+			return w.ns();
+		}), bytes, labels.size());
+	}
+
+	if(selected(options, name + " lookup")) {
+		Map map;
+		for(size_t i = 0; i < labels.size(); ++i) {
+			map.insert(std::make_pair(Key(labels[i]), map.size()));
+		}
+		report(name + " lookup", best(options, [&]() {
+			Stopwatch w;
+			for(size_t i = 0; i < order.size(); ++i) {
+				sink += map.find(Key(labels[order[i]]))->second;
+			}
+			return w.ns();
+		}), bytes, labels.size());
+	}
+}
+
+static void benchDictionaries(const Options &options) {
+	if(!selected(options, {
+		"std::map insert", "std::map lookup", "std::unordered_map insert", "std::unordered_map lookup",
+		"BuilderDictionary insert", "BuilderDictionary lookup", "LabelDictionary build", "LabelDictionary lookup"
+	})) return;
+
+	Corpus corpus(options);
+	std::vector<std::string> labels = corpus.labels();
+	std::vector<size_t> order(labels.size());
+	for(size_t i = 0; i < order.size(); ++i) order[i] = i;
+	std::shuffle(order.begin(), order.end(), std::mt19937_64(options.seed));
+
+	benchMap<std::map<std::string, size_t>, std::string>(options, "std::map", labels, order);
+	benchMap<std::unordered_map<std::string, size_t>, std::string>(options, "std::unordered_map", labels, order);
+	benchMap<graphio::detail::BuilderDictionary, boost::string_ref>(options, "BuilderDictionary", labels, order);
+
+	size_t bytes = totalSize(labels);
+	if(selected(options, "LabelDictionary build")) {
+		report("LabelDictionary build", best(options, [&]() {
+			Stopwatch w;
+			graphio::LabelDictionary dict(labels);
+			sink += dict.size();
+			return w.ns();
+		}), bytes, labels.size());
+	}
+
+	if(selected(options, "LabelDictionary lookup")) {
+		graphio::LabelDictionary dict(labels);
+		report("LabelDictionary lookup", best(options, [&]() {
+			Stopwatch w;
+			for(size_t i = 0; i < order.size(); ++i) {
+				sink += dict.find(labels[order[i]]);
+			}
+			return w.ns();
+		}), bytes, labels.size());
+	}
+}
+
+// Adds labeled edges between random vertices, about four per vertex
+template<class OutEdgeList, class Directed>
+static void benchAdjacencyList(const Options &options, const std::string &name) {
+	typedef boost::adjacency_list<
+		OutEdgeList,
+		boost::vecS,
+		Directed,
+		graphio::LabeledVertex,
+		graphio::LabeledEdge,
+		graphio::LabeledGraph
+	> G;
+
+	if(!selected(options, "adjacency_list<" + name + ">")) return;
+
+	Corpus corpus(options);
+	size_t n = std::max<size_t>(1, options.records / 4);
+	std::vector<std::pair<size_t, size_t> > edges(options.records);
+	std::vector<std::string> labels(options.records);
+	for(size_t i = 0; i < edges.size(); ++i) {
+		edges[i] = std::make_pair(corpus.below(n), corpus.below(n));
+		labels[i] = corpus.label();
+	}
+
+	report("adjacency_list<" + name + ">", best(options, [&]() {
+		std::unique_ptr<G> g(new G(n));
+		Stopwatch w;
+		for(size_t i = 0; i < edges.size(); ++i) {
+			auto e = add_edge(edges[i].first, edges[i].second, *g);
+			(*g)[e.first].label = labels[i];
+		}
+		return w.ns();
+	}), totalSize(labels), edges.size());
+}
+
+int main(int argc, const char *argv[]) {
+	Options options;
+
+	for(int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if(arg == "--records" && i+1 < argc) {
+			options.records = std::max(1L, std::atol(argv[++i]));
+		}
+		else if(arg == "--label-length" && i+1 < argc) {
+			options.label_length = std::max(3L, std::atol(argv[++i]));
+		}
+		else if(arg == "--quote-rate" && i+1 < argc) {
+			options.quote_rate = std::atof(argv[++i]);
+		}
+		else if(arg == "--fields" && i+1 < argc) {
+			options.fields = std::max(1L, std::atol(argv[++i]));
+		}
+		else if(arg == "--repeat" && i+1 < argc) {
+			options.repeat = std::max(1L, std::atol(argv[++i]));
+		}
+		else if(arg == "--seed" && i+1 < argc) {
+			options.seed = std::atoi(argv[++i]);
+		}
+		else if(arg.length() > 2 && arg.compare(0, 2, "--") == 0) {
+			std::cerr << "error: Unknown option: " << arg << std::endl;
+			usage(argv[0]);
+			return 1;
+		}
+		else {
+			options.filter = arg;
+		}
+	}
+
+	std::cout << "records " << options.records << ", label length " << options.label_length
+		<< ", quote rate " << options.quote_rate << ", fields " << options.fields
+		<< ", best of " << options.repeat << std::endl;
+
+	benchSplit(options);
+	benchLEDA(options);
+	benchGraphFileType(options);
+	benchDictionaries(options);
+	benchAdjacencyList<boost::vecS, boost::undirectedS>(options, "vecS, undirectedS");
+	benchAdjacencyList<boost::setS, boost::undirectedS>(options, "setS, undirectedS");
+	benchAdjacencyList<boost::listS, boost::undirectedS>(options, "listS, undirectedS");
+	benchAdjacencyList<boost::vecS, boost::directedS>(options, "vecS, directedS");
+	benchAdjacencyList<boost::setS, boost::directedS>(options, "setS, directedS");
+	benchAdjacencyList<boost::vecS, boost::bidirectionalS>(options, "vecS, bidirectionalS");
+
+	return 0;
+}
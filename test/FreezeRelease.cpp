@@ -0,0 +1,150 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <boost/graph/adjacency_list.hpp>
+#include <graphio/Graph.hpp>
+#include <graphio/Freeze.hpp>
+
+// Checks that freezeAndRelease() frees the source adjacency while the
+// CSR columns fill up, and that it builds the same graph as freeze().
+
+typedef boost::adjacency_list<
+	boost::vecS,
+	boost::vecS,
+	boost::undirectedS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> Graph;
+
+typedef boost::adjacency_list<
+	boost::vecS,
+	boost::vecS,
+	boost::bidirectionalS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> DirectedGraph;
+
+// Runs every range on the calling thread, noting how many edges the
+// graph has left each time
+template<class G>
+class RecordingExecutor : public graphio::Executor {
+	public:
+		RecordingExecutor(const G &g) : g(g) { }
+
+		void submit(std::function<void()> task) {
+			task();
+		}
+
+		unsigned concurrency() const {
+			return 1;
+		}
+
+		void parallel_for(size_t n, const std::function<void(size_t, size_t)> &f) {
+			size_t half_edges = 0;
+			for(size_t v = 0; v < num_vertices(g); ++v) {
+				half_edges += out_degree(v, g);
+			}
+			edges.push_back(num_edges(g));
+			adjacency.push_back(half_edges);
+			if(n > 0) f(0, n);
+		}
+
+		const G &g;
+		std::vector<size_t> edges, adjacency;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const std::string &what) {
+	if(!condition) {
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+template<class G>
+static void build(G &g) {
+	size_t n = 2000;
+	for(size_t v = 0; v < n; ++v) {
+		g[add_vertex(g)].label = "v" + std::to_string(v);
+	}
+	for(size_t v = 0; v < n; ++v) {
+		for(size_t k = 1; k <= 4; ++k) {
+			size_t u = (v * 7 + k * 131) % n;
+			g[add_edge(v, u, g).first].label = std::to_string(v) + "-" + std::to_string(u);
+		}
+		if(v % 10 == 0) g[add_edge(v, v, g).first].label = "loop";
+		if(v % 13 == 0) g[add_edge(v, (v + 1) % n, g).first].label = "parallel";
+	}
+	g[boost::graph_bundle].label = "graph";
+}
+
+template<class G>
+static void checkDrained(const std::string &name, const G &g, const RecordingExecutor<G> &executor, size_t m, size_t half_edges) {
+	bool partial = false, shrinking = true;
+	for(size_t i = 0; i < executor.edges.size(); ++i) {
+		if(executor.edges[i] > 0 && executor.edges[i] < m) partial = true;
+		if(i > 0 && executor.adjacency[i] > executor.adjacency[i-1]) shrinking = false;
+	}
+	check(executor.edges.front() == m && executor.adjacency.front() == half_edges, name + ": source intact at the start");
+	check(partial, name + ": source partly freed while freezing");
+	check(shrinking, name + ": source adjacency only shrinks");
+	check(num_vertices(g) == 0 && num_edges(g) == 0, name + ": source empty afterwards");
+}
+
+template<class CSR>
+static void checkColumns(const std::string &name, const CSR &expected, const CSR &csr) {
+	check(csr.offsets == expected.offsets, name + ": offsets");
+	check(csr.targets == expected.targets, name + ": targets");
+	bool vertices = csr.vertex_props.size() == expected.vertex_props.size();
+	for(size_t v = 0; vertices && v < csr.vertex_props.size(); ++v) {
+		vertices = csr.vertex_props[v].label == expected.vertex_props[v].label;
+	}
+	check(vertices, name + ": vertex labels");
+	bool edges = csr.edge_props.size() == expected.edge_props.size();
+	for(size_t e = 0; edges && e < csr.edge_props.size(); ++e) {
+		edges = csr.edge_props[e].label == expected.edge_props[e].label;
+	}
+	check(edges, name + ": edge labels");
+	check(csr.graph_props.label == expected.graph_props.label, name + ": graph label");
+}
+
+static void testUndirected() {
+	Graph g;
+	build(g);
+	size_t m = num_edges(g), half_edges = 0;
+	for(size_t v = 0; v < num_vertices(g); ++v) half_edges += out_degree(v, g);
+
+	graphio::CSRGraph<> expected, csr;
+	graphio::freeze(g, expected);
+
+	RecordingExecutor<Graph> executor(g);
+	graphio::freezeAndRelease(g, csr, executor);
+
+	checkDrained("undirected", g, executor, m, half_edges);
+	checkColumns("undirected", expected, csr);
+	check(csr.edge_ids == expected.edge_ids, "undirected: edge ids");
+}
+
+static void testDirected() {
+	DirectedGraph g;
+	build(g);
+	size_t m = num_edges(g);
+
+	graphio::DirectedCSRGraph<> expected, csr;
+	graphio::freeze(g, expected);
+
+	RecordingExecutor<DirectedGraph> executor(g);
+	graphio::freezeAndRelease(g, csr, executor);
+
+	checkDrained("directed", g, executor, m, m);
+	checkColumns("directed", expected, csr);
+}
+
+int main() {
+	testUndirected();
+	testDirected();
+	return failures == 0 ? 0 : 1;
+}
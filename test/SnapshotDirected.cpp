@@ -0,0 +1,61 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <boost/graph/adjacency_list.hpp>
+#include <graphio/Graph.hpp>
+#include <graphio/GraphReader.hpp>
+#include <graphio/SnapshotWriter.hpp>
+
+// Checks that writeSnapshot() captures a directed graph, which it
+// freezes into a DirectedCSRGraph, with every edge in its direction.
+
+typedef boost::adjacency_list<
+	boost::vecS,
+	boost::vecS,
+	boost::bidirectionalS,
+	graphio::LabeledVertex,
+	graphio::LabeledEdge,
+	graphio::LabeledGraph
+> DirectedGraph;
+
+template<class G>
+static std::vector<std::string> edgeList(const G &g) {
+	std::vector<std::string> edges;
+	for(auto ep = boost::edges(g); ep.first != ep.second; ++ep.first) {
+		edges.push_back(g[source(*ep.first, g)].label + " -> " + g[target(*ep.first, g)].label + " " + g[*ep.first].label);
+	}
+	std::sort(edges.begin(), edges.end());
+	return edges;
+}
+
+int main() {
+	DirectedGraph g;
+	const char *names[] = { "TP53", "MDM2", "ATM", "CHEK2" };
+	for(size_t v = 0; v < 4; ++v) {
+		g[add_vertex(g)].label = names[v];
+	}
+	g[add_edge(0, 1, g).first].label = "pp";
+	g[add_edge(1, 0, g).first].label = "pd";
+	g[add_edge(2, 0, g).first].label = "pp";
+	g[add_edge(2, 3, g).first].label = "pp";
+	g[add_edge(3, 3, g).first].label = "loop";
+
+	graphio::SnapshotOptions options;
+	options.low_priority = false;
+	std::string filename = "snapshot_directed.tab";
+	graphio::writeSnapshot(g, filename, options).get();
+
+	DirectedGraph h;
+	graphio::readGraph(filename, h);
+	std::remove(filename.c_str());
+
+	std::vector<std::string> expected = edgeList(g), written = edgeList(h);
+	if(written != expected) {
+		std::cerr << "FAILED: snapshot edges differ" << std::endl;
+		for(size_t i = 0; i < written.size(); ++i) std::cerr << "  " << written[i] << std::endl;
+		return 1;
+	}
+	return 0;
+}